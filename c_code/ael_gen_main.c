@@ -0,0 +1,414 @@
+/*
+ * ael_gen_main.c
+ * Synthetic AEL workload generator for profiling and stress tests.
+ *
+ * Notes:
+ * - Emits a deterministic (per -Seed) AEL program: globals, then -Defuns functions built from
+ *   assignments, calls to earlier functions, if/else, while, for, do-while and switch, with
+ *   expressions up to -ExprDepth operators deep.
+ * - Every function has one spine of compound statements reaching exactly -Nesting levels. Other
+ *   statements branch freely only above GEN_FANOUT_DEPTH and stay simple below it, so output
+ *   grows linearly with -Nesting rather than exponentially.
+ * - -TargetMB keeps adding functions until the output reaches that size (10 MB .. 1 GB inputs);
+ *   statements check it too, so one function cannot run far past it.
+ * - -OutIr compiles the result through the ael2ir front end (AelCompiler) into an IR log.
+ */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ael_compiler.h"
+
+#define GEN_FANOUT_DEPTH 3        /* below this depth only the spine nests further */
+#define GEN_MAX_PARAMS 32         /* MAX_PARAMS in ael_parser_functions.c */
+
+typedef struct GenOptions {
+    uint64_t seed;
+    int defuns;
+    double target_mb;             /* > 0: overrides defuns */
+    int statements;               /* top-level statements per function body */
+    int nesting;                  /* if/while/for/switch nesting, reached once per function */
+    int expr_depth;
+    int literal_density;          /* percent of expression leaves that are literals */
+    int string_len;               /* max string literal length */
+    int locals;
+    int params;                   /* at most GEN_MAX_PARAMS */
+    int globals;
+} GenOptions;
+
+typedef struct Gen {
+    FILE *fp;
+    const GenOptions *opt;
+    uint64_t rng;
+    size_t bytes;
+    size_t target;                /* -TargetMB in bytes, 0 if none */
+    int indent;
+    int fn_index;                 /* function being generated; calls target f0 .. f(fn_index-1) */
+} Gen;
+
+static void print_usage(const char *exe) {
+    fprintf(stderr,
+            "Synthetic AEL workload generator\n"
+            "\n"
+            "Usage:\n"
+            "  %s -Out <file.ael> [-OutIr <file.ir.txt>] [-Seed N]\n"
+            "     [-Defuns N | -TargetMB N] [-Statements N] [-Nesting N] [-ExprDepth N]\n"
+            "     [-LiteralDensity 0..100] [-StringLen N] [-Locals N] [-Params N] [-Globals N]\n"
+            "\n"
+            "Defaults: -Seed 1 -Defuns 100 -Statements 12 -Nesting 3 -ExprDepth 3 -LiteralDensity 40\n"
+            "          -StringLen 24 -Locals 4 -Params 2 -Globals 8\n",
+            exe);
+}
+
+/* splitmix64: fast, and the same stream on every platform */
+static uint64_t rng_next(Gen *g) {
+    uint64_t z = (g->rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static int rng_below(Gen *g, int n) {
+    return n > 0 ? (int)(rng_next(g) % (uint64_t)n) : 0;
+}
+
+static void out(Gen *g, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vfprintf(g->fp, fmt, ap);
+    va_end(ap);
+    if (n > 0) g->bytes += (size_t)n;
+}
+
+static void out_indent(Gen *g) {
+    static const char spaces[] = "                                                                ";
+    int n = g->indent * 4;
+    if (n > (int)sizeof(spaces) - 1) n = (int)sizeof(spaces) - 1;
+    out(g, "%.*s", n, spaces);
+}
+
+/* ---- Expressions ---- */
+
+static void gen_var(Gen *g) {
+    const GenOptions *o = g->opt;
+    int pick = rng_below(g, o->params + o->locals + o->globals);
+    if (pick < o->params) out(g, "p%d", pick);
+    else if (pick < o->params + o->locals) out(g, "l%d", pick - o->params);
+    else out(g, "g%d", pick - o->params - o->locals);
+}
+
+static void gen_literal(Gen *g) {
+    int kind = rng_below(g, 10);
+    if (kind < 7) out(g, "%d", rng_below(g, 1000));
+    else if (kind < 9) out(g, "%d.%02d", rng_below(g, 100), rng_below(g, 100));
+    else out(g, "%di", 1 + rng_below(g, 9));
+}
+
+static void gen_expr(Gen *g, int depth);
+
+static void gen_call(Gen *g, int depth) {
+    out(g, "f%d(", rng_below(g, g->fn_index));
+    for (int k = 0; k < g->opt->params; k++) {
+        if (k) out(g, ", ");
+        gen_expr(g, depth - 1);
+    }
+    out(g, ")");
+}
+
+static void gen_expr(Gen *g, int depth) {
+    static const char *const ops[] = {"+", "-", "*", "/", "<", "<=", ">", ">=", "==", "!=", "&&", "||", "&", "|"};
+    if (depth <= 0 || rng_below(g, 4) == 0) {
+        if (rng_below(g, 100) < g->opt->literal_density) gen_literal(g);
+        else gen_var(g);
+        return;
+    }
+    int kind = rng_below(g, 20);
+    if (kind == 0) {
+        out(g, "(-");               /* parenthesized: "- -x" would lex as "--" */
+        gen_expr(g, depth - 1);
+        out(g, ")");
+    } else if (kind == 1) {
+        out(g, "(");
+        gen_expr(g, depth - 1);
+        out(g, " ? ");
+        gen_expr(g, depth - 1);
+        out(g, " : ");
+        gen_expr(g, depth - 1);
+        out(g, ")");
+    } else if (kind == 2 && g->fn_index > 0) {
+        gen_call(g, depth);
+    } else {
+        out(g, "(");
+        gen_expr(g, depth - 1);
+        out(g, " %s ", ops[rng_below(g, (int)(sizeof(ops) / sizeof(ops[0])))]);
+        gen_expr(g, depth - 1);
+        out(g, ")");
+    }
+}
+
+static void gen_string(Gen *g) {
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-.,:";
+    int len = rng_below(g, g->opt->string_len + 1);
+    out(g, "\"");
+    for (int k = 0; k < len; k++) {
+        if (rng_below(g, 32) == 0) out(g, "\\n");
+        else out(g, "%c", chars[rng_below(g, (int)sizeof(chars) - 1)]);
+    }
+    out(g, "\"");
+}
+
+/* ---- Statements ---- */
+
+static bool over_target(const Gen *g) {
+    return g->target && g->bytes >= g->target;
+}
+
+/* Statements per block: up to `max` while fan-out is allowed, otherwise just the one. */
+static int block_size(Gen *g, int nest, int max) {
+    return nest < GEN_FANOUT_DEPTH && !over_target(g) ? 1 + rng_below(g, max) : 1;
+}
+
+static void gen_block(Gen *g, int count, int nest, bool spine);
+
+/* `spine`: this statement continues the function's one path down to -Nesting. */
+static void gen_stmt(Gen *g, int nest, bool spine) {
+    const GenOptions *o = g->opt;
+    int local = rng_below(g, o->locals);
+    int kind;
+    if (nest >= o->nesting) kind = rng_below(g, 60);
+    else if (spine) kind = 60 + rng_below(g, 40);
+    else if (nest >= GEN_FANOUT_DEPTH || over_target(g)) kind = rng_below(g, 60);
+    else kind = rng_below(g, 100);
+    spine = spine && kind >= 60;
+
+    if (kind < 36) {
+        out_indent(g);
+        out(g, "l%d = ", local);
+        gen_expr(g, o->expr_depth);
+        out(g, ";\n");
+    } else if (kind < 46) {
+        out_indent(g);
+        out(g, "l%d = ", local);
+        gen_string(g);
+        out(g, ";\n");
+    } else if (kind < 52) {
+        out_indent(g);
+        out(g, "g%d = ", rng_below(g, o->globals));
+        gen_expr(g, o->expr_depth);
+        out(g, ";\n");
+    } else if (kind < 60) {
+        out_indent(g);
+        if (g->fn_index > 0) gen_call(g, o->expr_depth);
+        else gen_expr(g, o->expr_depth);
+        out(g, ";\n");
+    } else if (kind < 74) {
+        out_indent(g);
+        out(g, "if (");
+        gen_expr(g, o->expr_depth);
+        out(g, ")\n");
+        gen_block(g, block_size(g, nest, 3), nest + 1, spine);
+        if (rng_below(g, 2)) {
+            out_indent(g);
+            out(g, "else\n");
+            gen_block(g, block_size(g, nest, 3), nest + 1, false);
+        }
+    } else if (kind < 82) {
+        out_indent(g);
+        out(g, "while (l%d < %d)\n", local, 1 + rng_below(g, 100));
+        out_indent(g);
+        out(g, "{\n");
+        g->indent++;
+        for (int k = block_size(g, nest, 3); k > 0; k--) gen_stmt(g, nest + 1, spine && k == 1);
+        out_indent(g);
+        out(g, "l%d = l%d + 1;\n", local, local);
+        g->indent--;
+        out_indent(g);
+        out(g, "}\n");
+    } else if (kind < 90) {
+        out_indent(g);
+        out(g, "for (l%d = 0; l%d < %d; l%d = l%d + 1)\n", local, local, 1 + rng_below(g, 100), local, local);
+        gen_block(g, block_size(g, nest, 3), nest + 1, spine);
+    } else if (kind < 93) {
+        out_indent(g);
+        out(g, "do\n");
+        gen_block(g, block_size(g, nest, 3), nest + 1, spine);
+        out_indent(g);
+        out(g, "while (l%d < %d);\n", local, 1 + rng_below(g, 100));
+    } else {
+        int cases = nest < GEN_FANOUT_DEPTH ? 2 + rng_below(g, 5) : 1;
+        int step = rng_below(g, 2) ? 1 : 1 + rng_below(g, 1000); /* dense or sparse */
+        out_indent(g);
+        out(g, "switch (l%d)\n", local);
+        out_indent(g);
+        out(g, "{\n");
+        for (int k = 0; k <= cases; k++) {
+            out_indent(g);
+            if (k < cases) out(g, "    case %d:\n", k * step);
+            else out(g, "    default:\n");
+            g->indent += 2;
+            for (int s = block_size(g, nest, 2); s > 0; s--) gen_stmt(g, nest + 1, spine && k == 0 && s == 1);
+            out_indent(g);
+            out(g, "break;\n");
+            g->indent -= 2;
+        }
+        out_indent(g);
+        out(g, "}\n");
+    }
+}
+
+static void gen_block(Gen *g, int count, int nest, bool spine) {
+    out_indent(g);
+    out(g, "{\n");
+    g->indent++;
+    for (int k = 0; k < count; k++) gen_stmt(g, nest, spine && k == 0);
+    g->indent--;
+    out_indent(g);
+    out(g, "}\n");
+}
+
+static void gen_defun(Gen *g) {
+    const GenOptions *o = g->opt;
+    out(g, "defun f%d(", g->fn_index);
+    for (int k = 0; k < o->params; k++) out(g, k ? ", p%d" : "p%d", k);
+    out(g, ")\n{\n");
+    g->indent = 1;
+    for (int k = 0; k < o->locals; k++) {
+        out_indent(g);
+        out(g, "decl l%d = ", k);
+        gen_expr(g, 1);
+        out(g, ";\n");
+    }
+    for (int k = 0; k < o->statements && (k == 0 || !over_target(g)); k++) gen_stmt(g, 0, k == 0);
+    out_indent(g);
+    out(g, "return ");
+    gen_expr(g, o->expr_depth);
+    out(g, ";\n");
+    g->indent = 0;
+    out(g, "}\n\n");
+    g->fn_index++;
+}
+
+static void gen_program(Gen *g) {
+    const GenOptions *o = g->opt;
+    out(g, "// Generated by ael_gen (seed %llu)\n\n", (unsigned long long)o->seed);
+    for (int k = 0; k < o->globals; k++) out(g, "decl g%d = %d;\n", k, rng_below(g, 100));
+    out(g, "\n");
+
+    while (g->target ? !over_target(g) : g->fn_index < o->defuns) gen_defun(g);
+
+    if (g->fn_index > 0) {
+        out(g, "f%d(", g->fn_index - 1);
+        for (int k = 0; k < o->params; k++) out(g, k ? ", %d" : "%d", k + 1);
+        out(g, ");\n");
+    }
+}
+
+static bool compile_ir(const char *ael_path, const char *ir_path) {
+    FILE *fp = fopen(ael_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "[ael_gen] Cannot reopen: %s\n", ael_path);
+        return false;
+    }
+    AelCompiler *c = ael_compiler_create();
+    bool ok = c && ael_compiler_parse(c, fp);
+    fclose(fp);
+    if (ok) {
+        ael_compiler_write_ir(c, ir_path);
+        fprintf(stderr, "[ael_gen] IR: %s (%d instructions)\n", ir_path, ael_compiler_ir_count(c));
+    } else {
+        fprintf(stderr, "[ael_gen] ael2ir failed on %s\n", ael_path);
+    }
+    ael_compiler_destroy(c);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL;
+    const char *out_ir = NULL;
+    GenOptions opt;
+    opt.seed = 1;
+    opt.defuns = 100;
+    opt.target_mb = 0;
+    opt.statements = 12;
+    opt.nesting = 3;
+    opt.expr_depth = 3;
+    opt.literal_density = 40;
+    opt.string_len = 24;
+    opt.locals = 4;
+    opt.params = 2;
+    opt.globals = 8;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (_stricmp(a, "-h") == 0 || _stricmp(a, "--help") == 0 || _stricmp(a, "/?") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (!v) {
+            fprintf(stderr, "[ael_gen] Unknown arg: %s\n", a);
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+        if (_stricmp(a, "-Out") == 0) out_path = v;
+        else if (_stricmp(a, "-OutIr") == 0) out_ir = v;
+        else if (_stricmp(a, "-Seed") == 0) opt.seed = strtoull(v, NULL, 10);
+        else if (_stricmp(a, "-Defuns") == 0) opt.defuns = atoi(v);
+        else if (_stricmp(a, "-TargetMB") == 0) opt.target_mb = atof(v);
+        else if (_stricmp(a, "-Statements") == 0) opt.statements = atoi(v);
+        else if (_stricmp(a, "-Nesting") == 0) opt.nesting = atoi(v);
+        else if (_stricmp(a, "-ExprDepth") == 0) opt.expr_depth = atoi(v);
+        else if (_stricmp(a, "-LiteralDensity") == 0) opt.literal_density = atoi(v);
+        else if (_stricmp(a, "-StringLen") == 0) opt.string_len = atoi(v);
+        else if (_stricmp(a, "-Locals") == 0) opt.locals = atoi(v);
+        else if (_stricmp(a, "-Params") == 0) opt.params = atoi(v);
+        else if (_stricmp(a, "-Globals") == 0) opt.globals = atoi(v);
+        else {
+            fprintf(stderr, "[ael_gen] Unknown arg: %s\n", a);
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!out_path) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    /* Loops and switches need a local to drive them; expressions need something to reference. */
+    if (opt.locals < 1) opt.locals = 1;
+    if (opt.globals < 1) opt.globals = 1;
+    if (opt.params < 0) opt.params = 0;
+    if (opt.params > GEN_MAX_PARAMS) {
+        fprintf(stderr, "[ael_gen] -Params %d exceeds the parser limit, using %d\n", opt.params, GEN_MAX_PARAMS);
+        opt.params = GEN_MAX_PARAMS;
+    }
+    if (opt.defuns < 0) opt.defuns = 0;
+    if (opt.statements < 0) opt.statements = 0;
+    if (opt.nesting < 0) opt.nesting = 0;
+    if (opt.expr_depth < 0) opt.expr_depth = 0;
+    if (opt.string_len < 0) opt.string_len = 0;
+
+    Gen g;
+    memset(&g, 0, sizeof(g));
+    g.opt = &opt;
+    g.rng = opt.seed;
+    g.target = opt.target_mb > 0 ? (size_t)(opt.target_mb * 1024.0 * 1024.0) : 0;
+    g.fp = fopen(out_path, "wb");
+    if (!g.fp) {
+        fprintf(stderr, "[ael_gen] Cannot open output: %s\n", out_path);
+        return 1;
+    }
+    setvbuf(g.fp, NULL, _IOFBF, 1 << 20);
+    gen_program(&g);
+    if (fclose(g.fp) != 0) {
+        fprintf(stderr, "[ael_gen] Write failed: %s\n", out_path);
+        return 1;
+    }
+    fprintf(stderr, "[ael_gen] %s: %d functions, %zu bytes\n", out_path, g.fn_index, g.bytes);
+
+    if (out_ir && !compile_ir(out_path, out_ir)) return 1;
+    return 0;
+}
@@ -0,0 +1,563 @@
+/*
+ * atf2ael_bench_main.c
+ * Stage benchmark over the AEL/ATF test corpus (full_test_case_ael).
+ *
+ * Notes:
+ * - Every *.ael / *.atf pair under -Root is one case. Stages, each run -Iterations times:
+ *     atf_to_ir   atf_to_ir() on the *.atf (file based, like atf2ael)
+ *     ael_to_ir   ael_compile_buffer() on the *.ael, IR text into memory
+ *     ir_parse    ir_parse_buffer() on the case's IR (ATF-derived if available, else AEL-derived)
+ *     ir_to_ael   ir2ael_convert_program_to_sink() on that IR, output counted and dropped
+ * - Per stage: wall time (sum over cases of the per-case mean), instructions/sec, bytes/sec,
+ *   per-case latency percentiles, and how far the stage raised the process peak RSS.
+ *   Bytes are the stage input, except ir_to_ael which counts the AEL produced.
+ * - The report is JSON (-Out file, or stdout); a summary table goes to stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+#include "atf2ael_atf_stage.h"
+#include "atf2ael_lib.h"
+#include "ir_text_parser.h"
+
+#define BENCH_PATH_CAP 4096
+
+enum { STAGE_ATF_TO_IR, STAGE_AEL_TO_IR, STAGE_IR_PARSE, STAGE_IR_TO_AEL, STAGE_COUNT };
+
+static const char *const k_stage_names[STAGE_COUNT] = {"atf_to_ir", "ael_to_ir", "ir_parse", "ir_to_ael"};
+
+typedef struct StageSample {
+    bool ran;
+    bool ok;
+    double best_s;
+    double mean_s;
+    size_t insts;
+    size_t bytes;
+    size_t rss_growth;            /* process peak RSS increase while this stage ran */
+} StageSample;
+
+typedef struct BenchCase {
+    char base[BENCH_PATH_CAP];    /* path without extension */
+    const char *rel;              /* base relative to the root */
+    bool has_ael;
+    bool has_atf;
+    const char *ir_source;        /* "atf", "ael" or NULL if neither produced IR */
+    StageSample st[STAGE_COUNT];
+} BenchCase;
+
+typedef struct BenchList {
+    BenchCase *cases;
+    size_t count;
+    size_t cap;
+} BenchList;
+
+static void print_usage(const char *exe) {
+    fprintf(stderr,
+            "ATF/AEL converter benchmark\n"
+            "\n"
+            "Usage:\n"
+            "  %s [-Root <full_test_case_ael>] [-Iterations N] [-Out <report.json>]\n"
+            "     [-StrictPos 0|1] [-AllowScopeBlocks 0|1] [-Jobs N]\n"
+            "\n"
+            "Notes:\n"
+            "  -Root defaults to ../full_test_case_ael (relative to c_code).\n"
+            "  -Iterations defaults to 3; each case/stage reports its best and mean time.\n"
+            "  -StrictPos/-AllowScopeBlocks/-Jobs apply to ir_to_ael as in atf2ael.\n"
+            "  Without -Out the JSON report goes to stdout.\n",
+            exe);
+}
+
+/* ---- Platform helpers ---- */
+
+static double now_s(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER t;
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static size_t peak_rss_bytes(void) {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+    return (size_t)pmc.PeakWorkingSetSize;
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (size_t)ru.ru_maxrss * 1024; /* kilobytes on Linux */
+#endif
+}
+
+static char *read_whole_file(const char *path, size_t *len) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    size_t cap = 64 * 1024;
+    size_t n = 0;
+    char *buf = (char *)malloc(cap);
+    while (buf) {
+        n += fread(buf + n, 1, cap - n, fp);
+        if (n < cap) break;
+        char *nb = (char *)realloc(buf, cap * 2);
+        if (!nb) {
+            free(buf);
+            buf = NULL;
+            break;
+        }
+        buf = nb;
+        cap *= 2;
+    }
+    fclose(fp);
+    *len = n;
+    return buf;
+}
+
+/* ---- Case collection ---- */
+
+static bool has_ext(const char *name, const char *ext) {
+    size_t n = strlen(name);
+    size_t m = strlen(ext);
+    return n >= m && _stricmp(name + (n - m), ext) == 0;
+}
+
+static bool add_file(BenchList *list, const char *path) {
+    bool is_ael = has_ext(path, ".ael");
+    if (!is_ael && !has_ext(path, ".atf")) return true;
+    size_t base_len = strlen(path) - 4;
+    if (base_len >= BENCH_PATH_CAP) return true;
+
+    for (size_t k = 0; k < list->count; k++) {
+        BenchCase *c = &list->cases[k];
+        if (strlen(c->base) == base_len && strncmp(c->base, path, base_len) == 0) {
+            if (is_ael) c->has_ael = true;
+            else c->has_atf = true;
+            return true;
+        }
+    }
+    if (list->count == list->cap) {
+        size_t ncap = list->cap ? list->cap * 2 : 256;
+        BenchCase *nc = (BenchCase *)realloc(list->cases, ncap * sizeof(BenchCase));
+        if (!nc) return false;
+        list->cases = nc;
+        list->cap = ncap;
+    }
+    BenchCase *c = &list->cases[list->count++];
+    memset(c, 0, sizeof(*c));
+    memcpy(c->base, path, base_len);
+    c->base[base_len] = '\0';
+    if (is_ael) c->has_ael = true;
+    else c->has_atf = true;
+    return true;
+}
+
+static bool collect_cases(BenchList *list, const char *dir) {
+    bool ok = true;
+#if defined(_WIN32)
+    char pattern[BENCH_PATH_CAP];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(pattern, &fd);
+    if (h == INVALID_HANDLE_VALUE) return true;
+    do {
+        const char *name = fd.cFileName;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+        char path[BENCH_PATH_CAP];
+        snprintf(path, sizeof(path), "%s\\%s", dir, name);
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ok = collect_cases(list, path);
+        else ok = add_file(list, path);
+    } while (ok && FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    DIR *d = opendir(dir);
+    if (!d) return true;
+    struct dirent *e;
+    while (ok && (e = readdir(d)) != NULL) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        char path[BENCH_PATH_CAP];
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        struct stat sb;
+        if (stat(path, &sb) != 0) continue;
+        if (S_ISDIR(sb.st_mode)) ok = collect_cases(list, path);
+        else ok = add_file(list, path);
+    }
+    closedir(d);
+#endif
+    return ok;
+}
+
+static int cmp_case(const void *a, const void *b) {
+    return strcmp(((const BenchCase *)a)->base, ((const BenchCase *)b)->base);
+}
+
+/* ---- Stages ---- */
+
+typedef struct BenchRun {
+    Atf2AelContext *ctx;
+    int iterations;
+    char tmp_ir[BENCH_PATH_CAP];
+} BenchRun;
+
+static bool count_sink(void *ctx, const char *data, size_t len) {
+    (void)data;
+    *(size_t *)ctx += len;
+    return true;
+}
+
+static void record(StageSample *s, bool ok, double total_s, double best_s, int runs, size_t rss_before) {
+    s->ran = true;
+    s->ok = ok;
+    s->best_s = best_s;
+    s->mean_s = runs > 0 ? total_s / runs : 0.0;
+    size_t rss_after = peak_rss_bytes();
+    s->rss_growth = rss_after > rss_before ? rss_after - rss_before : 0;
+}
+
+static size_t count_insts(const char *ir, size_t len) {
+    IRProgram program;
+    ir_program_init(&program);
+    char err[256];
+    size_t n = ir_parse_buffer(ir, len, &program, err, sizeof(err)) ? program.count : 0;
+    ir_program_free(&program);
+    return n;
+}
+
+/* ATF -> IR through the temp file; returns the last iteration's IR text (caller frees) or NULL. */
+static char *stage_atf_to_ir(BenchRun *run, BenchCase *c, size_t *ir_len) {
+    StageSample *s = &c->st[STAGE_ATF_TO_IR];
+    char path[BENCH_PATH_CAP + 8];
+    snprintf(path, sizeof(path), "%s.atf", c->base);
+    size_t atf_len = 0;
+    char *atf = read_whole_file(path, &atf_len);
+    free(atf);
+    s->bytes = atf_len;
+
+    size_t rss0 = peak_rss_bytes();
+    double total = 0.0, best = 0.0;
+    bool ok = true;
+    int it = 0;
+    for (; it < run->iterations && ok; it++) {
+        double t0 = now_s();
+        ok = atf2ael_atf_to_ir(path, run->tmp_ir) == 0;
+        double dt = now_s() - t0;
+        total += dt;
+        if (it == 0 || dt < best) best = dt;
+    }
+    record(s, ok, total, best, it, rss0);
+    if (!ok) return NULL;
+
+    char *ir = read_whole_file(run->tmp_ir, ir_len);
+    if (ir) s->insts = count_insts(ir, *ir_len);
+    return ir;
+}
+
+/* AEL -> IR in memory; returns the IR text (caller frees) or NULL. */
+static char *stage_ael_to_ir(BenchRun *run, BenchCase *c, size_t *ir_len) {
+    StageSample *s = &c->st[STAGE_AEL_TO_IR];
+    char path[BENCH_PATH_CAP + 8];
+    snprintf(path, sizeof(path), "%s.ael", c->base);
+    size_t ael_len = 0;
+    char *ael = read_whole_file(path, &ael_len);
+    if (!ael) {
+        s->ran = true;
+        return NULL;
+    }
+    s->bytes = ael_len;
+
+    Atf2AelBuffer out;
+    atf2ael_buffer_init(&out);
+    size_t rss0 = peak_rss_bytes();
+    double total = 0.0, best = 0.0;
+    bool ok = true;
+    int it = 0;
+    for (; it < run->iterations && ok; it++) {
+        out.len = 0;
+        double t0 = now_s();
+        ok = ael_compile_buffer(run->ctx, ael, ael_len, atf2ael_buffer_sink, &out, NULL, 0);
+        double dt = now_s() - t0;
+        total += dt;
+        if (it == 0 || dt < best) best = dt;
+    }
+    record(s, ok, total, best, it, rss0);
+    free(ael);
+
+    char *ir = NULL;
+    if (ok && (ir = (char *)malloc(out.len ? out.len : 1)) != NULL) {
+        memcpy(ir, out.data, out.len);
+        *ir_len = out.len;
+        s->insts = count_insts(ir, out.len);
+    }
+    atf2ael_buffer_free(&out);
+    return ir;
+}
+
+static void stage_ir(BenchRun *run, BenchCase *c, const char *ir, size_t ir_len) {
+    StageSample *sp = &c->st[STAGE_IR_PARSE];
+    StageSample *sc = &c->st[STAGE_IR_TO_AEL];
+    sp->bytes = ir_len;
+
+    IRProgram program;
+    char err[512];
+    size_t rss0 = peak_rss_bytes();
+    double total = 0.0, best = 0.0;
+    bool ok = true;
+    int it = 0;
+    for (; it < run->iterations && ok; it++) {
+        ir_program_init(&program);
+        double t0 = now_s();
+        ok = ir_parse_buffer(ir, ir_len, &program, err, sizeof(err));
+        double dt = now_s() - t0;
+        total += dt;
+        if (it == 0 || dt < best) best = dt;
+        if (it + 1 < run->iterations || !ok) ir_program_free(&program);
+    }
+    record(sp, ok, total, best, it, rss0);
+    if (!ok) return;
+    sp->insts = program.count;
+    sc->insts = program.count;
+
+    rss0 = peak_rss_bytes();
+    total = 0.0;
+    best = 0.0;
+    it = 0;
+    for (; it < run->iterations && ok; it++) {
+        size_t produced = 0;
+        double t0 = now_s();
+        ok = ir2ael_convert_program_to_sink(run->ctx, &program, count_sink, &produced, NULL, 0);
+        double dt = now_s() - t0;
+        total += dt;
+        if (it == 0 || dt < best) best = dt;
+        sc->bytes = produced;
+    }
+    record(sc, ok, total, best, it, rss0);
+    ir_program_free(&program);
+}
+
+static void run_case(BenchRun *run, BenchCase *c) {
+    size_t atf_ir_len = 0, ael_ir_len = 0;
+    char *atf_ir = c->has_atf ? stage_atf_to_ir(run, c, &atf_ir_len) : NULL;
+    char *ael_ir = c->has_ael ? stage_ael_to_ir(run, c, &ael_ir_len) : NULL;
+    if (atf_ir) {
+        c->ir_source = "atf";
+        stage_ir(run, c, atf_ir, atf_ir_len);
+    } else if (ael_ir) {
+        c->ir_source = "ael";
+        stage_ir(run, c, ael_ir, ael_ir_len);
+    }
+    free(atf_ir);
+    free(ael_ir);
+}
+
+/* ---- Report ---- */
+
+typedef struct StageSummary {
+    size_t files;
+    size_t failed;
+    double wall_s;
+    size_t insts;
+    size_t bytes;
+    size_t rss_growth;
+    double p50_ms;
+    double p95_ms;
+    double max_ms;
+} StageSummary;
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void summarize(const BenchList *list, int stage, StageSummary *out, double *scratch) {
+    memset(out, 0, sizeof(*out));
+    size_t n = 0;
+    for (size_t k = 0; k < list->count; k++) {
+        const StageSample *s = &list->cases[k].st[stage];
+        if (!s->ran) continue;
+        out->files++;
+        out->rss_growth += s->rss_growth;
+        if (!s->ok) {
+            out->failed++;
+            continue;
+        }
+        out->wall_s += s->mean_s;
+        out->insts += s->insts;
+        out->bytes += s->bytes;
+        scratch[n++] = s->mean_s * 1000.0;
+    }
+    if (n == 0) return;
+    qsort(scratch, n, sizeof(double), cmp_double);
+    out->p50_ms = scratch[(n - 1) / 2];
+    out->p95_ms = scratch[(size_t)((double)(n - 1) * 0.95)];
+    out->max_ms = scratch[n - 1];
+}
+
+static void json_str(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') fprintf(fp, "\\%c", ch);
+        else if (ch < 0x20) fprintf(fp, "\\u%04x", ch);
+        else fputc(ch, fp);
+    }
+    fputc('"', fp);
+}
+
+static double per_s(size_t amount, double secs) {
+    return secs > 0.0 ? (double)amount / secs : 0.0;
+}
+
+static void write_report(FILE *fp, const BenchList *list, const char *root, int iterations, const StageSummary *sum) {
+    fprintf(fp, "{\n  \"tool\": \"atf2ael_bench\",\n  \"format\": 1,\n  \"root\": ");
+    json_str(fp, root);
+    fprintf(fp, ",\n  \"iterations\": %d,\n  \"cases\": %zu,\n  \"peak_rss_bytes\": %zu,\n  \"stages\": {\n",
+            iterations, list->count, peak_rss_bytes());
+    for (int k = 0; k < STAGE_COUNT; k++) {
+        const StageSummary *s = &sum[k];
+        fprintf(fp,
+                "    \"%s\": {\"files\": %zu, \"failed\": %zu, \"wall_s\": %.6f, \"insts\": %zu, \"bytes\": %zu, "
+                "\"insts_per_s\": %.1f, \"bytes_per_s\": %.1f, \"latency_ms\": {\"p50\": %.4f, \"p95\": %.4f, "
+                "\"max\": %.4f}, \"peak_rss_growth_bytes\": %zu}%s\n",
+                k_stage_names[k], s->files, s->failed, s->wall_s, s->insts, s->bytes, per_s(s->insts, s->wall_s),
+                per_s(s->bytes, s->wall_s), s->p50_ms, s->p95_ms, s->max_ms, s->rss_growth,
+                k + 1 < STAGE_COUNT ? "," : "");
+    }
+    fprintf(fp, "  },\n  \"files\": [\n");
+    for (size_t i = 0; i < list->count; i++) {
+        const BenchCase *c = &list->cases[i];
+        fprintf(fp, "    {\"case\": ");
+        json_str(fp, c->rel);
+        fprintf(fp, ", \"ir_source\": ");
+        if (c->ir_source) json_str(fp, c->ir_source);
+        else fprintf(fp, "null");
+        for (int k = 0; k < STAGE_COUNT; k++) {
+            const StageSample *s = &c->st[k];
+            if (!s->ran) continue;
+            fprintf(fp, ", \"%s\": {\"ok\": %s, \"best_ms\": %.4f, \"mean_ms\": %.4f, \"insts\": %zu, \"bytes\": %zu}",
+                    k_stage_names[k], s->ok ? "true" : "false", s->best_s * 1000.0, s->mean_s * 1000.0, s->insts,
+                    s->bytes);
+        }
+        fprintf(fp, "}%s\n", i + 1 < list->count ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+static void print_summary(const StageSummary *sum) {
+    fprintf(stderr, "%-10s %6s %6s %10s %12s %12s %9s %9s %9s\n", "stage", "files", "failed", "wall_ms", "insts/s",
+            "MB/s", "p50_ms", "p95_ms", "max_ms");
+    for (int k = 0; k < STAGE_COUNT; k++) {
+        const StageSummary *s = &sum[k];
+        fprintf(stderr, "%-10s %6zu %6zu %10.2f %12.0f %12.2f %9.3f %9.3f %9.3f\n", k_stage_names[k], s->files,
+                s->failed, s->wall_s * 1000.0, per_s(s->insts, s->wall_s), per_s(s->bytes, s->wall_s) / 1e6,
+                s->p50_ms, s->p95_ms, s->max_ms);
+    }
+    fprintf(stderr, "peak RSS: %.1f MB\n", (double)peak_rss_bytes() / (1024.0 * 1024.0));
+}
+
+int main(int argc, char **argv) {
+    const char *root = "../full_test_case_ael";
+    const char *out_path = NULL;
+    int iterations = 3;
+    Atf2AelOptions opts;
+    opts.strict_pos = false;
+    opts.allow_scope_blocks = false;
+    opts.jobs = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (_stricmp(argv[i], "-Root") == 0 && i + 1 < argc) {
+            root = argv[++i];
+        } else if (_stricmp(argv[i], "-Iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (_stricmp(argv[i], "-Out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (_stricmp(argv[i], "-StrictPos") == 0 && i + 1 < argc) {
+            opts.strict_pos = atoi(argv[++i]) != 0;
+        } else if (_stricmp(argv[i], "-AllowScopeBlocks") == 0 && i + 1 < argc) {
+            opts.allow_scope_blocks = atoi(argv[++i]) != 0;
+        } else if (_stricmp(argv[i], "-Jobs") == 0 && i + 1 < argc) {
+            opts.jobs = atoi(argv[++i]);
+        } else if (_stricmp(argv[i], "-h") == 0 || _stricmp(argv[i], "--help") == 0 || _stricmp(argv[i], "/?") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "[bench] Unknown arg: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (iterations < 1) iterations = 1;
+
+    BenchList list;
+    memset(&list, 0, sizeof(list));
+    if (!collect_cases(&list, root)) {
+        fprintf(stderr, "[bench] out of memory while scanning: %s\n", root);
+        free(list.cases);
+        return 1;
+    }
+    if (list.count == 0) {
+        fprintf(stderr, "[bench] No .ael/.atf files under: %s\n", root);
+        free(list.cases);
+        return 2;
+    }
+    qsort(list.cases, list.count, sizeof(BenchCase), cmp_case);
+    size_t root_len = strlen(root);
+    for (size_t k = 0; k < list.count; k++) {
+        const char *rel = list.cases[k].base + root_len;
+        while (*rel == '/' || *rel == '\\') rel++;
+        list.cases[k].rel = rel;
+    }
+
+    BenchRun run;
+    memset(&run, 0, sizeof(run));
+    run.iterations = iterations;
+    run.ctx = atf2ael_context_create(&opts);
+    if (!run.ctx || !atf2ael_temp_file_create("bench", run.tmp_ir, sizeof(run.tmp_ir))) {
+        fprintf(stderr, "[bench] setup failed\n");
+        atf2ael_context_destroy(run.ctx);
+        free(list.cases);
+        return 1;
+    }
+
+    for (size_t k = 0; k < list.count; k++) run_case(&run, &list.cases[k]);
+    atf2ael_temp_file_remove(run.tmp_ir);
+
+    StageSummary sum[STAGE_COUNT];
+    double *scratch = (double *)malloc(list.count * sizeof(double));
+    int rc = 0;
+    if (!scratch) {
+        fprintf(stderr, "[bench] out of memory\n");
+        rc = 1;
+    } else {
+        for (int k = 0; k < STAGE_COUNT; k++) summarize(&list, k, &sum[k], scratch);
+        FILE *fp = out_path ? fopen(out_path, "w") : stdout;
+        if (!fp) {
+            fprintf(stderr, "[bench] Cannot open output: %s\n", out_path);
+            rc = 1;
+        } else {
+            write_report(fp, &list, root, iterations, sum);
+            if (out_path) fclose(fp);
+            print_summary(sum);
+        }
+    }
+
+    free(scratch);
+    atf2ael_context_destroy(run.ctx);
+    free(list.cases);
+    return rc;
+}
@@ -3,9 +3,16 @@
  * ATF(.atf) -> IR(.ir.txt) -> AEL(.ael) converter.
  *
  * Notes:
- * - Uses atf2ir_c_code's atf_to_ir() to generate a temporary IR file.
- * - Uses this repo's IR text parser + ir2ael(real) converter to synthesize AEL.
+ * - Uses atf2ir_c_code's atf_to_ir() to generate IR text. Unless -EmitIr/-OutIr
+ *   asks for a side output, the IR goes to a cache-resident temp file that is
+ *   mapped, parsed in place, and deleted once unmapped.
+ * - IR is parsed from memory (ir_parse_buffer) by this repo's IR text parser,
+ *   then the ir2ael(real) converter synthesizes AEL.
  * - IR position info is debug-only; defaults to non-strict emission.
+ * - With -CacheDir, results are looked up by ATF content before atf_to_ir() runs
+ *   (see atf2ael_cache.h).
+ * - With -Stream 1, IR text is parsed and converted in one pass over a bounded
+ *   window (ir2ael_convert_stream) instead of being loaded whole.
  */
 
 #include <stdio.h>
@@ -15,26 +22,45 @@
 #include <windows.h>
 
 #include "ael_emit.h"
+#include "atf2ael_atf_stage.h"
+#include "atf2ael_cache.h"
 #include "ir2ael_convert.h"
+#include "ir_binary.h"
 #include "ir_text_parser.h"
 
-/* Provided by atf2ir_c_code (linked into this executable). */
-int atf_to_ir(const char *atf_file, const char *ir_file);
-
 static void print_usage(const char *exe) {
     fprintf(stderr,
             "ATF to AEL Converter (ATF->IR->AEL)\n"
             "\n"
             "Usage:\n"
             "  %s -In <file.atf> -Out <file.ael> [-EmitIr 0|1] [-OutIr <file.ir.txt>]\n"
-            "     [-StrictPos 0|1] [-AllowScopeBlocks 0|1]\n"
+            "     [-StrictPos 0|1] [-AllowScopeBlocks 0|1] [-Jobs N] [-CacheDir <dir>] [-Stream 0|1]\n"
+            "  %s -InIr <file.ir.txt|file.irb> -Out <file.ael> [-StrictPos 0|1] [-AllowScopeBlocks 0|1]\n"
+            "     [-Jobs N] [-Stream 0|1]\n"
+            "  %s -InDir <atf_dir> -OutDir <ael_dir> [-Jobs N] [-EmitIr 0|1]\n"
+            "     [-StrictPos 0|1] [-AllowScopeBlocks 0|1] [-CacheDir <dir>] [-Stream 0|1]\n"
             "\n"
             "Notes:\n"
-            "  -EmitIr 0: IR is written to a temp file and removed after conversion.\n"
-            "  -EmitIr 1: IR is kept (default path: <out>.ir.txt unless -OutIr is given).\n"
+            "  -EmitIr 0: IR is handed off via a cache-resident temp file and parsed in memory (default).\n"
+            "  -EmitIr 1: IR is also kept as a side output (default path: <out>.ir.txt unless -OutIr is given).\n"
+            "  -OutIr <file.irb>: the IR side output is written in the binary IR format.\n"
+            "  -InIr: convert cached IR (text or binary) instead of ATF.\n"
             "  -StrictPos defaults to 0 (positions are debug-only).\n"
-            "  -AllowScopeBlocks defaults to 0 (do not rely on locals/scope bookkeeping).\n",
-            exe);
+            "  -AllowScopeBlocks defaults to 0 (do not rely on locals/scope bookkeeping).\n"
+            "  -InDir/-OutDir: convert every *.atf under <atf_dir> (recursively) into the same\n"
+            "     layout under <ael_dir>; failures are reported per file and do not stop the batch.\n"
+            "  -Jobs defaults to the number of logical processors. In batch mode it is the number of\n"
+            "     files converted at once; for a single file it is the number of threads converting its\n"
+            "     functions (only with -StrictPos 1; the output is the same as with -Jobs 1).\n"
+            "  -CacheDir <dir>: reuse earlier conversions of identical ATF content (same -StrictPos and\n"
+            "     -AllowScopeBlocks); safe to share between concurrent runs.\n"
+            "  -CacheMaxMB N: evict least recently used entries beyond N MB (default 1024, 0: unbounded).\n"
+            "  -CacheIr 0|1: also cache the IR text (default 0; IR side outputs are always cached so\n"
+            "     -EmitIr/-OutIr runs can hit).\n"
+            "  -Stream 0|1: convert text IR in a bounded window while it is parsed, so memory stays\n"
+            "     flat however large the IR is (default 0). Each file then converts on one thread;\n"
+            "     binary IR and -OutIr <file.irb> still load the whole program.\n",
+            exe, exe, exe);
 }
 
 static bool dir_exists(const char *path) {
@@ -78,62 +104,184 @@ static void derive_default_ir_path_from_ael(const char *out_ael_path, char *out_
     snprintf(out_ir_path, cap, "%s.ir.txt", out_ael_path);
 }
 
-static bool make_temp_ir_file(char *out_path, size_t cap) {
-    if (!out_path || cap == 0) return false;
-    char tmp_dir[MAX_PATH];
-    DWORD n = GetTempPathA((DWORD)sizeof(tmp_dir), tmp_dir);
-    if (n == 0 || n >= sizeof(tmp_dir)) return false;
-    char tmp_name[MAX_PATH];
-    if (GetTempFileNameA(tmp_dir, "atf2ael", 0, tmp_name) == 0) return false;
-    strncpy(out_path, tmp_name, cap - 1);
-    out_path[cap - 1] = '\0';
-    return true;
+typedef struct ConvertOptions {
+    int emit_ir; /* -1: auto, 0/1: explicit */
+    bool strict_pos;
+    bool allow_scope_blocks;
+    int convert_jobs; /* IR->AEL worker threads per file (Ir2AelConvertOptions.jobs) */
+    Atf2AelCache *cache; /* NULL: no -CacheDir */
+    bool cache_ir;
+    bool stream; /* -Stream: ir2ael_convert_stream for text IR */
+} ConvertOptions;
+
+static bool has_ext(const char *path, const char *ext) {
+    size_t n = strlen(path);
+    size_t m = strlen(ext);
+    return n >= m && _stricmp(path + (n - m), ext) == 0;
 }
 
-int main(int argc, char **argv) {
-    const char *in_atf = NULL;
-    const char *out_ael = NULL;
-    const char *out_ir_arg = NULL;
-    int emit_ir = -1; /* -1: auto, 0/1: explicit */
-    bool strict_pos = false;
-    /* Default to disabled: ATF-derived IR may have emitter-dependent locals/scope bookkeeping,
-       which should not influence AEL structure unless explicitly requested. */
-    bool allow_scope_blocks = false;
+/* Ir2AelReadFn over a mapped IR view. */
+typedef struct ViewReader {
+    const char *data;
+    size_t len;
+    size_t pos;
+} ViewReader;
 
-    for (int i = 1; i < argc; i++) {
-        if (_stricmp(argv[i], "-In") == 0 && i + 1 < argc) {
-            in_atf = argv[++i];
-        } else if (_stricmp(argv[i], "-Out") == 0 && i + 1 < argc) {
-            out_ael = argv[++i];
-        } else if (_stricmp(argv[i], "-OutIr") == 0 && i + 1 < argc) {
-            out_ir_arg = argv[++i];
-        } else if (_stricmp(argv[i], "-EmitIr") == 0 && i + 1 < argc) {
-            emit_ir = atoi(argv[++i]) != 0;
-        } else if (_stricmp(argv[i], "-StrictPos") == 0 && i + 1 < argc) {
-            strict_pos = atoi(argv[++i]) != 0;
-        } else if (_stricmp(argv[i], "-AllowScopeBlocks") == 0 && i + 1 < argc) {
-            allow_scope_blocks = atoi(argv[++i]) != 0;
-        } else if (_stricmp(argv[i], "-h") == 0 || _stricmp(argv[i], "--help") == 0 || _stricmp(argv[i], "/?") == 0) {
-            print_usage(argv[0]);
-            return 0;
-        } else {
-            fprintf(stderr, "[atf2ael] Unknown arg: %s\n", argv[i]);
-            print_usage(argv[0]);
-            return 2;
+static size_t read_view_chunk(void *ctx, char *buf, size_t cap) {
+    ViewReader *r = (ViewReader *)ctx;
+    size_t n = r->len - r->pos;
+    if (n > cap) n = cap;
+    memcpy(buf, r->data + r->pos, n);
+    r->pos += n;
+    return n;
+}
+
+static size_t read_file_chunk(void *ctx, char *buf, size_t cap) {
+    FILE *fp = (FILE *)ctx;
+    size_t n = fread(buf, 1, cap, fp);
+    return (n == 0 && ferror(fp)) ? (size_t)-1 : n;
+}
+
+/*
+ * IR -> AEL for an already loaded program, or for IR text streamed through `read` when program is
+ * NULL. Returns 0 on success, 1 with a message in err.
+ */
+static int emit_ael_file(const IRProgram *program, Ir2AelReadFn read, void *read_ctx, const char *out_ael,
+                         const ConvertOptions *opt, char *err, size_t err_cap) {
+    make_parent_dirs(out_ael);
+    FILE *fp = fopen(out_ael, "wb");
+    if (!fp) {
+        snprintf(err, err_cap, "Cannot open output: %s", out_ael);
+        return 1;
+    }
+
+    AelEmitter emitter;
+    if (!ael_emit_init(&emitter, fp, opt->strict_pos)) {
+        snprintf(err, err_cap, "out of memory");
+        fclose(fp);
+        return 1;
+    }
+    emitter.allow_num_local_scope_blocks = opt->allow_scope_blocks;
+
+    char detail[512];
+    bool ok;
+    if (program) {
+        Ir2AelConvertOptions conv_opt;
+        conv_opt.jobs = opt->convert_jobs;
+        ok = ir2ael_convert_program_ex(program, &emitter, &conv_opt, detail, sizeof(detail));
+    } else {
+        Ir2AelStreamOptions stream_opt;
+        stream_opt.window = 0;
+        ok = ir2ael_convert_stream(read, read_ctx, &emitter, &stream_opt, NULL, detail, sizeof(detail));
+    }
+    ael_emit_free(&emitter);
+    fclose(fp);
+
+    if (!ok) {
+        snprintf(err, err_cap, "Convert failed: %s", detail);
+        return 1;
+    }
+    return 0;
+}
+
+/* Converts a cached IR file (*.ir.txt or binary *.irb) without the ATF stage. */
+static int convert_ir_input(const char *in_ir, const char *out_ael, const ConvertOptions *opt, char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (opt->stream) {
+        FILE *fp = fopen(in_ir, "rb");
+        if (!fp) {
+            snprintf(err, err_cap, "IR parse failed: %s (cannot open)", in_ir);
+            return 1;
+        }
+        IrbHeader head;
+        size_t head_len = fread(&head, 1, sizeof(head), fp);
+        rewind(fp);
+        if (!ir_binary_detect(&head, head_len)) {
+            int rc = emit_ael_file(NULL, read_file_chunk, fp, out_ael, opt, err, err_cap);
+            fclose(fp);
+            return rc;
         }
+        fclose(fp); /* binary IR is already compact; load it whole */
     }
 
-    if (!in_atf || !out_ael) {
-        print_usage(argv[0]);
-        return 2;
+    char detail[512];
+    IRProgram program;
+    ir_program_init(&program);
+    if (!ir_parse_file(in_ir, &program, detail, sizeof(detail))) {
+        snprintf(err, err_cap, "IR parse failed: %s (%s)", in_ir, detail);
+        ir_program_free(&program);
+        return 1;
+    }
+    int rc = emit_ael_file(&program, NULL, NULL, out_ael, opt, err, err_cap);
+    ir_program_free(&program);
+    return rc;
+}
+
+/*
+ * Serves a conversion from the cache. ir_text_out/out_irb request the IR side output; a binary
+ * one is rebuilt from the cached IR text. Returns false on a miss (outputs are then regenerated).
+ */
+static bool fetch_cached(Atf2AelCache *cache, const Atf2AelCacheKey *key, const char *out_ael,
+                         const char *ir_text_out, const char *out_irb) {
+    make_parent_dirs(out_ael);
+    if (!out_irb) return atf2ael_cache_lookup(cache, key, out_ael, ir_text_out);
+
+    char tmp_ir[MAX_PATH * 4];
+    if (!atf2ael_temp_file_create("atf2ael", tmp_ir, sizeof(tmp_ir))) return false;
+    bool ok = atf2ael_cache_lookup(cache, key, out_ael, tmp_ir);
+    if (ok) {
+        char detail[512];
+        IRProgram program;
+        ir_program_init(&program);
+        make_parent_dirs(out_irb);
+        ok = ir_parse_file(tmp_ir, &program, detail, sizeof(detail)) &&
+             ir_binary_write_file(&program, out_irb, detail, sizeof(detail));
+        ir_program_free(&program);
+    }
+    atf2ael_temp_file_remove(tmp_ir);
+    return ok;
+}
+
+static void print_cache_stats(FILE *fp, Atf2AelCache *cache) {
+    Atf2AelCacheStats st;
+    atf2ael_cache_get_stats(cache, &st);
+    fprintf(fp, "[atf2ael] Cache: %llu hits, %llu misses, %llu stored, %llu store failures, %llu evicted (%.1f MB), %.1f MB in use\n",
+            (unsigned long long)st.hits, (unsigned long long)st.misses, (unsigned long long)st.stores,
+            (unsigned long long)st.store_failures, (unsigned long long)st.evictions,
+            (double)st.evicted_bytes / (1024.0 * 1024.0), (double)st.bytes_in_use / (1024.0 * 1024.0));
+}
+
+/* Windows refuses to delete a file while a view of it is mapped, so the temp IR goes only after the close. */
+static void close_ir_view(IRFileView *view, const char *temp_path) {
+    ir_file_view_close(view);
+    if (temp_path) atf2ael_temp_file_remove(temp_path);
+}
+
+/*
+ * Converts one ATF file. Returns 0 on success; on failure returns 1 and leaves a
+ * message in err. If an IR side output was written, its path is copied to kept_ir.
+ * An out_ir_arg ending in ".irb" is written in the binary IR format.
+ */
+static int convert_one(const char *in_atf, const char *out_ael, const char *out_ir_arg, const ConvertOptions *opt,
+                       char *err, size_t err_cap, char *kept_ir, size_t kept_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (kept_ir && kept_cap) kept_ir[0] = '\0';
+
+    const char *out_irb = NULL;
+    if (out_ir_arg && has_ext(out_ir_arg, ".irb")) {
+        /* atf_to_ir() only produces text; it goes to a temp file and is re-saved as binary. */
+        out_irb = out_ir_arg;
+        out_ir_arg = NULL;
     }
 
     bool keep_ir = false;
-    if (out_ir_arg) {
+    if (out_irb) {
+        keep_ir = false;
+    } else if (out_ir_arg) {
         keep_ir = true;
-    } else if (emit_ir == 1) {
+    } else if (opt->emit_ir == 1) {
         keep_ir = true;
-    } else if (emit_ir == 0) {
+    } else if (opt->emit_ir == 0) {
         keep_ir = false;
     }
 
@@ -149,63 +297,357 @@ int main(int argc, char **argv) {
             derive_default_ir_path_from_ael(out_ael, ir_path, sizeof(ir_path));
         }
         if (!ir_path[0]) {
-            fprintf(stderr, "[atf2ael] Failed to derive IR output path.\n");
+            snprintf(err, err_cap, "Failed to derive IR output path.");
             return 1;
         }
         make_parent_dirs(ir_path);
-    } else {
-        if (!make_temp_ir_file(ir_path, sizeof(ir_path))) {
-            fprintf(stderr, "[atf2ael] Failed to create temp IR file path.\n");
+    }
+
+    /* Cache check goes before atf_to_ir(); an unreadable ATF just skips the cache and fails below. */
+    Atf2AelCacheKey cache_key;
+    bool use_cache = opt->cache &&
+                     atf2ael_cache_key_file(opt->cache, in_atf, opt->strict_pos, opt->allow_scope_blocks, &cache_key, NULL, 0);
+    if (use_cache && fetch_cached(opt->cache, &cache_key, out_ael, keep_ir ? ir_path : NULL, out_irb)) {
+        const char *kept = keep_ir ? ir_path : out_irb;
+        if (kept && kept_ir && kept_cap) {
+            strncpy(kept_ir, kept, kept_cap - 1);
+            kept_ir[kept_cap - 1] = '\0';
+        }
+        return 0;
+    }
+
+    if (!keep_ir) {
+        if (!atf2ael_temp_file_create("atf2ael", ir_path, sizeof(ir_path))) {
+            snprintf(err, err_cap, "Failed to create temp IR file path.");
             return 1;
         }
         is_temp_ir = true;
     }
 
-    make_parent_dirs(out_ael);
-
-    int rc = atf_to_ir(in_atf, ir_path);
+    int rc = atf2ael_atf_to_ir(in_atf, ir_path);
     if (rc != 0) {
-        fprintf(stderr, "[atf2ael] ATF->IR failed (rc=%d): %s\n", rc, in_atf);
-        if (is_temp_ir) DeleteFileA(ir_path);
+        snprintf(err, err_cap, "ATF->IR failed (rc=%d): %s", rc, in_atf);
+        if (is_temp_ir) atf2ael_temp_file_remove(ir_path);
         return 1;
     }
 
-    char err[512];
-    IRProgram program;
-    ir_program_init(&program);
-    if (!ir_parse_file(ir_path, &program, err, sizeof(err))) {
-        fprintf(stderr, "[atf2ael] IR parse failed: %s (%s)\n", ir_path, err);
-        ir_program_free(&program);
-        if (is_temp_ir) DeleteFileA(ir_path);
+    char detail[512];
+    IRFileView ir_view;
+    if (!ir_file_view_open(ir_path, &ir_view, detail, sizeof(detail))) {
+        if (is_temp_ir) atf2ael_temp_file_remove(ir_path);
+        snprintf(err, err_cap, "IR read failed: %s (%s)", ir_path, detail);
         return 1;
     }
 
-    FILE *fp = fopen(out_ael, "wb");
-    if (!fp) {
-        fprintf(stderr, "[atf2ael] Cannot open output: %s\n", out_ael);
+    /* Streaming parses while converting, straight from the view; a binary side output needs the whole program. */
+    bool streaming = opt->stream && !out_irb;
+    IRProgram program;
+    ir_program_init(&program);
+    bool parse_ok = streaming || ir_parse_buffer(ir_view.data, ir_view.len, &program, detail, sizeof(detail));
+    if (parse_ok && use_cache && (opt->cache_ir || keep_ir || out_irb)) {
+        atf2ael_cache_store_bytes(opt->cache, &cache_key, ATF2AEL_CACHE_IR, ir_view.data, ir_view.len);
+    }
+    if (!streaming) close_ir_view(&ir_view, is_temp_ir ? ir_path : NULL);
+    if (!parse_ok) {
+        snprintf(err, err_cap, "IR parse failed: %s (%s)", ir_path, detail);
         ir_program_free(&program);
-        if (is_temp_ir) DeleteFileA(ir_path);
         return 1;
     }
 
-    AelEmitter emitter;
-    ael_emit_init(&emitter, fp, strict_pos);
-    emitter.allow_num_local_scope_blocks = allow_scope_blocks;
+    if (out_irb) {
+        make_parent_dirs(out_irb);
+        if (!ir_binary_write_file(&program, out_irb, detail, sizeof(detail))) {
+            snprintf(err, err_cap, "IR write failed: %s", detail);
+            ir_program_free(&program);
+            return 1;
+        }
+        snprintf(ir_path, sizeof(ir_path), "%s", out_irb);
+        is_temp_ir = false;
+    }
 
-    bool ok = ir2ael_convert_program(&program, &emitter, err, sizeof(err));
-    fclose(fp);
+    int emit_rc;
+    if (streaming) {
+        ViewReader reader = {ir_view.data, ir_view.len, 0};
+        emit_rc = emit_ael_file(NULL, read_view_chunk, &reader, out_ael, opt, err, err_cap);
+        close_ir_view(&ir_view, is_temp_ir ? ir_path : NULL);
+    } else {
+        emit_rc = emit_ael_file(&program, NULL, NULL, out_ael, opt, err, err_cap);
+    }
     ir_program_free(&program);
+    if (emit_rc != 0) return emit_rc;
+    if (use_cache) atf2ael_cache_store_file(opt->cache, &cache_key, ATF2AEL_CACHE_AEL, out_ael);
 
-    if (!ok) {
-        fprintf(stderr, "[atf2ael] Convert failed: %s\n", err);
-        if (is_temp_ir) DeleteFileA(ir_path);
+    if (!is_temp_ir && kept_ir && kept_cap) {
+        strncpy(kept_ir, ir_path, kept_cap - 1);
+        kept_ir[kept_cap - 1] = '\0';
+    }
+    return 0;
+}
+
+/* ---- Batch mode (-InDir/-OutDir) ---- */
+
+typedef struct BatchJob {
+    char in_path[MAX_PATH * 4];
+    char out_path[MAX_PATH * 4];
+    int rc;
+    ULONGLONG elapsed_ms;
+    char err[512];
+} BatchJob;
+
+typedef struct BatchQueue {
+    BatchJob *jobs;
+    size_t count;
+    size_t cap;
+    volatile LONG next;
+    const ConvertOptions *opt;
+} BatchQueue;
+
+static bool has_atf_ext(const char *name) {
+    size_t n = strlen(name);
+    return n >= 4 && _stricmp(name + (n - 4), ".atf") == 0;
+}
+
+static bool batch_push(BatchQueue *q, const char *in_path, const char *out_path) {
+    if (q->count == q->cap) {
+        size_t new_cap = q->cap ? q->cap * 2 : 256;
+        BatchJob *nj = (BatchJob *)realloc(q->jobs, new_cap * sizeof(BatchJob));
+        if (!nj) return false;
+        q->jobs = nj;
+        q->cap = new_cap;
+    }
+    BatchJob *j = &q->jobs[q->count++];
+    memset(j, 0, sizeof(*j));
+    snprintf(j->in_path, sizeof(j->in_path), "%s", in_path);
+    snprintf(j->out_path, sizeof(j->out_path), "%s", out_path);
+    j->rc = -1;
+    return true;
+}
+
+/* Recursively collects *.atf under in_dir; output keeps the relative layout under out_dir. */
+static bool batch_collect(BatchQueue *q, const char *in_dir, const char *out_dir) {
+    char pattern[MAX_PATH * 4];
+    snprintf(pattern, sizeof(pattern), "%s\\*", in_dir);
+
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(pattern, &fd);
+    if (h == INVALID_HANDLE_VALUE) return true;
+
+    bool ok = true;
+    do {
+        const char *name = fd.cFileName;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) continue;
+
+        char in_path[MAX_PATH * 4];
+        char out_path[MAX_PATH * 4];
+        snprintf(in_path, sizeof(in_path), "%s\\%s", in_dir, name);
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            snprintf(out_path, sizeof(out_path), "%s\\%s", out_dir, name);
+            if (!batch_collect(q, in_path, out_path)) ok = false;
+        } else if (has_atf_ext(name)) {
+            /* replace ".atf" with ".ael" */
+            snprintf(out_path, sizeof(out_path), "%s\\%.*s.ael", out_dir, (int)(strlen(name) - 4), name);
+            if (!batch_push(q, in_path, out_path)) ok = false;
+        }
+    } while (ok && FindNextFileA(h, &fd));
+    FindClose(h);
+    return ok;
+}
+
+static DWORD WINAPI batch_worker(LPVOID arg) {
+    BatchQueue *q = (BatchQueue *)arg;
+    for (;;) {
+        LONG idx = InterlockedIncrement(&q->next) - 1;
+        if (idx < 0 || (size_t)idx >= q->count) break;
+        BatchJob *j = &q->jobs[idx];
+        ULONGLONG t0 = GetTickCount64();
+        j->rc = convert_one(j->in_path, j->out_path, NULL, q->opt, j->err, sizeof(j->err), NULL, 0);
+        j->elapsed_ms = GetTickCount64() - t0;
+    }
+    return 0;
+}
+
+static int run_batch(const char *in_dir, const char *out_dir, int jobs, const ConvertOptions *opt) {
+    if (!dir_exists(in_dir)) {
+        fprintf(stderr, "[atf2ael] Input directory not found: %s\n", in_dir);
+        return 2;
+    }
+
+    BatchQueue q;
+    memset(&q, 0, sizeof(q));
+    q.opt = opt;
+    if (!batch_collect(&q, in_dir, out_dir)) {
+        fprintf(stderr, "[atf2ael] out of memory while scanning: %s\n", in_dir);
+        free(q.jobs);
         return 1;
     }
+    if (q.count == 0) {
+        fprintf(stderr, "[atf2ael] No .atf files under: %s\n", in_dir);
+        free(q.jobs);
+        return 0;
+    }
+
+    if (jobs <= 0) {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        jobs = (int)si.dwNumberOfProcessors;
+    }
+    if (jobs < 1) jobs = 1;
+    if (jobs > MAXIMUM_WAIT_OBJECTS) jobs = MAXIMUM_WAIT_OBJECTS;
+    if ((size_t)jobs > q.count) jobs = (int)q.count;
 
-    if (is_temp_ir) {
-        DeleteFileA(ir_path);
+    ULONGLONG t0 = GetTickCount64();
+    HANDLE threads[MAXIMUM_WAIT_OBJECTS];
+    int started = 0;
+    for (int t = 0; t < jobs; t++) {
+        threads[started] = CreateThread(NULL, 0, batch_worker, &q, 0, NULL);
+        if (threads[started]) started++;
+    }
+    if (started == 0) {
+        batch_worker(&q); /* fall back to the calling thread */
     } else {
-        fprintf(stderr, "[atf2ael] IR output: %s\n", ir_path);
+        WaitForMultipleObjects((DWORD)started, threads, TRUE, INFINITE);
+        for (int t = 0; t < started; t++) CloseHandle(threads[t]);
+    }
+    ULONGLONG wall_ms = GetTickCount64() - t0;
+
+    size_t ok_count = 0;
+    for (size_t k = 0; k < q.count; k++) {
+        const BatchJob *j = &q.jobs[k];
+        if (j->rc == 0) {
+            ok_count++;
+            printf("[OK]   %s -> %s (%llu ms)\n", j->in_path, j->out_path, (unsigned long long)j->elapsed_ms);
+        } else {
+            printf("[FAIL] %s: %s\n", j->in_path, j->err[0] ? j->err : "not converted");
+        }
+    }
+    printf("[atf2ael] Batch: %zu files, %zu ok, %zu failed, %d workers, %llu ms\n",
+           q.count, ok_count, q.count - ok_count, started > 0 ? started : 1, (unsigned long long)wall_ms);
+    if (opt->cache) print_cache_stats(stdout, opt->cache);
+
+    free(q.jobs);
+    return ok_count == q.count ? 0 : 1;
+}
+
+/* Opens -CacheDir (if given) into opt->cache; false with a message on stderr. */
+static bool open_cache(const char *cache_dir, long long max_mb, ConvertOptions *opt) {
+    opt->cache = NULL;
+    if (!cache_dir) return true;
+    char err[512];
+    uint64_t max_bytes = max_mb > 0 ? (uint64_t)max_mb * 1024 * 1024 : 0;
+    opt->cache = atf2ael_cache_open(cache_dir, max_bytes, err, sizeof(err));
+    if (!opt->cache) {
+        fprintf(stderr, "[atf2ael] %s\n", err);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *in_atf = NULL;
+    const char *out_ael = NULL;
+    const char *out_ir_arg = NULL;
+    const char *in_ir = NULL;
+    const char *in_dir = NULL;
+    const char *out_dir = NULL;
+    int jobs = 0; /* 0: one worker per logical processor */
+    const char *cache_dir = NULL;
+    long long cache_max_mb = 1024;
+    ConvertOptions opt;
+    opt.emit_ir = -1;
+    opt.strict_pos = false;
+    /* Default to disabled: ATF-derived IR may have emitter-dependent locals/scope bookkeeping,
+       which should not influence AEL structure unless explicitly requested. */
+    opt.allow_scope_blocks = false;
+    opt.convert_jobs = 1;
+    opt.cache = NULL;
+    opt.cache_ir = false;
+    opt.stream = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (_stricmp(argv[i], "-In") == 0 && i + 1 < argc) {
+            in_atf = argv[++i];
+        } else if (_stricmp(argv[i], "-InIr") == 0 && i + 1 < argc) {
+            in_ir = argv[++i];
+        } else if (_stricmp(argv[i], "-Out") == 0 && i + 1 < argc) {
+            out_ael = argv[++i];
+        } else if (_stricmp(argv[i], "-InDir") == 0 && i + 1 < argc) {
+            in_dir = argv[++i];
+        } else if (_stricmp(argv[i], "-OutDir") == 0 && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (_stricmp(argv[i], "-Jobs") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (_stricmp(argv[i], "-OutIr") == 0 && i + 1 < argc) {
+            out_ir_arg = argv[++i];
+        } else if (_stricmp(argv[i], "-EmitIr") == 0 && i + 1 < argc) {
+            opt.emit_ir = atoi(argv[++i]) != 0;
+        } else if (_stricmp(argv[i], "-StrictPos") == 0 && i + 1 < argc) {
+            opt.strict_pos = atoi(argv[++i]) != 0;
+        } else if (_stricmp(argv[i], "-AllowScopeBlocks") == 0 && i + 1 < argc) {
+            opt.allow_scope_blocks = atoi(argv[++i]) != 0;
+        } else if (_stricmp(argv[i], "-CacheDir") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (_stricmp(argv[i], "-CacheMaxMB") == 0 && i + 1 < argc) {
+            cache_max_mb = _atoi64(argv[++i]);
+        } else if (_stricmp(argv[i], "-CacheIr") == 0 && i + 1 < argc) {
+            opt.cache_ir = atoi(argv[++i]) != 0;
+        } else if (_stricmp(argv[i], "-Stream") == 0 && i + 1 < argc) {
+            opt.stream = atoi(argv[++i]) != 0;
+        } else if (_stricmp(argv[i], "-h") == 0 || _stricmp(argv[i], "--help") == 0 || _stricmp(argv[i], "/?") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "[atf2ael] Unknown arg: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (in_dir || out_dir) {
+        if (!in_dir || !out_dir || in_atf || in_ir || out_ael || out_ir_arg) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        if (!open_cache(cache_dir, cache_max_mb, &opt)) return 1;
+        /* Files already run in parallel; each one converts on its worker thread. */
+        int rc = run_batch(in_dir, out_dir, jobs, &opt);
+        atf2ael_cache_close(opt.cache);
+        return rc;
+    }
+
+    opt.convert_jobs = jobs;
+
+    char err[1024];
+    if (in_ir) {
+        if (in_atf || !out_ael || out_ir_arg || cache_dir) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        if (convert_ir_input(in_ir, out_ael, &opt, err, sizeof(err)) != 0) {
+            fprintf(stderr, "[atf2ael] %s\n", err);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!in_atf || !out_ael) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    if (!open_cache(cache_dir, cache_max_mb, &opt)) return 1;
+    char kept_ir[MAX_PATH * 4];
+    int rc = convert_one(in_atf, out_ael, out_ir_arg, &opt, err, sizeof(err), kept_ir, sizeof(kept_ir));
+    if (opt.cache) {
+        print_cache_stats(stderr, opt.cache);
+        atf2ael_cache_close(opt.cache);
+    }
+    if (rc != 0) {
+        fprintf(stderr, "[atf2ael] %s\n", err);
+        return 1;
+    }
+
+    if (kept_ir[0]) {
+        fprintf(stderr, "[atf2ael] IR output: %s\n", kept_ir);
     }
 
     return 0;
@@ -19,7 +19,7 @@ if not exist build mkdir build
 echo [BUILD] Build directory ready
 
 REM Clean old build artifacts
-del /q build\*.exe build\*.obj build\*.pdb 2>nul
+del /q build\*.exe build\*.lib build\*.obj build\*.pdb 2>nul
 
 REM Setup Visual Studio environment
 echo [BUILD] Setting up MSVC environment...
@@ -42,11 +42,13 @@ echo [BUILD]   - src/ael_parser_functions.c
 echo [BUILD]   - src/yacc_parser_tables.c
 echo [BUILD]   - src/ascan_lex.c
 echo [BUILD]   - src/ir_generator.c
+echo [BUILD]   - src/str_intern.c
 echo [BUILD]   - src/ir_text_parser.c
 echo [BUILD]   - src/opcode_metadata.c
 echo [BUILD]   - src/token_to_subopcode.c
 echo [BUILD]   - src/output.c
 echo [BUILD]   - src/compiler_progressive.c
+echo [BUILD]   - src/ael_compiler.c
 echo.
 
 REM Compile ael2ir
@@ -65,10 +67,12 @@ cl.exe /nologo /W3 /O2 ^
     src/ascan_lex_minimal.c ^
     src/lexer_state.c ^
     src/ir_generator.c ^
+    src/str_intern.c ^
     src/opcode_metadata.c ^
     src/token_to_subopcode.c ^
     src/output.c ^
-    src/compiler_progressive.c
+    src/compiler_progressive.c ^
+    src/ael_compiler.c
 
 set COMPILE_EXIT=%ERRORLEVEL%
 
@@ -82,14 +86,19 @@ if %COMPILE_EXIT% EQU 0 (
         /Fe:build\ir2ael.exe ^
         ir2ael_main.c ^
         src/ir_text_parser.c ^
+        src/str_intern.c ^
+        src/ir_binary.c ^
+        src/ir_label_index.c ^
         src/ael_emit.c ^
         src/ir2ael_helpers.c ^
+        src/ir2ael_float_format.c ^
+        src/ir2ael_expr_arena.c ^
+        src/ir2ael_regions.c ^
         src/ir2ael_convert_state.c ^
         src/ir2ael_convert_decl.c ^
         src/ir2ael_convert_scope.c ^
         src/ir2ael_convert_load.c ^
-        src/ir2ael_convert_flow.c ^
-        src/ir2ael_convert_flow_switch.c ^
+                src/ir2ael_convert_flow_switch.c ^
         src/ir2ael_convert_flow_loop.c ^
         src/ir2ael_convert_flow_end.c ^
         src/ir2ael_convert_flow_loop_ctl.c ^
@@ -101,6 +110,10 @@ if %COMPILE_EXIT% EQU 0 (
         src/ir2ael_convert_expr_call.c ^
         src/ir2ael_convert_expr_ops.c ^
         src/ir2ael_convert_finalize.c ^
+        src/ir2ael_convert_dispatch.c ^
+        src/ir2ael_prof.c ^
+        src/ir2ael_convert_parallel.c ^
+        src/ir2ael_convert_stream.c ^
         src/ir2ael_convert.c
     set COMPILE_EXIT=%ERRORLEVEL%
 )
@@ -161,14 +174,21 @@ if %COMPILE_EXIT% EQU 0 (
         /Fd:build\ ^
         /Fe:build\atf2ael.exe ^
         atf2ael_main.c ^
+        src\atf2ael_atf_stage.c ^
+        src\atf2ael_cache.c ^
         src\ir_text_parser.c ^
+        src\str_intern.c ^
+        src\ir_binary.c ^
+        src\ir_label_index.c ^
         src\ael_emit.c ^
         src\ir2ael_helpers.c ^
+        src\ir2ael_float_format.c ^
+        src\ir2ael_expr_arena.c ^
+        src\ir2ael_regions.c ^
         src\ir2ael_convert_state.c ^
         src\ir2ael_convert_decl.c ^
         src\ir2ael_convert_scope.c ^
         src\ir2ael_convert_load.c ^
-        src\ir2ael_convert_flow.c ^
         src\ir2ael_convert_flow_switch.c ^
         src\ir2ael_convert_flow_loop.c ^
         src\ir2ael_convert_flow_end.c ^
@@ -181,6 +201,10 @@ if %COMPILE_EXIT% EQU 0 (
         src\ir2ael_convert_expr_call.c ^
         src\ir2ael_convert_expr_ops.c ^
         src\ir2ael_convert_finalize.c ^
+        src\ir2ael_convert_dispatch.c ^
+        src\ir2ael_prof.c ^
+        src\ir2ael_convert_parallel.c ^
+        src\ir2ael_convert_stream.c ^
         src\ir2ael_convert.c ^
         ..\..\atf2ir_c_code\src\atf_reader.c ^
         ..\..\atf2ir_c_code\src\type_parser.c ^
@@ -219,6 +243,143 @@ if %COMPILE_EXIT% EQU 0 (
     set COMPILE_EXIT=%ERRORLEVEL%
 )
 
+REM Build libatf2ael (static library for embedding, see include/atf2ael_lib.h)
+if %COMPILE_EXIT% EQU 0 (
+    if not exist build\lib mkdir build\lib
+    del /q build\lib\*.obj 2>nul
+    cl.exe /nologo /W3 /O2 /c ^
+        /I"include" ^
+        /I"..\..\atf2ir_c_code\include" ^
+        /D_CRT_SECURE_NO_WARNINGS ^
+        /Fo:build\lib\ ^
+        /Fd:build\lib\ ^
+        src\atf2ael_lib.c ^
+        src\atf2ael_lib_atf.c ^
+        src\atf2ael_atf_stage.c ^
+        src\ael_parser_new.c ^
+        src\ael_parser_statements.c ^
+        src\ael_parser_functions.c ^
+        src\yacc_parser_tables.c ^
+        src\parser_globals.c ^
+        src\ascan_lex_minimal.c ^
+        src\lexer_state.c ^
+        src\ir_generator.c ^
+        src\opcode_metadata.c ^
+        src\token_to_subopcode.c ^
+        src\output.c ^
+        src\compiler_progressive.c ^
+        src\ael_compiler.c ^
+        src\ir_text_parser.c ^
+        src\str_intern.c ^
+        src\ir_binary.c ^
+        src\ir_label_index.c ^
+        src\ael_emit.c ^
+        src\ir2ael_helpers.c ^
+        src\ir2ael_float_format.c ^
+        src\ir2ael_expr_arena.c ^
+        src\ir2ael_regions.c ^
+        src\ir2ael_convert_state.c ^
+        src\ir2ael_convert_decl.c ^
+        src\ir2ael_convert_scope.c ^
+        src\ir2ael_convert_load.c ^
+        src\ir2ael_convert_flow_switch.c ^
+        src\ir2ael_convert_flow_loop.c ^
+        src\ir2ael_convert_flow_end.c ^
+        src\ir2ael_convert_flow_loop_ctl.c ^
+        src\ir2ael_convert_flow_labels.c ^
+        src\ir2ael_convert_flow_branch.c ^
+        src\ir2ael_convert_flow_load_true.c ^
+        src\ir2ael_convert_expr.c ^
+        src\ir2ael_convert_expr_assign.c ^
+        src\ir2ael_convert_expr_call.c ^
+        src\ir2ael_convert_expr_ops.c ^
+        src\ir2ael_convert_finalize.c ^
+        src\ir2ael_convert_dispatch.c ^
+        src\ir2ael_prof.c ^
+        src\ir2ael_convert_parallel.c ^
+        src\ir2ael_convert_stream.c ^
+        src\ir2ael_convert.c ^
+        ..\..\atf2ir_c_code\src\atf_reader.c ^
+        ..\..\atf2ir_c_code\src\type_parser.c ^
+        ..\..\atf2ir_c_code\src\context_manager.c ^
+        ..\..\atf2ir_c_code\src\ir_writer.c ^
+        ..\..\atf2ir_c_code\src\atf_to_ir.c ^
+        ..\..\atf2ir_c_code\src\atf_to_ir_items.c ^
+        ..\..\atf2ir_c_code\src\atf_to_ir_postpass.c ^
+        ..\..\atf2ir_c_code\src\atf_to_ir_pass_switch.c ^
+        ..\..\atf2ir_c_code\src\atf_to_ir_pass_locals.c ^
+        ..\..\atf2ir_c_code\src\atf_to_ir_pass_loops.c ^
+        ..\..\atf2ir_c_code\src\atf_to_ir_pass_utils.c ^
+        ..\..\atf2ir_c_code\src\decoders\decoder_registry.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type3_vocab_decl.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type4_var_decl.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type5_var_ref.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type6_integer.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type7_real.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type8_complex.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type9_string.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type10_null.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type12_func_begin.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type13_marker.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type14_local_decl.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_var_ref_common.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type17_depth.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type18_operator.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type19_label_decl.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type20_label_mark.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type21_branch.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type22_func_def.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type23_drop_local.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type24_switch_table.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type25_char.c ^
+        ..\..\atf2ir_c_code\src\decoders\decode_type26_bool.c
+    set COMPILE_EXIT=!ERRORLEVEL!
+    if !COMPILE_EXIT! EQU 0 (
+        lib.exe /nologo /OUT:build\libatf2ael.lib build\lib\*.obj
+        set COMPILE_EXIT=!ERRORLEVEL!
+    )
+)
+
+REM Compile atf2ael_bench (stage benchmark over full_test_case_ael, links libatf2ael)
+if %COMPILE_EXIT% EQU 0 (
+    cl.exe /nologo /W3 /O2 ^
+        /I"include" ^
+        /D_CRT_SECURE_NO_WARNINGS ^
+        /Fo:build\ ^
+        /Fd:build\ ^
+        /Fe:build\atf2ael_bench.exe ^
+        atf2ael_bench_main.c ^
+        build\libatf2ael.lib ^
+        psapi.lib
+    set COMPILE_EXIT=!ERRORLEVEL!
+)
+
+REM Compile ael_gen (synthetic AEL workload generator, compiles its output with the ael2ir front end)
+if %COMPILE_EXIT% EQU 0 (
+    cl.exe /nologo /W3 /O2 ^
+        /I"include" ^
+        /D_CRT_SECURE_NO_WARNINGS ^
+        /Fo:build\ ^
+        /Fd:build\ ^
+        /Fe:build\ael_gen.exe ^
+        ael_gen_main.c ^
+        src\ael_parser_new.c ^
+        src\ael_parser_statements.c ^
+        src\ael_parser_functions.c ^
+        src\yacc_parser_tables.c ^
+        src\parser_globals.c ^
+        src\ascan_lex_minimal.c ^
+        src\lexer_state.c ^
+        src\ir_generator.c ^
+        src\str_intern.c ^
+        src\opcode_metadata.c ^
+        src\token_to_subopcode.c ^
+        src\output.c ^
+        src\compiler_progressive.c ^
+        src\ael_compiler.c
+    set COMPILE_EXIT=!ERRORLEVEL!
+)
+
 REM Check result
 echo.
 if %COMPILE_EXIT% EQU 0 (
@@ -227,6 +388,7 @@ if %COMPILE_EXIT% EQU 0 (
     echo [BUILD] ========================================
     REM Keep repository clean: remove intermediate build artifacts (keep only .exe)
     del /q build\*.obj build\*.pdb build\*.ilk 2>nul
+    if exist build\lib rmdir /s /q build\lib
     if exist build\ael2ir.exe (
         echo [BUILD] Output: build\ael2ir.exe
         dir build\ael2ir.exe | findstr "ael2ir"
@@ -251,6 +413,24 @@ if %COMPILE_EXIT% EQU 0 (
     ) else (
         echo [WARNING] atf2ael compilation succeeded but executable not found
     )
+    if exist build\libatf2ael.lib (
+        echo [BUILD] Output: build\libatf2ael.lib
+        dir build\libatf2ael.lib | findstr "libatf2ael"
+    ) else (
+        echo [WARNING] libatf2ael build succeeded but library not found
+    )
+    if exist build\atf2ael_bench.exe (
+        echo [BUILD] Output: build\atf2ael_bench.exe
+        dir build\atf2ael_bench.exe | findstr "atf2ael_bench"
+    ) else (
+        echo [WARNING] atf2ael_bench compilation succeeded but executable not found
+    )
+    if exist build\ael_gen.exe (
+        echo [BUILD] Output: build\ael_gen.exe
+        dir build\ael_gen.exe | findstr "ael_gen"
+    ) else (
+        echo [WARNING] ael_gen compilation succeeded but executable not found
+    )
 ) else (
     echo [BUILD] ========================================
     echo [BUILD] FAILED with exit code %COMPILE_EXIT%
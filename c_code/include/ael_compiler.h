@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * AEL -> IR compiler context.
+ *
+ * Everything the front end keeps between calls (lexer input and position, the values handed from
+ * the lexer to the parser, parser lookahead and position trackers, the generated IR) lives in one
+ * AelCompiler, so separate compilations can run concurrently, one per thread.
+ *
+ * ascan_lex, parse_ael_program and the acomp_* generators work on the compiler bound to the calling
+ * thread. Threads that never bind one get their own default compiler, which is what the
+ * single-file ael2ir driver uses.
+ */
+typedef struct AelCompiler AelCompiler;
+
+/* Receives IR text in chunks; returning false stops the write. */
+typedef bool (*AelIrWriteFn)(void *ctx, const char *data, size_t len);
+
+/* Returns NULL on OOM. */
+AelCompiler *ael_compiler_create(void);
+void ael_compiler_destroy(AelCompiler *c);
+
+/* Binds `c` to the calling thread (NULL: back to the thread's default); returns the previous binding. */
+AelCompiler *ael_compiler_bind(AelCompiler *c);
+
+/* Compiles the AEL text readable from `fp` into c's IR (any earlier IR in `c` is discarded). */
+bool ael_compiler_parse(AelCompiler *c, FILE *fp);
+/* Same, reading `len` bytes at `src` in place (no terminator needed); `src` is not kept after the call. */
+bool ael_compiler_parse_buffer(AelCompiler *c, const char *src, size_t len);
+/* Why the last parse failed ("line L:C: ..." or "out of memory"); "" if it did not. */
+const char *ael_compiler_error(const AelCompiler *c);
+/* Writes c's IR in the ael2ir text format. */
+void ael_compiler_write_ir(AelCompiler *c, const char *path);
+/* Same text, handed to `sink`; false on OOM or if the sink failed. */
+bool ael_compiler_write_ir_sink(AelCompiler *c, AelIrWriteFn sink, void *sink_ctx);
+int ael_compiler_ir_count(AelCompiler *c);
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "ael_compiler.h"
+#include "ael_parser_new.h"
+#include "str_intern.h"
+
+#if defined(_MSC_VER)
+#define AEL_THREAD_LOCAL __declspec(thread)
+#else
+#define AEL_THREAD_LOCAL _Thread_local
+#endif
+
+/* ascan_lex_minimal.c: input buffer and scan position */
+typedef struct AelLexer {
+    FILE *input;
+    int line;                     /* 1-based position of the cursor */
+    int col;
+    int token_start_line;         /* position saved before scanning the current token */
+    int token_start_col;
+    unsigned char *src;           /* whole input, read on the first ascan_lex() call */
+    bool owns_src;                /* false for a caller's buffer (ascan_lex_init_buffer) */
+    const unsigned char *cur;
+    const unsigned char *end;
+    bool loaded;
+    unsigned char char_class[256];
+    char buffer[1024];            /* text of the current token */
+} AelLexer;
+
+/* lexer_state.c: values handed from the lexer to the parser */
+typedef struct AelLexValues {
+    char identifier[256];
+    char string[1024];
+    int int_value;
+    double real_value;
+    int line;                     /* 1-based start of the last token */
+    int column;
+} AelLexValues;
+
+/* ael_parser_new.c: lookahead and the position trackers (all positions 0-based) */
+enum { AEL_MAX_TRACKED_LIST_DEPTH = 16 };
+
+typedef struct AelParserState {
+    ParserContext ctx;
+    int lookahead;                /* Lookahead token, -1 if none */
+    int error_count;
+    int last_token_line;
+    int last_token_col;
+    int lookahead_line;
+    int lookahead_col;
+    int last_nonempty_string_line;
+    int last_nonempty_string_col;
+    bool last_nonempty_string_valid;
+    int last_not_line;
+    int last_not_col;
+    bool last_not_valid;
+    int last_compare_line;
+    int last_compare_col;
+    bool last_compare_valid;
+    int last_ident_line;
+    int last_ident_col;
+    bool last_ident_valid;
+    int last_null_line;
+    int last_null_col;
+    bool last_null_valid;
+    int expr_chain_start_line;    /* start of current expression chain */
+    int expr_chain_start_col;
+    bool expr_chain_start_valid;
+    int list_count_by_depth[AEL_MAX_TRACKED_LIST_DEPTH];
+    char first_error[256];        /* "line L:C: ..." of the first error, "" if none */
+} AelParserState;
+
+/* ir_generator.c: generated instructions and the acomp_* bookkeeping */
+typedef struct IRGenInst IRGenInst;
+
+typedef struct AelIrGen {
+    int depth;                    /* AcompDepth */
+    int interact;                 /* AcompInteract */
+    int err_flag;                 /* AerrFlag */
+    int local_var_count;
+    int label_counter;            /* reset per function */
+    IRGenInst *insts;
+    int count;
+    int cap;
+    StrInterner strings;          /* names and literals; one copy per distinct string */
+    bool oom;                     /* an instruction or string was dropped; the IR is incomplete */
+} AelIrGen;
+
+struct AelCompiler {
+    AelLexer lex;
+    AelLexValues vals;
+    AelParserState parser;
+    AelIrGen ir;
+};
+
+/* Resets `c` to a fresh compiler (no input, no IR); does not free anything it held. */
+void ael_compiler_init(AelCompiler *c);
+/* Frees what `c` holds (input buffer, IR) but not `c` itself, for compilers embedded in other structs. */
+void ael_compiler_release(AelCompiler *c);
+
+/* The compiler bound to this thread, or the thread's default one. Never NULL. */
+AelCompiler *ael_compiler_current(void);
+
+/* Lexer and IR teardown (ascan_lex_minimal.c / ir_generator.c). */
+void ascan_lex_init(FILE *fp);
+void ascan_lex_init_buffer(const char *data, size_t len);
+void ascan_lex_reset(void);
@@ -1,10 +1,24 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 
+/* Output sink for buffered emission; returns false on write failure. */
+typedef bool (*AelEmitSinkFn)(void *ctx, const char *data, size_t len);
+
+/* Emitted bytes are staged in a private buffer and handed to the sink only when it fills
+   (or on ael_emit_flush/ael_emit_free). */
+#define AEL_EMIT_BUF_SIZE (64u * 1024u)
+
 typedef struct AelEmitter {
-    FILE *fp;
+    FILE *fp; /* set for FILE-backed emitters (ael_emit_init) */
+    AelEmitSinkFn sink;
+    void *sink_ctx;
+    char *buf;
+    size_t buf_len;
+    size_t buf_cap;
+
     int line0;
     int col0;
     bool strict_pos;
@@ -17,8 +31,14 @@ typedef struct AelEmitter {
 } AelEmitter;
 
 bool ael_emit_init(AelEmitter *e, FILE *fp, bool strict_pos);
+bool ael_emit_init_sink(AelEmitter *e, AelEmitSinkFn sink, void *sink_ctx, bool strict_pos);
+/* Hands buffered bytes to the sink (does not fflush the FILE). */
+bool ael_emit_flush(AelEmitter *e);
+/* Flushes (best-effort) and releases the buffer; the FILE is not closed. */
+void ael_emit_free(AelEmitter *e);
 bool ael_emit_at(AelEmitter *e, int line0, int col0);
 bool ael_emit_text(AelEmitter *e, const char *text);
+bool ael_emit_bytes(AelEmitter *e, const char *data, size_t len);
 bool ael_emit_char(AelEmitter *e, char ch);
 
 enum {
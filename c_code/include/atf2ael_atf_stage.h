@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * File-based ATF -> IR stage shared by atf2ael, atf2ael_bench and libatf2ael.
+ *
+ * atf_to_ir() (atf2ir_c_code) takes file paths and is not known to be reentrant. Every caller in
+ * the process goes through atf2ael_atf_to_ir(), which serializes it under one lock; IR parsing and
+ * IR->AEL run outside it.
+ */
+
+/* atf_to_ir() under the process-wide lock; returns its result (0 on success). */
+int atf2ael_atf_to_ir(const char *atf_file, const char *ir_file);
+
+/*
+ * Creates an empty, uniquely named file in the temp directory and returns its path. On Windows the
+ * file is marked temporary so its data stays in the system cache instead of being flushed to disk.
+ */
+bool atf2ael_temp_file_create(const char *prefix, char *out_path, size_t cap);
+void atf2ael_temp_file_remove(const char *path);
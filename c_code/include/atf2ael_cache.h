@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Content-addressed on-disk cache for atf2ael conversions.
+ *
+ * An entry is keyed by a 64-bit hash of the ATF bytes (plus their length), seeded with a hash of
+ * the running converter binary and the options that change the output (-StrictPos,
+ * -AllowScopeBlocks). It holds the .ael and, optionally, the IR text under <dir>/<xx>/<key>.<ext>.
+ *
+ * atf_to_ir() and ir2ael are linked into that binary, so any rebuild that could change the output
+ * starts from fresh keys; no version needs bumping by hand. Entries of other builds are never
+ * hit again and age out through eviction.
+ *
+ * Writes go to a unique temp file that is renamed into place, so concurrent workers (threads or
+ * processes) sharing a directory never observe a partial entry. A hit bumps the file's
+ * modification time; once the directory grows past max_bytes the least recently used files are
+ * removed until it is back under 90% of the bound.
+ *
+ * All calls are safe from several threads on one cache handle.
+ */
+
+typedef enum Atf2AelCacheKind {
+    ATF2AEL_CACHE_AEL,
+    ATF2AEL_CACHE_IR
+} Atf2AelCacheKind;
+
+typedef struct Atf2AelCacheKey {
+    char name[40]; /* "<16 hex hash>-<hex length>" */
+} Atf2AelCacheKey;
+
+typedef struct Atf2AelCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t stores;
+    uint64_t store_failures;
+    uint64_t evictions;
+    uint64_t evicted_bytes;
+    uint64_t bytes_in_use; /* this process's estimate; exact after an eviction pass */
+} Atf2AelCacheStats;
+
+typedef struct Atf2AelCache Atf2AelCache;
+
+/*
+ * Creates dir if needed, sizes the existing contents and hashes the running executable.
+ * max_bytes 0: no bound. NULL on failure, including when the executable cannot be read.
+ */
+Atf2AelCache *atf2ael_cache_open(const char *dir, uint64_t max_bytes, char *err, size_t err_cap);
+void atf2ael_cache_close(Atf2AelCache *cache);
+
+/* Hashes the ATF file at atf_path together with the cache's binary hash and the output-affecting options. */
+bool atf2ael_cache_key_file(const Atf2AelCache *cache, const char *atf_path, bool strict_pos, bool allow_scope_blocks,
+                            Atf2AelCacheKey *key, char *err, size_t err_cap);
+
+/*
+ * Copies the cached AEL to out_ael and, if out_ir is not NULL, the cached IR text to out_ir.
+ * Counts a hit only if every requested part was present and copied; otherwise counts a miss
+ * (out_ael may then be partially written and must be regenerated by the caller).
+ */
+bool atf2ael_cache_lookup(Atf2AelCache *cache, const Atf2AelCacheKey *key, const char *out_ael, const char *out_ir);
+
+/* Publishes one part of an entry. Failures are counted, never fatal for the conversion. */
+bool atf2ael_cache_store_file(Atf2AelCache *cache, const Atf2AelCacheKey *key, Atf2AelCacheKind kind,
+                              const char *src_path);
+bool atf2ael_cache_store_bytes(Atf2AelCache *cache, const Atf2AelCacheKey *key, Atf2AelCacheKind kind,
+                               const void *data, size_t n);
+
+void atf2ael_cache_get_stats(Atf2AelCache *cache, Atf2AelCacheStats *out);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ir_text_parser.h"
+
+/*
+ * Embeddable ATF -> IR -> AEL conversion (libatf2ael).
+ *
+ * Inputs are caller buffers and output goes to a sink callback, so a host can convert without
+ * touching the file system (except for the ATF stage, see atf2ael_convert_buffer). All state
+ * lives in an Atf2AelContext; a context is used by one thread at a time, and separate contexts
+ * can convert concurrently.
+ *
+ * The conversion calls return false on failure with a message in err (err may be NULL).
+ */
+
+typedef struct Atf2AelOptions {
+    bool strict_pos;              /* emit at exact IR positions (atf2ael -StrictPos) */
+    bool allow_scope_blocks;      /* atf2ael -AllowScopeBlocks */
+    int jobs;                     /* IR->AEL threads per program, as Ir2AelConvertOptions.jobs */
+} Atf2AelOptions;
+
+/* Receives output text in chunks; returning false aborts the conversion. */
+typedef bool (*Atf2AelSinkFn)(void *ctx, const char *data, size_t len);
+
+typedef struct Atf2AelContext Atf2AelContext;
+
+/* NULL opts: the atf2ael defaults (non-strict, one job). NULL on OOM. */
+Atf2AelContext *atf2ael_context_create(const Atf2AelOptions *opts);
+void atf2ael_context_destroy(Atf2AelContext *ctx);
+
+/* Growable output buffer; pass atf2ael_buffer_sink with the buffer as sink_ctx. */
+typedef struct Atf2AelBuffer {
+    char *data;
+    size_t len;
+    size_t cap;
+} Atf2AelBuffer;
+
+void atf2ael_buffer_init(Atf2AelBuffer *buf);
+bool atf2ael_buffer_sink(void *buf, const char *data, size_t len);
+void atf2ael_buffer_free(Atf2AelBuffer *buf);
+
+/* ATF image -> AEL text. */
+bool atf2ael_convert_buffer(Atf2AelContext *ctx, const void *atf, size_t n, Atf2AelSinkFn sink, void *sink_ctx,
+                            char *err, size_t err_cap);
+
+/* IR (text or binary, detected by magic) -> AEL text. */
+bool ir2ael_convert_buffer(Atf2AelContext *ctx, const void *ir, size_t n, Atf2AelSinkFn sink, void *sink_ctx,
+                           char *err, size_t err_cap);
+
+/* Loaded IR program -> AEL text. */
+bool ir2ael_convert_program_to_sink(Atf2AelContext *ctx, const IRProgram *program, Atf2AelSinkFn sink,
+                                    void *sink_ctx, char *err, size_t err_cap);
+
+/* AEL source -> IR text in the ael2ir log format. Syntax errors (first one, with its line:col) and OOM
+   come back in err; nothing is written to the sink then. */
+bool ael_compile_buffer(Atf2AelContext *ctx, const char *ael, size_t n, Atf2AelSinkFn sink, void *sink_ctx,
+                        char *err, size_t err_cap);
@@ -6,5 +6,41 @@
 #include "ael_emit.h"
 #include "ir_text_parser.h"
 
+typedef struct Ir2AelConvertOptions {
+    /* Worker threads for top-level functions: 1 converts sequentially, 0 uses one per CPU.
+       Only strict-pos output is parallelized; the result is identical to a sequential run. */
+    int jobs;
+} Ir2AelConvertOptions;
+
 bool ir2ael_convert_program(const IRProgram *program, AelEmitter *out, char *err, size_t err_cap);
+bool ir2ael_convert_program_ex(const IRProgram *program, AelEmitter *out, const Ir2AelConvertOptions *opts,
+                               char *err, size_t err_cap);
+
+/*
+ * Streaming conversion of IR text (ir2ael_convert_stream.c). Reading, parsing and emission are
+ * interleaved over a sliding window of instructions instead of loading the whole program; the output
+ * is identical to ir2ael_convert_program on the same text.
+ *
+ * Conversion runs up to the last top-level BEGIN_FUNCT that has IR2AEL_LOOKAHEAD_MAX parsed instructions
+ * after it. When it gets there with nothing open, everything but the last IR2AEL_LOOKBEHIND_MAX
+ * instructions before it is released. Memory is therefore bounded by about `window` instructions plus
+ * the largest top-level function, whatever the input size. Binary IR (*.irb) is rejected.
+ */
+#define IR2AEL_STREAM_DEFAULT_WINDOW 65536
+
+/* Fills buf with up to cap bytes; returns the count, 0 at end of input, (size_t)-1 on a read error. */
+typedef size_t (*Ir2AelReadFn)(void *ctx, char *buf, size_t cap);
+
+typedef struct Ir2AelStreamOptions {
+    size_t window; /* instructions parsed per refill; 0: IR2AEL_STREAM_DEFAULT_WINDOW */
+} Ir2AelStreamOptions;
+
+typedef struct Ir2AelStreamStats {
+    size_t instructions; /* parsed in total */
+    size_t peak_window;  /* most instructions held at once */
+    size_t cuts;         /* times the converted prefix was released */
+    size_t refills;
+} Ir2AelStreamStats;
 
+bool ir2ael_convert_stream(Ir2AelReadFn read, void *read_ctx, AelEmitter *out, const Ir2AelStreamOptions *opts,
+                           Ir2AelStreamStats *stats, char *err, size_t err_cap);
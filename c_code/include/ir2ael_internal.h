@@ -5,6 +5,7 @@
 
 #include "ael_emit.h"
 #include "ir_text_parser.h"
+#include "ir_label_index.h"
 #include "ir_opcodes.h"
 
 /* Extra IR opcodes used by control-flow templates (not all are in ir_opcodes.h yet). */
@@ -17,8 +18,20 @@
 #define OP_SET_LOOP_DEFAULT 53
 #define OP_LOAD_TRUE 7
 
+#if defined(_MSC_VER)
+#define IR2AEL_THREAD_LOCAL __declspec(thread)
+#else
+#define IR2AEL_THREAD_LOCAL _Thread_local
+#endif
+
+/*
+ * Names point at the program's interned IR strings and ids[] holds their str_id, so within one program
+ * a name matches an IR operand iff the ids are equal (decl_group_name_is; strcmp when an id is absent).
+ * A full group is emitted and restarted (ir2ael_handle_decl_ops), so the bound only splits long decls.
+ */
 typedef struct DeclGroup {
-    char names[64][256];
+    const char *names[64];
+    uint32_t ids[64];   /* STR_INTERN_NONE if unknown */
     int count;
     bool is_local;
     bool in_function;
@@ -26,14 +39,23 @@ typedef struct DeclGroup {
 } DeclGroup;
 
 typedef struct LocalInitEntry {
-    char name[256];
+    const char *name;   /* interned IR string */
+    uint32_t id;        /* its str_id; STR_INTERN_NONE if unknown */
     bool assigned;
     bool ambiguous;
 } LocalInitEntry;
 
+/*
+ * Locals of the current function, in declaration order, indexed by str_id like DeclGroup names.
+ * Entries without an id are found by strcmp, as are lookups without one.
+ */
 typedef struct LocalInitTracker {
-    LocalInitEntry entries[256];
+    LocalInitEntry *entries;
     int count;
+    int cap;
+    int *by_id;         /* entry index or -1, by str_id */
+    uint32_t id_cap;
+    int no_id_count;    /* entries with id == STR_INTERN_NONE */
 } LocalInitTracker;
 
 typedef enum ExprKind {
@@ -66,7 +88,8 @@ typedef struct Expr {
     int int_value;
     int bool_value;
     double num_value;
-    char *text;      /* var name or string literal (raw) */
+    const char *text; /* var name or string literal (raw); may point into the program's interner */
+    uint32_t text_id; /* str_id of a var name loaded from the IR, else STR_INTERN_NONE */
 
     /* list */
     struct Expr **items;
@@ -89,13 +112,58 @@ typedef struct Expr {
     /* inc/dec */
     bool incdec_is_prefix;
     bool incdec_is_inc;
+
+    /* Allocated from an ExprArena: expr_free() is a no-op, memory goes with the arena. */
+    bool arena_owned;
 } Expr;
 
+/*
+ * Bump allocator for Expr nodes, their child arrays and their text. While an arena is bound
+ * (expr_arena_bind), expr_new/expr_array_new/expr_strdup allocate from it and the matching
+ * frees are no-ops; expr_arena_reset() reclaims everything at once. expr_text_ref borrows the
+ * interned IR string instead of copying it while an arena is bound.
+ */
+typedef struct ExprArenaChunk ExprArenaChunk;
+
+typedef struct ExprArena {
+    ExprArenaChunk *head;
+    ExprArenaChunk *cur;
+} ExprArena;
+
 enum {
     EXPR_FLAG_LVALUE_DUP = 1u << 0,
     EXPR_FLAG_ADDR_OF = 1u << 1
 };
 
+/*
+ * Region tree recovered once per program (ir2ael_regions.c): functions, loops and if-headers, each with the
+ * branch the flow helpers would otherwise re-match from the instruction stream. While it is bound
+ * (ir2ael_regions_bind), ir_if_header_at, begin_loop_has_for_scaffold and ir_else_if_chain_at answer from it;
+ * the flow handlers themselves still walk the instructions.
+ */
+typedef enum Ir2AelRegionKind {
+    IR2AEL_REGION_FUNCTION = 0,
+    IR2AEL_REGION_LOOP = 1,
+    IR2AEL_REGION_IF = 2
+} Ir2AelRegionKind;
+
+typedef struct Ir2AelRegion {
+    Ir2AelRegionKind kind;
+    size_t begin;       /* BEGIN_FUNCT / BEGIN_LOOP / OP=59 */
+    size_t end;         /* one past DEFINE_FUNCT / END_LOOP / the false label's SET_LABEL */
+    long parent;        /* enclosing region, -1 at top level */
+    size_t branch_i;    /* IF: header BRANCH_TRUE; LOOP: first for-scaffold BRANCH_TRUE (SIZE_MAX if none) */
+    int label;          /* label targeted by branch_i */
+    bool alt_label;     /* LOOP: another for-scaffold branch targets a different label */
+} Ir2AelRegion;
+
+typedef struct Ir2AelRegions {
+    const IRProgram *program;
+    bool valid;
+    Ir2AelRegion *regions;  /* sorted by begin */
+    size_t region_count;
+} Ir2AelRegions;
+
 typedef struct DeclInitChain {
     bool active;
     int line0;
@@ -134,6 +202,13 @@ typedef struct ForHeaderCtx {
     int stage; /* 1=need cond, 2=need update, 3=need close ')' */
 } ForHeaderCtx;
 
+/* Open brace depths of the current function: positive = scope-only block, negative = control-flow brace. */
+typedef struct AnonDepthStack {
+    int *depths;
+    int sp;
+    int cap;
+} AnonDepthStack;
+
 typedef struct SwitchCtx {
     bool active;
     int line0; /* 'switch' line */
@@ -170,9 +245,10 @@ typedef struct Ir2AelState {
 
     bool pending_defun;
     int pending_defun_line0;
-    char pending_defun_name[512];
-    char pending_defun_params[32][256];
+    const char *pending_defun_name;      /* interned IR strings */
+    const char **pending_defun_params;
     int pending_defun_param_count;
+    int pending_defun_param_cap;
     bool in_function;
     bool function_brace_open;
     bool global_local_block_open;
@@ -181,36 +257,81 @@ typedef struct Ir2AelState {
     size_t stack_len;
     size_t stack_cap;
 
-    IfCtx if_stack[64];
+    /* Expr storage; reset whenever the expression stack drains (i.e. per statement). */
+    ExprArena expr_arena;
+    ExprArena *prev_expr_arena;
+
+    /* Region tree of `program`; helpers fall back to scanning if it could not be built. */
+    Ir2AelRegions regions;
+    const Ir2AelRegions *prev_regions;
+
+    /* The stacks below grow on demand and keep their storage until ir2ael_state_free(). */
+    IfCtx *if_stack;
     int if_sp;
+    int if_cap;
     bool pending_inline_else_if;
     int pending_inline_else_line0;
     int pending_inline_else_col0;
 
-    LoopCtx loop_stack[64];
+    LoopCtx *loop_stack;
     int loop_sp;
+    int loop_cap;
 
-    ForHeaderCtx for_hdr_stack[32];
+    ForHeaderCtx *for_hdr_stack;
     int for_hdr_sp;
+    int for_hdr_cap;
 
     SwitchCtx sw;
 
     int cur_depth;
-    int anon_depth_stack[64];
-    int anon_depth_sp;
+    AnonDepthStack anon;
 } Ir2AelState;
 
+/*
+ * Lookahead bounds: how far past its starting instruction each forward scan may read. Every scan in
+ * the converter is capped by one of these or stops at the next BEGIN_FUNCT/DEFINE_FUNCT, and no pattern
+ * looks further back than IR2AEL_LOOKBEHIND_MAX. The streaming converter (ir2ael_convert_stream.c)
+ * relies on this to drop everything else; raise IR2AEL_LOOKAHEAD_MAX along with any bound added here.
+ */
+#define IR2AEL_SCAN_FOR_LPAREN 4096  /* find_for_header_lparen_col0 from the for-increment branch */
+#define IR2AEL_SCAN_STMT_BODY 512    /* then/else bodies, loop statements, next BEGIN_FUNCT after a function */
+#define IR2AEL_SCAN_ELSE_IF 256      /* else-if headers, loop/switch headers, num_local_should_open_scope_block */
+#define IR2AEL_SCAN_DECL_INIT 128    /* scan_for_assignment_to_var from a pending declaration */
+#define IR2AEL_SCAN_INLINE_STMT 96   /* "if (c) stmt;" on one line, for_header_has_comma_op */
+#define IR2AEL_SCAN_FOR_COND 80      /* find_for_header_cond_col0 */
+#define IR2AEL_SCAN_FOR_SCAFFOLD 64  /* ir_next_for_scaffold_branch, for-body brace check */
+#define IR2AEL_SCAN_ASSIGN_STORE 48  /* scan_for_assignment_to_var: store after the matched load */
+#define IR2AEL_SCAN_ELSE_HEAD 16     /* else_body_has_brace_block, else-label guard */
+#define IR2AEL_SCAN_SWITCH_TAIL 13   /* switch_is_epilogue_branch */
+/* Largest bound plus the fixed offsets scans start at (i + 4, a 512-scan hit + 16, ...). */
+#define IR2AEL_LOOKAHEAD_MAX (IR2AEL_SCAN_FOR_LPAREN + 64)
+#define IR2AEL_LOOKBEHIND_MAX 16
+
 /* Helper function prototypes */
+/* Forgets all locals but keeps the storage; local_init_free releases it. */
 void local_init_clear(LocalInitTracker *t);
-int local_init_find(const LocalInitTracker *t, const char *name);
-void local_init_mark_decl(LocalInitTracker *t, const char *name);
-void local_init_mark_assigned(LocalInitTracker *t, const char *name);
+void local_init_free(LocalInitTracker *t);
+bool local_init_copy(LocalInitTracker *dst, const LocalInitTracker *src);
+int local_init_find(const LocalInitTracker *t, const char *name, uint32_t id);
+void local_init_mark_decl(LocalInitTracker *t, const char *name, uint32_t id);
+void local_init_mark_assigned(LocalInitTracker *t, const char *name, uint32_t id);
 void local_init_track_decl_group(LocalInitTracker *t, const DeclGroup *g);
 void decl_group_clear(DeclGroup *g);
 bool decl_group_emit(AelEmitter *out, const DeclGroup *g, int line0, int col0);
+bool decl_group_name_is(const DeclGroup *g, int k, const IRInst *inst);
 bool decl_group_emit_and_track(AelEmitter *out, const DeclGroup *g, int line0, int col0, LocalInitTracker *t);
 size_t ir_skip_locals_bookkeeping(const IRProgram *program, size_t idx);
 size_t ir_skip_locals_bookkeeping_back(const IRProgram *program, size_t idx);
+void expr_arena_init(ExprArena *a);
+void expr_arena_reset(ExprArena *a);
+void expr_arena_free(ExprArena *a);
+ExprArena *expr_arena_bind(ExprArena *a);
+bool expr_arena_active(void);
+void *expr_alloc_zeroed(size_t n);
+Expr **expr_array_new(size_t n);
+void expr_array_free(Expr **arr);
+char *expr_strdup(const char *s);
+const char *expr_text_ref(const char *s);
 void expr_free(Expr *e);
 Expr *expr_new(ExprKind kind);
 Expr *expr_clone(const Expr *e);
@@ -225,6 +346,9 @@ bool binop_lhs_force_paren(int op_code, const Expr *lhs);
 bool emit_escaped_string(AelEmitter *out, const char *raw);
 const char *unit_suffix_from_multiplier(double v);
 void normalize_sci_literal(char *s);
+/* Shortest digits that read back as v: |v| == digits * 10^exp10. Returns the digit count (1..17), or 0 if
+   v is not finite. `digits` needs room for 18 bytes. */
+int shortest_decimal_digits(double v, char *digits, int *exp10);
 void format_real_token(double v, char *out, size_t out_cap);
 void format_imag_token(double v, char *out, size_t out_cap);
 int decl_indent_col0_from_depth(int depth);
@@ -232,14 +356,14 @@ bool for_header_has_comma_op(const IRProgram *program, size_t i, int line0);
 bool has_next_decl_init_on_same_line(const IRProgram *program, size_t cur_i, int line0);
 bool else_body_has_brace_block(const IRProgram *program, size_t start, int end_label, int if_depth);
 bool stmt_emit_at_or_current(AelEmitter *out, int *line0, int *col0, int depth);
-int anon_block_current_depth(const int *stack, int sp);
-bool anon_block_open_to(AelEmitter *out, int *sp, int *stack, int target_depth, int brace_line0);
-bool anon_block_close_to(AelEmitter *out, int *sp, int *stack, int target_depth, int anchor_line0);
-bool anon_depth_push_marked(int *sp, int *stack, int depth, bool is_controlflow);
-void anon_depth_pop_expected(int *sp, const int *stack, int expected_depth, bool is_controlflow);
-bool anon_scope_close_to(AelEmitter *out, int *sp, int *stack, int target_depth, int anchor_line0);
-bool anon_close_scopes_before_stmt(AelEmitter *out, int *sp, int *stack, int target_depth, int stmt_line0);
-bool anon_close_scope_blocks_at_function_end(AelEmitter *out, int *sp, int *stack, int target_depth, int anchor_line0);
+int anon_block_current_depth(const AnonDepthStack *anon);
+bool anon_block_open_to(AelEmitter *out, AnonDepthStack *anon, int target_depth, int brace_line0);
+bool anon_block_close_to(AelEmitter *out, AnonDepthStack *anon, int target_depth, int anchor_line0);
+bool anon_depth_push_marked(AnonDepthStack *anon, int depth, bool is_controlflow);
+void anon_depth_pop_expected(AnonDepthStack *anon, int expected_depth, bool is_controlflow);
+bool anon_scope_close_to(AelEmitter *out, AnonDepthStack *anon, int target_depth, int anchor_line0);
+bool anon_close_scopes_before_stmt(AelEmitter *out, AnonDepthStack *anon, int target_depth, int stmt_line0);
+bool anon_close_scope_blocks_at_function_end(AelEmitter *out, AnonDepthStack *anon, int target_depth, int anchor_line0);
 int expr_start_col0(const Expr *e, int line0);
 int expr_min_line0(const Expr *e);
 void expr_min_col0_on_line_rec(const Expr *e, int line0, int *best_col0);
@@ -258,17 +382,16 @@ Expr *stack_pop(Expr **stk, size_t *len);
 void stack_clear(Expr **stk, size_t *len);
 Expr *stack_pop_stmt_expr(Expr **stk, size_t *len);
 bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr **out_expr, char *err, size_t err_cap);
-bool if_close_braced_else_on_depth_exit(AelEmitter *out, IfCtx *if_stack, int *if_sp, int cur_depth, int *anon_sp, int *anon_stack);
-bool ensure_switch_opened(AelEmitter *out, SwitchCtx *sw, int first_case_line0, int *anon_sp, int *anon_stack);
+bool if_close_braced_else_on_depth_exit(AelEmitter *out, IfCtx *if_stack, int *if_sp, int cur_depth, AnonDepthStack *anon);
+bool ensure_switch_opened(AelEmitter *out, SwitchCtx *sw, int first_case_line0, AnonDepthStack *anon);
 bool looks_like_inline_break_after_stmt_end(const IRProgram *program, size_t stmt_end_i, int line0);
 bool op0_is_short_circuit_marker(const IRProgram *program, size_t idx, size_t end);
+size_t ir_next_for_scaffold_branch(const IRProgram *program, size_t begin_i, size_t from);
 bool begin_loop_has_for_scaffold(const IRProgram *program, size_t begin_i, int start_label);
-bool switch_emit_pending_case_before_stmt(AelEmitter *out, SwitchCtx *sw, int stmt_line0, int stmt_col0, int *anon_sp, int *anon_stack);
-bool switch_emit_pending_case_label_only(AelEmitter *out, SwitchCtx *sw, int *anon_sp, int *anon_stack);
+bool switch_emit_pending_case_before_stmt(AelEmitter *out, SwitchCtx *sw, int stmt_line0, int stmt_col0, AnonDepthStack *anon);
+bool switch_emit_pending_case_label_only(AelEmitter *out, SwitchCtx *sw, AnonDepthStack *anon);
 bool switch_is_epilogue_branch(const IRProgram *program, size_t branch_i, const SwitchCtx *sw);
-bool scan_for_if_header_line(const IRProgram *program, size_t start, size_t max_scan, int line0);
-bool scan_for_if_header_any(const IRProgram *program, size_t start, size_t max_scan, int *out_line0);
-bool scan_for_if_header_until_label(const IRProgram *program, size_t start, size_t max_scan, int stop_label, int expected_depth, int *out_line0);
+size_t ir_if_header_scan(const IRProgram *program, size_t i, size_t end);
 bool ir_if_header_at(const IRProgram *program, size_t i, size_t end, int expected_depth, int *out_line0);
 bool ir_else_if_chain_at(const IRProgram *program, size_t i, size_t end, int expected_depth, int outer_end_label, int *out_line0);
 bool num_local_should_open_scope_block(const IRProgram *program, size_t i, int target_depth);
@@ -276,17 +399,80 @@ bool scan_for_assignment_to_var(const IRProgram *program, size_t start, size_t m
 bool find_for_header_cond_col0(const IRProgram *program, size_t start, size_t max_scan, int line0, int *out_col0);
 bool find_for_header_lparen_col0(const IRProgram *program, size_t start, size_t max_scan, int line0, int incr_label, int loop_end_label, int *out_col0);
 
+bool ir2ael_regions_build(Ir2AelRegions *tree, const IRProgram *program);
+void ir2ael_regions_free(Ir2AelRegions *tree);
+const Ir2AelRegions *ir2ael_regions_bind(const Ir2AelRegions *tree);
+const Ir2AelRegions *ir2ael_regions_for(const IRProgram *program);
+const Ir2AelRegion *ir2ael_regions_at(const Ir2AelRegions *tree, size_t begin, Ir2AelRegionKind kind);
+
 void ir2ael_state_init(Ir2AelState *s, const IRProgram *program, AelEmitter *out, char *err, size_t err_cap);
+/* Like ir2ael_state_init, but binds a region tree owned by someone else (used by the per-function workers). */
+void ir2ael_state_init_borrowed(Ir2AelState *s, const IRProgram *program, AelEmitter *out, char *err, size_t err_cap,
+                                const Ir2AelRegions *tree);
 void ir2ael_state_free(Ir2AelState *s);
+/* Releases only what ir2ael_state_adopt() copies in (the growable stacks and the local tracker). */
+void ir2ael_state_free_stacks(Ir2AelState *s);
+/* True when nothing is open or pending, i.e. the state carries nothing into the next top-level item. */
+bool ir2ael_state_is_quiescent(const Ir2AelState *s);
+/* Replaces the conversion fields with `from` (NULL: initial values); program/out/err, the expression
+   stack, the arena and the region tree binding are kept. Returns false on OOM. */
+bool ir2ael_state_adopt(Ir2AelState *s, const Ir2AelState *from);
+/* Make room for one more entry at the top of the if/loop/for-header stack and clear it; false on OOM. */
+bool ir2ael_if_stack_reserve(Ir2AelState *s);
+bool ir2ael_loop_stack_reserve(Ir2AelState *s);
+bool ir2ael_for_hdr_stack_reserve(Ir2AelState *s);
+bool ir2ael_defun_param_push(Ir2AelState *s, const char *name);
 Ir2AelStatus ir2ael_preprocess_inst(Ir2AelState *s, size_t i, const IRInst *inst);
 Ir2AelStatus ir2ael_handle_function_ops(Ir2AelState *s, size_t i, const IRInst *inst);
 Ir2AelStatus ir2ael_handle_decl_ops(Ir2AelState *s, const IRInst *inst);
 Ir2AelStatus ir2ael_handle_scope_ops(Ir2AelState *s, size_t *i, const IRInst *inst);
 Ir2AelStatus ir2ael_handle_load_ops(Ir2AelState *s, const IRInst *inst);
-Ir2AelStatus ir2ael_handle_flow_ops(Ir2AelState *s, size_t *i, const IRInst *inst);
 Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *i, const IRInst *inst);
 Ir2AelStatus ir2ael_finalize(Ir2AelState *s);
 
+/* Opcode-indexed dispatch: IR opcodes are 0..63; anything outside that range has no handlers. */
+#define IR2AEL_OP_SLOTS 64
+typedef Ir2AelStatus (*Ir2AelOpHandler)(Ir2AelState *s, size_t *i, const IRInst *inst);
+Ir2AelStatus ir2ael_dispatch_inst(Ir2AelState *s, size_t *i, const IRInst *inst);
+/* One main-loop step for insts[*i]: preprocess, dispatch, pending-decl flush. HANDLED or a failure status. */
+Ir2AelStatus ir2ael_convert_inst(Ir2AelState *s, size_t *i);
+/* Writes the message for a failing main-loop status (OOM, FAIL_EMIT at insts[i]); FAIL keeps the handler's. */
+void ir2ael_report_failure(Ir2AelStatus rc, const AelEmitter *out, const IRInst *inst, size_t i, char *err,
+                           size_t err_cap);
+
+/*
+ * Per-function parallel conversion (ir2ael_convert_parallel.c). Top-level BEGIN_FUNCT..DEFINE_FUNCT
+ * ranges are converted up front on worker threads, each from a fresh state into a private buffer that
+ * starts at the defun line; the main loop then splices a function's buffer in place of converting it.
+ */
+typedef struct Ir2AelFunctionJob {
+    size_t begin;               /* BEGIN_FUNCT */
+    size_t end;                 /* one past DEFINE_FUNCT */
+    int line0;                  /* defun line the buffer starts at */
+    bool ok;
+    char *text;
+    size_t text_len;
+    int end_line0;
+    int end_col0;
+    int last_req_line0;
+    int last_req_col0;
+    int last_fail_reason;
+    Ir2AelState *final_state;
+} Ir2AelFunctionJob;
+
+typedef struct Ir2AelParallel {
+    Ir2AelFunctionJob *jobs;    /* sorted by begin */
+    size_t count;
+} Ir2AelParallel;
+
+/* Converts the top-level functions of s->program on up to `threads` threads (0: one per CPU). Returns
+   false if nothing was prepared (too few functions, non-strict output, OOM); the caller converts sequentially. */
+bool ir2ael_parallel_prepare(Ir2AelParallel *par, const Ir2AelState *s, int threads);
+void ir2ael_parallel_free(Ir2AelParallel *par);
+/* At a quiescent BEGIN_FUNCT: emits the prepared function and advances *i to its DEFINE_FUNCT.
+   NOT_HANDLED if there is no usable buffer for it (convert it normally). */
+Ir2AelStatus ir2ael_parallel_splice(Ir2AelState *s, const Ir2AelParallel *par, size_t *i);
+
 Ir2AelStatus ir2ael_flow_handle_switch_ops(Ir2AelState *s, size_t *i, const IRInst *inst);
 Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *i, const IRInst *inst);
 Ir2AelStatus ir2ael_flow_handle_end_loop(Ir2AelState *s, size_t *i, const IRInst *inst);
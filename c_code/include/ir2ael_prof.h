@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * ir2ael hot-path counters.
+ *
+ * Default: disabled (every hook expands to nothing).
+ * Enable by compiling with: /DIR2AEL_PROFILE=1
+ *
+ * When enabled, ir2ael_dispatch_inst records per handler the calls, the hits (HANDLED) and the
+ * cycles spent (inclusive), and the lookahead helpers and ir_next_* lookups record how many IR
+ * instructions each call covered (for indexed lookups, the span the index answered for, not work).
+ * Counters are process-wide (worker threads included) and printed to stderr at exit.
+ */
+
+#if defined(IR2AEL_PROFILE) && (IR2AEL_PROFILE + 0)
+#define IR2AEL_PROF_ENABLED 1
+#else
+#define IR2AEL_PROF_ENABLED 0
+#endif
+
+typedef enum Ir2AelProfHandler {
+    IR2AEL_PROF_H_FUNCTION_OPS,
+    IR2AEL_PROF_H_DECL_OPS,
+    IR2AEL_PROF_H_SCOPE_OPS,
+    IR2AEL_PROF_H_LOAD_OPS,
+    IR2AEL_PROF_H_EXPR_OPS,
+    IR2AEL_PROF_H_SWITCH_OPS,
+    IR2AEL_PROF_H_BEGIN_LOOP,
+    IR2AEL_PROF_H_END_LOOP,
+    IR2AEL_PROF_H_LOOP_CTRL,
+    IR2AEL_PROF_H_ADD_LABEL,
+    IR2AEL_PROF_H_SET_LABEL,
+    IR2AEL_PROF_H_BRANCH_TRUE,
+    IR2AEL_PROF_H_LOAD_TRUE,
+    IR2AEL_PROF_H_COUNT
+} Ir2AelProfHandler;
+
+typedef enum Ir2AelProfScan {
+    IR2AEL_PROF_S_IF_HEADER_SCAN,
+    IR2AEL_PROF_S_ELSE_IF_CHAIN,
+    IR2AEL_PROF_S_LABEL_INDEX,          /* ir_next_* answered from the label index */
+    IR2AEL_PROF_S_LABEL_LINEAR,         /* ir_next_* walking the instructions (no index) */
+    IR2AEL_PROF_S_PARSE_EXPR_RANGE,
+    IR2AEL_PROF_S_NUM_LOCAL_SCOPE_BLOCK,
+    IR2AEL_PROF_S_COUNT
+} Ir2AelProfScan;
+
+#if IR2AEL_PROF_ENABLED
+uint64_t ir2ael_prof_now(void);
+void ir2ael_prof_handler(Ir2AelProfHandler h, int status, uint64_t cycles);
+void ir2ael_prof_scan(Ir2AelProfScan helper, size_t scanned);
+
+#define IR2AEL_PROF_SCAN(helper, scanned) ir2ael_prof_scan((helper), (size_t)(scanned))
+#else
+#define IR2AEL_PROF_SCAN(helper, scanned) ((void)0)
+#endif
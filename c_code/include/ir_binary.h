@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_text_parser.h"
+
+/*
+ * Binary IR container (*.irb): a cache-friendly alternative to *.ir.txt.
+ *
+ * Layout (host byte order, little-endian on all supported targets):
+ *   IrbHeader
+ *   IrbRecord[inst_count]        fixed-width, 8-byte aligned
+ *   char strtab[strtab_size]     NUL-terminated payloads referenced by IrbRecord.str_off
+ *
+ * Reals/imaginaries are stored as exact IEEE doubles, so no comment scanning or strtod
+ * is needed on load.
+ */
+
+#define IRB_MAGIC "AELIRB\0\1"
+#define IRB_VERSION 1u
+#define IRB_NO_STR 0xFFFFFFFFu
+
+typedef struct IrbHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t inst_count;
+    uint32_t strtab_size;
+} IrbHeader;
+
+typedef struct IrbRecord {
+    int32_t index;
+    int32_t op;
+    int32_t depth;
+    int32_t arg1;
+    int32_t arg2;
+    int32_t arg3;
+    int32_t a4;
+    uint32_t flags; /* IRB_F_* */
+    uint32_t str_off; /* IRB_NO_STR if absent */
+    uint32_t str_len;
+    double num_val;
+} IrbRecord;
+
+enum {
+    IRB_F_DEPTH = 1u << 0,
+    IRB_F_ARG1 = 1u << 1,
+    IRB_F_ARG2 = 1u << 2,
+    IRB_F_ARG3 = 1u << 3,
+    IRB_F_A4 = 1u << 4,
+    IRB_F_NUM_VAL = 1u << 5
+};
+
+/* True if the buffer starts with the binary IR magic. */
+bool ir_binary_detect(const void *data, size_t len);
+
+/* Loads a binary IR image (e.g. a mapped *.irb). Strings are interned into program->strings. */
+bool ir_binary_load_buffer(const void *data, size_t len, IRProgram *out_program, char *err, size_t err_cap);
+
+bool ir_binary_write_file(const IRProgram *program, const char *path, char *err, size_t err_cap);
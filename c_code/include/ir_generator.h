@@ -8,15 +8,17 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "ael_compiler_internal.h"
 
-/* Global state */
-extern int AcompDepth;
-extern int AcompInteract;
-extern int AerrFlag;
+/* Generator state of the compiler bound to this thread (see ael_compiler.h) */
+#define AcompDepth (ael_compiler_current()->ir.depth)
+#define AcompInteract (ael_compiler_current()->ir.interact)
+#define AerrFlag (ael_compiler_current()->ir.err_flag)
 
 /* IR output functions */
 void ir_init(void);
 void ir_output_to_file(const char *filename);
+bool ir_output_to_sink(AelIrWriteFn sink, void *sink_ctx);
 void ir_free_all(void);
 int ir_get_count(void);
 
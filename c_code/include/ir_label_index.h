@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ir_text_parser.h"
+
+/*
+ * Position index over a loaded IRProgram (built once by the IR loaders).
+ *
+ * The IR->AEL template matchers look for "the SET_LABEL of label N", "the BRANCH_TRUE sites of label N"
+ * or "the next OP=60/OP=65 marker". The index answers these with a binary search instead of a forward
+ * scan over the instruction stream.
+ *
+ * Every lookup takes a half-open window [from, end) and returns `end` when nothing matches. Programs
+ * without an index (hand-built, or index allocation failed) fall back to a linear scan with the same result.
+ */
+typedef struct IRIndexEntry {
+    int key;
+    size_t pos;
+} IRIndexEntry;
+
+typedef struct IRLabelIndex {
+    IRIndexEntry *set_label;    /* SET_LABEL, key = label id (arg1) */
+    size_t set_label_count;
+    IRIndexEntry *branch_true;  /* BRANCH_TRUE, key = target label id (arg1) */
+    size_t branch_true_count;
+    IRIndexEntry *marker;       /* OP=48 generic op, key = sub-opcode (arg1) */
+    size_t marker_count;
+    size_t *funct_bound;        /* BEGIN_FUNCT / DEFINE_FUNCT positions, ascending */
+    size_t funct_bound_count;
+} IRLabelIndex;
+
+/* Builds program->label_index. Returns false on OOM (program is left without an index). */
+bool ir_label_index_build(IRProgram *program);
+void ir_label_index_free(IRLabelIndex *index);
+
+size_t ir_next_set_label(const IRProgram *program, int label, size_t from, size_t end);
+size_t ir_next_branch_true(const IRProgram *program, int label, size_t from, size_t end);
+size_t ir_next_marker(const IRProgram *program, int sub_op, size_t from, size_t end);
+size_t ir_next_funct_boundary(const IRProgram *program, size_t from, size_t end);
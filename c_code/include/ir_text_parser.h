@@ -2,6 +2,9 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+#include "str_intern.h"
 
 typedef struct IRInst {
     int index; /* -1 if absent */
@@ -21,25 +24,74 @@ typedef struct IRInst {
     int arg3;
     int a4;
 
-    char *str; /* optional, heap allocated */
+    const char *str; /* optional, interned in IRProgram.strings */
+    uint32_t str_id; /* STR_INTERN_NONE if str is absent */
 
     /* For OP=8/OP=9 values (parsed from inline comment "val="). */
     bool has_num_val;
     double num_val;
 } IRInst;
 
+struct IRLabelIndex;
+
 typedef struct IRProgram {
     IRInst *insts;
     size_t count;
     size_t cap;
+
+    /* Every IRInst.str is interned here: equal names share one pointer and one id. */
+    StrInterner strings;
+
+    /* Label / marker position index built after loading (see ir_label_index.h); may be NULL. */
+    struct IRLabelIndex *label_index;
 } IRProgram;
 
 bool ir_program_init(IRProgram *p);
 void ir_program_free(IRProgram *p);
 
-/* Parses an AEL IR log file (*.ir.txt). Ignores comment and DEPTH lines. */
+/*
+ * Parses an AEL IR log file (*.ir.txt) via a mapped view. Ignores comment and DEPTH lines.
+ * Binary IR images (*.irb, see ir_binary.h) are detected by magic and loaded directly.
+ */
 bool ir_parse_file(const char *path, IRProgram *out_program, char *err, size_t err_cap);
 
+/*
+ * Parses IR text already held in memory (same format as ir_parse_file).
+ * `data` need not be NUL-terminated and is scanned in place; the caller keeps ownership.
+ */
+bool ir_parse_buffer(const char *data, size_t len, IRProgram *out_program, char *err, size_t err_cap);
+
+/*
+ * Incremental form of ir_parse_buffer for IR text arriving in chunks of any size: complete lines
+ * are appended to `program` as they are fed, a trailing partial line is held until its newline (or
+ * ir_text_stream_finish). A DEPTH line applies to program's last instruction, so the caller may
+ * swap in another program between feeds as long as it carries that instruction over.
+ * No label index is built; that is up to the caller.
+ */
+typedef struct IRTextStream {
+    IRProgram *program;
+    int current_depth;
+    char *partial;
+    size_t partial_len;
+    size_t partial_cap;
+} IRTextStream;
+
+void ir_text_stream_init(IRTextStream *ts, IRProgram *program);
+bool ir_text_stream_feed(IRTextStream *ts, const char *data, size_t len, char *err, size_t err_cap);
+bool ir_text_stream_finish(IRTextStream *ts, char *err, size_t err_cap);
+void ir_text_stream_free(IRTextStream *ts);
+
+/* Read-only view of a whole file (memory-mapped; empty files map to len == 0). */
+typedef struct IRFileView {
+    const char *data;
+    size_t len;
+    void *map_handle;
+    void *file_handle;
+} IRFileView;
+
+bool ir_file_view_open(const char *path, IRFileView *view, char *err, size_t err_cap);
+void ir_file_view_close(IRFileView *view);
+
 /*
  * Extracts the "# Source: <path>" header value from an IR log.
  * Returns true if present (path copied into out_path).
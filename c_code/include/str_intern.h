@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * String interner: each distinct string is stored once and gets a 32-bit id (ids start at 1;
+ * STR_INTERN_NONE is never assigned). Interned pointers stay valid until str_intern_free, so
+ * two strings from the same interner are equal exactly when their pointers (or ids) are.
+ *
+ * Not synchronized: intern from one thread, then share the table read-only.
+ */
+#define STR_INTERN_NONE 0u
+
+typedef struct StrInternChunk StrInternChunk;
+
+typedef struct StrInternEntry {
+    const char *str;
+    size_t len;
+    uint32_t hash;
+} StrInternEntry;
+
+typedef struct StrInterner {
+    StrInternChunk *chunks;
+    StrInternEntry *entries; /* by id */
+    uint32_t count;         /* next id */
+    uint32_t cap;
+    uint32_t *slots;        /* id or STR_INTERN_NONE; slot_cap is a power of two */
+    uint32_t slot_cap;
+} StrInterner;
+
+void str_intern_init(StrInterner *in);
+void str_intern_free(StrInterner *in);
+
+/* Returns the id of s[0..len), adding it if needed; STR_INTERN_NONE on OOM. */
+uint32_t str_intern(StrInterner *in, const char *s, size_t len);
+/* Lookup only; STR_INTERN_NONE if s[0..len) was never interned. */
+uint32_t str_intern_find(const StrInterner *in, const char *s, size_t len);
+/* NUL-terminated string for an id returned by this interner (NULL for STR_INTERN_NONE). */
+const char *str_intern_get(const StrInterner *in, uint32_t id);
@@ -0,0 +1,114 @@
+/* ael_compiler.c - per-compilation front-end state and its thread binding */
+#include "ael_compiler_internal.h"
+#include "ir_generator.h"
+#include <stdlib.h>
+#include <string.h>
+
+static AEL_THREAD_LOCAL AelCompiler *g_bound = NULL;
+static AEL_THREAD_LOCAL AelCompiler g_default;
+static AEL_THREAD_LOCAL bool g_default_ready = false;
+
+void ael_compiler_init(AelCompiler *c) {
+    memset(c, 0, sizeof(*c));
+    c->lex.line = 1;
+    c->lex.col = 1;
+    c->lex.token_start_line = 1;
+    c->lex.token_start_col = 1;
+    c->vals.line = 1;
+    c->vals.column = 1;
+    c->parser.lookahead = -1;
+    c->ir.interact = 1;  // Always use IR generation mode
+    str_intern_init(&c->ir.strings);
+}
+
+AelCompiler *ael_compiler_current(void) {
+    if (g_bound) return g_bound;
+    if (!g_default_ready) {
+        ael_compiler_init(&g_default);
+        g_default_ready = true;
+    }
+    return &g_default;
+}
+
+AelCompiler *ael_compiler_bind(AelCompiler *c) {
+    AelCompiler *prev = g_bound;
+    g_bound = c;
+    return prev;
+}
+
+AelCompiler *ael_compiler_create(void) {
+    AelCompiler *c = (AelCompiler *)malloc(sizeof(*c));
+    if (c) ael_compiler_init(c);
+    return c;
+}
+
+void ael_compiler_release(AelCompiler *c) {
+    AelCompiler *prev = ael_compiler_bind(c);
+    ascan_lex_reset();
+    ir_free_all();
+    ael_compiler_bind(prev);
+}
+
+void ael_compiler_destroy(AelCompiler *c) {
+    if (!c) return;
+    ael_compiler_release(c);
+    free(c);
+}
+
+/* Start from a fresh compiler: lookahead and position trackers must not leak from a previous file. */
+static void reset_bound(AelCompiler *c) {
+    ascan_lex_reset();
+    ir_free_all();
+    ael_compiler_init(c);
+}
+
+bool ael_compiler_parse(AelCompiler *c, FILE *fp) {
+    if (!c || !fp) return false;
+    AelCompiler *prev = ael_compiler_bind(c);
+    reset_bound(c);
+    ascan_lex_init(fp);
+    bool ok = parse_ael_program() && !c->ir.oom;
+    ascan_lex_reset();
+    ael_compiler_bind(prev);
+    return ok;
+}
+
+bool ael_compiler_parse_buffer(AelCompiler *c, const char *src, size_t len) {
+    if (!c || (!src && len)) return false;
+    AelCompiler *prev = ael_compiler_bind(c);
+    reset_bound(c);
+    ascan_lex_init_buffer(src, len);
+    bool ok = parse_ael_program() && !c->ir.oom;
+    ascan_lex_reset();
+    ael_compiler_bind(prev);
+    return ok;
+}
+
+const char *ael_compiler_error(const AelCompiler *c) {
+    if (!c) return "";
+    if (c->ir.oom) return "out of memory";
+    return c->parser.first_error;
+}
+
+void ael_compiler_write_ir(AelCompiler *c, const char *path) {
+    if (!c || !path) return;
+    AelCompiler *prev = ael_compiler_bind(c);
+    ir_output_to_file(path);
+    ael_compiler_bind(prev);
+}
+
+bool ael_compiler_write_ir_sink(AelCompiler *c, AelIrWriteFn sink, void *sink_ctx) {
+    if (!c || !sink) return false;
+    AelCompiler *prev = ael_compiler_bind(c);
+    bool ok = ir_output_to_sink(sink, sink_ctx);
+    ael_compiler_bind(prev);
+    return ok;
+}
+
+int ael_compiler_ir_count(AelCompiler *c) {
+    if (!c) return 0;
+    AelCompiler *prev = ael_compiler_bind(c);
+    int n = ir_get_count();
+    ael_compiler_bind(prev);
+    return n;
+}
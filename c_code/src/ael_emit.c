@@ -1,35 +1,68 @@
 #include "ael_emit.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+static bool file_sink(void *ctx, const char *data, size_t len) {
+    return fwrite(data, 1, len, (FILE *)ctx) == len;
+}
+
+static bool emit_flush_buf(AelEmitter *e) {
+    if (e->buf_len == 0) return true;
+    size_t n = e->buf_len;
+    e->buf_len = 0;
+    if (!e->sink(e->sink_ctx, e->buf, n)) {
+        e->last_fail_reason = AEL_EMIT_FAIL_IO;
+        return false;
+    }
+    return true;
+}
+
 static bool emit_raw(AelEmitter *e, const char *s, size_t n) {
-    if (!e || !e->fp) return false;
-    return fwrite(s, 1, n, e->fp) == n;
+    if (!e || !e->sink) return false;
+    if (n <= e->buf_cap - e->buf_len) {
+        memcpy(e->buf + e->buf_len, s, n);
+        e->buf_len += n;
+        return true;
+    }
+    if (!emit_flush_buf(e)) return false;
+    if (n >= e->buf_cap) {
+        /* Larger than the whole buffer: hand it to the sink directly. */
+        if (!e->sink(e->sink_ctx, s, n)) {
+            e->last_fail_reason = AEL_EMIT_FAIL_IO;
+            return false;
+        }
+        return true;
+    }
+    memcpy(e->buf, s, n);
+    e->buf_len = n;
+    return true;
 }
 
 static bool emit_repeat(AelEmitter *e, char ch, int count) {
-    if (!e || !e->fp) return false;
+    if (!e || !e->sink) return false;
     if (count <= 0) return true;
 
-    char buf[4096];
-    memset(buf, ch, sizeof(buf));
-
-    int remaining = count;
+    size_t remaining = (size_t)count;
     while (remaining > 0) {
-        int chunk = remaining;
-        if (chunk > (int)sizeof(buf)) chunk = (int)sizeof(buf);
-        if (!emit_raw(e, buf, (size_t)chunk)) {
-            e->last_fail_reason = AEL_EMIT_FAIL_IO;
-            return false;
-        }
+        if (e->buf_len == e->buf_cap && !emit_flush_buf(e)) return false;
+        size_t chunk = e->buf_cap - e->buf_len;
+        if (chunk > remaining) chunk = remaining;
+        memset(e->buf + e->buf_len, ch, chunk);
+        e->buf_len += chunk;
         remaining -= chunk;
     }
     return true;
 }
 
-bool ael_emit_init(AelEmitter *e, FILE *fp, bool strict_pos) {
-    if (!e || !fp) return false;
-    e->fp = fp;
+bool ael_emit_init_sink(AelEmitter *e, AelEmitSinkFn sink, void *sink_ctx, bool strict_pos) {
+    if (!e || !sink) return false;
+    memset(e, 0, sizeof(*e));
+    e->buf = (char *)malloc(AEL_EMIT_BUF_SIZE);
+    if (!e->buf) return false;
+    e->buf_cap = AEL_EMIT_BUF_SIZE;
+    e->sink = sink;
+    e->sink_ctx = sink_ctx;
     e->line0 = 0;
     e->col0 = 0;
     e->strict_pos = strict_pos;
@@ -40,12 +73,34 @@ bool ael_emit_init(AelEmitter *e, FILE *fp, bool strict_pos) {
     return true;
 }
 
+bool ael_emit_init(AelEmitter *e, FILE *fp, bool strict_pos) {
+    if (!e || !fp) return false;
+    if (!ael_emit_init_sink(e, file_sink, fp, strict_pos)) return false;
+    e->fp = fp;
+    return true;
+}
+
+bool ael_emit_flush(AelEmitter *e) {
+    if (!e || !e->sink) return false;
+    return emit_flush_buf(e);
+}
+
+void ael_emit_free(AelEmitter *e) {
+    if (!e) return;
+    if (e->sink) (void)emit_flush_buf(e);
+    free(e->buf);
+    e->buf = NULL;
+    e->buf_len = 0;
+    e->buf_cap = 0;
+    e->sink = NULL;
+    e->sink_ctx = NULL;
+    e->fp = NULL;
+}
+
 bool ael_emit_char(AelEmitter *e, char ch) {
-    if (!e || !e->fp) return false;
-    if (fputc((unsigned char)ch, e->fp) == EOF) {
-        e->last_fail_reason = AEL_EMIT_FAIL_IO;
-        return false;
-    }
+    if (!e || !e->sink) return false;
+    if (e->buf_len == e->buf_cap && !emit_flush_buf(e)) return false;
+    e->buf[e->buf_len++] = ch;
     if (ch == '\n') {
         e->line0++;
         e->col0 = 0;
@@ -55,16 +110,33 @@ bool ael_emit_char(AelEmitter *e, char ch) {
     return true;
 }
 
-bool ael_emit_text(AelEmitter *e, const char *text) {
-    if (!text) return true;
-    for (const char *p = text; *p; p++) {
-        if (!ael_emit_char(e, *p)) return false;
+bool ael_emit_bytes(AelEmitter *e, const char *data, size_t len) {
+    if (!e || !e->sink) return false;
+    if (len == 0) return true;
+    if (!emit_raw(e, data, len)) return false;
+
+    /* Advance line0/col0 in bulk: count newlines, then measure the tail after the last one. */
+    const char *p = data;
+    const char *end = data + len;
+    const char *last_nl = NULL;
+    const char *nl;
+    while (p < end && (nl = (const char *)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        e->line0++;
+        last_nl = nl;
+        p = nl + 1;
     }
+    if (last_nl) e->col0 = (int)(end - (last_nl + 1));
+    else e->col0 += (int)len;
     return true;
 }
 
+bool ael_emit_text(AelEmitter *e, const char *text) {
+    if (!text) return true;
+    return ael_emit_bytes(e, text, strlen(text));
+}
+
 bool ael_emit_at(AelEmitter *e, int line0, int col0) {
-    if (!e || !e->fp) return false;
+    if (!e || !e->sink) return false;
     if (!e->strict_pos) return true;
     e->last_req_line0 = line0;
     e->last_req_col0 = col0;
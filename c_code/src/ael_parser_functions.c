@@ -9,6 +9,7 @@
 #include "ael_parser_new.h"
 #include "ir_generator.h"
 #include "lexer_state.h"
+#include "ael_compiler_internal.h"
 
 /* External functions */
 extern int next_token(void);
@@ -19,10 +20,6 @@ extern bool parse_statement(ParserContext *ctx);
 extern bool parse_expression_statement(ParserContext *ctx);
 extern bool parse_block_statement(ParserContext *ctx);
 
-/* External globals */
-extern int AcompDepth;
-extern ParserContext g_parser_ctx;
-
 /* ============================================================================
  * Function Definition Parsing
  * ============================================================================ */
@@ -239,13 +236,14 @@ bool parse_global_statement(ParserContext *ctx) {
  * Main entry point: Parse AEL program
  */
 bool parse_ael_program(void) {
-    /* Initialize parser context */
-    memset(&g_parser_ctx, 0, sizeof(g_parser_ctx));
-    g_parser_ctx.in_function = false;
-    g_parser_ctx.function_depth = 0;
-    g_parser_ctx.local_var_count = 0;
-    g_parser_ctx.had_error = false;
-    g_parser_ctx.error_count = 0;
+    /* Initialize parser context (in the compiler bound to this thread) */
+    ParserContext *ctx = &ael_compiler_current()->parser.ctx;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->in_function = false;
+    ctx->function_depth = 0;
+    ctx->local_var_count = 0;
+    ctx->had_error = false;
+    ctx->error_count = 0;
 
     /* Initialize IR generator */
     ir_init();
@@ -253,9 +251,9 @@ bool parse_ael_program(void) {
 
     /* Parse global statements */
     while (peek_token() != TOK_EOF) {
-        if (!parse_global_statement(&g_parser_ctx)) {
+        if (!parse_global_statement(ctx)) {
             /* Error occurred, but continue parsing */
-            if (g_parser_ctx.error_count > 20) {
+            if (ctx->error_count > 20) {
                 fprintf(stderr, "Too many errors, stopping parse\n");
                 break;
             }
@@ -263,5 +261,5 @@ bool parse_ael_program(void) {
     }
 
     /* Return success if no errors */
-    return !g_parser_ctx.had_error;
+    return !ctx->had_error;
 }
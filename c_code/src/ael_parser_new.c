@@ -16,14 +16,11 @@
 #include "ir_generator.h"
 #include "lexer_state.h"
 #include "token_to_subopcode.h"
+#include "ael_compiler_internal.h"
 
 /* External lexer function */
 extern int ascan_lex(int token_hint);
 
-/* Global parser state */
-extern int dword_18007E890;  /* Lookahead token */
-extern int dword_18007E898;  /* Error count */
-
 /* Forward declarations from other parser files */
 bool parse_statement(ParserContext *ctx);
 bool parse_decl_statement(ParserContext *ctx);
@@ -33,7 +30,10 @@ bool parse_block_statement(ParserContext *ctx);
 static bool parse_multiplicative_continue(ParserContext *ctx);
 static bool parse_expression_continue(ParserContext *ctx);
 
-ParserContext g_parser_ctx = {0};
+/* Lookahead, error count and position trackers of the compiler bound to this thread */
+static AelParserState *parser_state(void) {
+    return &ael_compiler_current()->parser;
+}
 
 /* ============================================================================
  * Unit Suffix Support
@@ -41,60 +41,87 @@ ParserContext g_parser_ctx = {0};
 
 /**
  * Unit conversion table - returns multiplier for known units, 0.0 otherwise
+ *
+ * Dispatches on length, then on the character that tells the candidates apart, so a suffix
+ * costs at most one short compare instead of a scan over every unit name.
  */
 static double get_unit_multiplier(const char *unit) {
-    static const struct {
-        const char *name;
-        double multiplier;
-    } units[] = {
-        /* Length units */
-        {"um", 1e-6},      /* micrometer */
-        {"mm", 1e-3},      /* millimeter */
-        {"mil", 25.4e-6},  /* mil (1/1000 inch) */
-        {"nm", 1e-9},      /* nanometer */
-        {"cm", 1e-2},      /* centimeter */
-        {"m", 1e-3},       /* milli (baseline behavior) */
-
-        /* Frequency units */
-        {"Hz", 1.0},       /* Hertz */
-        {"kHz", 1e3},      /* kilohertz */
-        {"MHz", 1e6},      /* megahertz */
-        {"GHz", 1e9},      /* gigahertz */
-        {"THz", 1e12},     /* terahertz */
-
-        /* Capacitance units */
-        {"F", 1.0},        /* Farad */
-        {"pF", 1e-12},     /* picofarad */
-        {"nF", 1e-9},      /* nanofarad */
-        {"uF", 1e-6},      /* microfarad */
-        {"mF", 1e-3},      /* millifarad */
-
-        /* Resistance units */
-        {"ohm", 1.0},      /* Ohm */
-        {"kohm", 1e3},     /* kiloohm */
-        {"Mohm", 1e6},     /* megaohm */
-
-        /* Inductance units */
-        {"H", 1.0},        /* Henry */
-        {"pH", 1e-12},     /* picohenry */
-        {"nH", 1e-9},      /* nanohenry */
-        {"uH", 1e-6},      /* microhenry */
-        {"mH", 1e-3},      /* millihenry */
-
-        /* Time units */
-        {"s", 1.0},        /* second */
-        {"ms", 1e-3},      /* millisecond */
-        {"us", 1e-6},      /* microsecond */
-        {"ns", 1e-9},      /* nanosecond */
-        {"ps", 1e-12},     /* picosecond */
-
-        {NULL, 0.0}
-    };
-
-    for (int i = 0; units[i].name != NULL; i++) {
-        if (strcmp(unit, units[i].name) == 0) {
-            return units[i].multiplier;
-        }
+    size_t len = strlen(unit);
+
+    switch (len) {
+        case 1:
+            switch (unit[0]) {
+                case 'm': return 1e-3;    /* milli (baseline behavior) */
+                case 'F': return 1.0;     /* Farad */
+                case 'H': return 1.0;     /* Henry */
+                case 's': return 1.0;     /* second */
+            }
+            break;
+
+        case 2:
+            /* Prefix + base unit; the base picks which prefixes exist */
+            switch (unit[1]) {
+                case 'm':   /* Length units */
+                    switch (unit[0]) {
+                        case 'u': return 1e-6;    /* micrometer */
+                        case 'm': return 1e-3;    /* millimeter */
+                        case 'n': return 1e-9;    /* nanometer */
+                        case 'c': return 1e-2;    /* centimeter */
+                    }
+                    break;
+                case 'F':   /* Capacitance units */
+                case 'H':   /* Inductance units */
+                    switch (unit[0]) {
+                        case 'p': return 1e-12;   /* picofarad / picohenry */
+                        case 'n': return 1e-9;    /* nanofarad / nanohenry */
+                        case 'u': return 1e-6;    /* microfarad / microhenry */
+                        case 'm': return 1e-3;    /* millifarad / millihenry */
+                    }
+                    break;
+                case 's':   /* Time units */
+                    switch (unit[0]) {
+                        case 'm': return 1e-3;    /* millisecond */
+                        case 'u': return 1e-6;    /* microsecond */
+                        case 'n': return 1e-9;    /* nanosecond */
+                        case 'p': return 1e-12;   /* picosecond */
+                    }
+                    break;
+                case 'z':
+                    if (unit[0] == 'H') return 1.0;   /* Hertz */
+                    break;
+            }
+            break;
+
+        case 3:
+            switch (unit[0]) {
+                case 'm':
+                    if (strcmp(unit, "mil") == 0) return 25.4e-6;   /* mil (1/1000 inch) */
+                    break;
+                case 'o':
+                    if (strcmp(unit, "ohm") == 0) return 1.0;       /* Ohm */
+                    break;
+                case 'k':
+                case 'M':
+                case 'G':
+                case 'T':
+                    /* Frequency units */
+                    if (unit[1] != 'H' || unit[2] != 'z') break;
+                    switch (unit[0]) {
+                        case 'k': return 1e3;     /* kilohertz */
+                        case 'M': return 1e6;     /* megahertz */
+                        case 'G': return 1e9;     /* gigahertz */
+                        case 'T': return 1e12;    /* terahertz */
+                    }
+                    break;
+            }
+            break;
+
+        case 4:
+            /* Resistance units */
+            if (strcmp(unit + 1, "ohm") != 0) break;
+            if (unit[0] == 'k') return 1e3;       /* kiloohm */
+            if (unit[0] == 'M') return 1e6;       /* megaohm */
+            break;
     }
     return 0.0;  /* Not a known unit */
 }
@@ -108,49 +135,29 @@ static double get_unit_multiplier(const char *unit) {
  *
  * Note: the lexer stores only a single "current token" position. Because this
  * parser uses a 1-token lookahead (peek_token), peeking would otherwise
- * overwrite the position of the last consumed token. We keep positions here so
- * code generation can refer to stable locations even after lookahead peeks.
+ * overwrite the position of the last consumed token. We keep positions in
+ * AelParserState so code generation can refer to stable locations even after
+ * lookahead peeks.
  */
-static int g_last_token_line = 0;      /* 0-based */
-static int g_last_token_col = 0;       /* 0-based */
-static int g_lookahead_line = 0;       /* 0-based */
-static int g_lookahead_col = 0;        /* 0-based */
-static int g_last_nonempty_string_line = 0;  /* 0-based */
-static int g_last_nonempty_string_col = 0;   /* 0-based */
-static bool g_last_nonempty_string_valid = false;
-static int g_last_not_line = 0;              /* 0-based */
-static int g_last_not_col = 0;               /* 0-based */
-static bool g_last_not_valid = false;
-static int g_last_compare_line = 0;          /* 0-based */
-static int g_last_compare_col = 0;           /* 0-based */
-static bool g_last_compare_valid = false;
-static int g_last_ident_line = 0;            /* 0-based */
-static int g_last_ident_col = 0;             /* 0-based */
-static bool g_last_ident_valid = false;
-static int g_last_null_line = 0;             /* 0-based */
-static int g_last_null_col = 0;              /* 0-based */
-static bool g_last_null_valid = false;
-static int g_expr_chain_start_line = 0;      /* 0-based: start of current expression chain */
-static int g_expr_chain_start_col = 0;       /* 0-based */
-static bool g_expr_chain_start_valid = false;
 
 /**
  * Get the next token from the lexer
  */
 int next_token(void) {
+    AelParserState *ps = parser_state();
     /* Use lookahead if available */
-    if (dword_18007E890 != -1) {
-        int token = dword_18007E890;
-        g_last_token_line = g_lookahead_line;
-        g_last_token_col = g_lookahead_col;
-        dword_18007E890 = -1;
+    if (ps->lookahead != -1) {
+        int token = ps->lookahead;
+        ps->last_token_line = ps->lookahead_line;
+        ps->last_token_col = ps->lookahead_col;
+        ps->lookahead = -1;
         return token;
     }
 
     /* Get from lexer */
     int token = ascan_lex(0);
-    g_last_token_line = lexer_get_line();
-    g_last_token_col = lexer_get_column();
+    ps->last_token_line = lexer_get_line();
+    ps->last_token_col = lexer_get_column();
     return token;
 }
 
@@ -158,25 +165,31 @@ int next_token(void) {
  * Peek at current token without consuming it
  */
 int peek_token(void) {
-    if (dword_18007E890 == -1) {
-        dword_18007E890 = ascan_lex(0);
-        g_lookahead_line = lexer_get_line();
-        g_lookahead_col = lexer_get_column();
+    AelParserState *ps = parser_state();
+    if (ps->lookahead == -1) {
+        ps->lookahead = ascan_lex(0);
+        ps->lookahead_line = lexer_get_line();
+        ps->lookahead_col = lexer_get_column();
     }
-    return dword_18007E890;
+    return ps->lookahead;
 }
 
 /**
  * Consume a token if it matches expected, otherwise error
  */
 bool expect_token(int expected_token) {
+    AelParserState *ps = parser_state();
     int token = next_token();
     if (token != expected_token) {
         fprintf(stderr, "Parser error: expected %s but got %s\n",
                 token_name(expected_token), token_name(token));
-        g_parser_ctx.had_error = true;
-        g_parser_ctx.error_count++;
-        dword_18007E898++;
+        if (!ps->first_error[0]) {
+            snprintf(ps->first_error, sizeof(ps->first_error), "line %d:%d: expected %s but got %s",
+                     ps->last_token_line + 1, ps->last_token_col + 1, token_name(expected_token), token_name(token));
+        }
+        ps->ctx.had_error = true;
+        ps->ctx.error_count++;
+        ps->error_count++;
         return false;
     }
     return true;
@@ -186,18 +199,23 @@ bool expect_token(int expected_token) {
  * Report parser error
  */
 void parser_error(const char *message) {
+    AelParserState *ps = parser_state();
     fprintf(stderr, "Parser error: %s (current token: %s)\n",
             message, token_name(peek_token()));
-    g_parser_ctx.had_error = true;
-    g_parser_ctx.error_count++;
-    dword_18007E898++;
+    if (!ps->first_error[0]) {
+        snprintf(ps->first_error, sizeof(ps->first_error), "line %d:%d: %s (current token: %s)",
+                 ps->lookahead_line + 1, ps->lookahead_col + 1, message, token_name(peek_token()));
+    }
+    ps->ctx.had_error = true;
+    ps->ctx.error_count++;
+    ps->error_count++;
 }
 
 /**
  * Get printable token name for error messages
  */
 const char *token_name(int token) {
-    static char buf[32];
+    static AEL_THREAD_LOCAL char buf[32];
     switch (token) {
         case TOK_EOF: return "EOF";
         case TOK_LPAREN: return "'('";
@@ -267,6 +285,7 @@ const char *token_name(int token) {
  *   - ( expression )
  */
 bool parse_primary_expr(ParserContext *ctx) {
+    AelParserState *ps = parser_state();
     int token = peek_token();
     int line, col;  /* Position tracking for acomp_op calls */
 
@@ -358,9 +377,9 @@ bool parse_primary_expr(ParserContext *ctx) {
              * patterns reuse a previous non-empty string position as an anchor).
              */
             if (str && str[0] != '\0') {
-                g_last_nonempty_string_line = str_line;
-                g_last_nonempty_string_col = str_col;
-                g_last_nonempty_string_valid = true;
+                ps->last_nonempty_string_line = str_line;
+                ps->last_nonempty_string_col = str_col;
+                ps->last_nonempty_string_valid = true;
             }
             return true;
         }
@@ -384,9 +403,9 @@ bool parse_primary_expr(ParserContext *ctx) {
             int null_col = lexer_get_column();
             next_token();
             acomp_null();
-            g_last_null_line = null_line;
-            g_last_null_col = null_col;
-            g_last_null_valid = true;
+            ps->last_null_line = null_line;
+            ps->last_null_col = null_col;
+            ps->last_null_valid = true;
             return true;
         }
 
@@ -404,9 +423,9 @@ bool parse_primary_expr(ParserContext *ctx) {
             strncpy(name_buf, name ? name : "", sizeof(name_buf) - 1);
             name_buf[sizeof(name_buf) - 1] = '\0';
 
-            g_last_ident_line = id_line;
-            g_last_ident_col = id_col;
-            g_last_ident_valid = true;
+            ps->last_ident_line = id_line;
+            ps->last_ident_col = id_col;
+            ps->last_ident_valid = true;
 
             /* Check if this is a function call */
             if (peek_token() == TOK_LPAREN) {
@@ -546,8 +565,8 @@ bool parse_primary_expr(ParserContext *ctx) {
              * We keep counters per depth, and reset deeper-depth counters when
              * exiting a list (so "first at depth" is scoped to its parent list).
              */
-            enum { MAX_TRACKED_LIST_DEPTH = 16 };
-            static int list_count_by_depth[MAX_TRACKED_LIST_DEPTH] = {0};
+            enum { MAX_TRACKED_LIST_DEPTH = AEL_MAX_TRACKED_LIST_DEPTH };
+            int *list_count_by_depth = ps->list_count_by_depth;
 
             bool is_first_list_at_depth = false;
             if (AcompDepth >= 3 && AcompDepth < MAX_TRACKED_LIST_DEPTH) {
@@ -676,6 +695,7 @@ bool parse_primary_expr(ParserContext *ctx) {
  *   - -- unary_expr  (pre-decrement)
  */
 bool parse_unary_expr(ParserContext *ctx) {
+    AelParserState *ps = parser_state();
     int token = peek_token();
     int line, col;  /* Position tracking for acomp_op calls */
 
@@ -696,9 +716,9 @@ bool parse_unary_expr(ParserContext *ctx) {
          line = lexer_get_line();
          col = lexer_get_column();
 
-         g_last_not_line = line;
-         g_last_not_col = col;
-         g_last_not_valid = true;
+         ps->last_not_line = line;
+         ps->last_not_col = col;
+         ps->last_not_valid = true;
 
          next_token();
          if (!parse_unary_expr(ctx)) {
@@ -1045,6 +1065,7 @@ bool parse_bit_or_expr(ParserContext *ctx) {
  *   bit_or_expr && bit_or_expr
  */
 bool parse_logical_and_expr(ParserContext *ctx) {
+    AelParserState *ps = parser_state();
     if (!parse_bit_or_expr(ctx)) {
         return false;
     }
@@ -1068,8 +1089,8 @@ bool parse_logical_and_expr(ParserContext *ctx) {
         next_token();  /* Consume && */
         and_op_count++;
 
-        int line = g_last_token_line;
-        int col = g_last_token_col;
+        int line = ps->last_token_line;
+        int col = ps->last_token_col;
 
         if (!and_chain_anchor_valid) {
             /* Baseline anchor selection for multi-AND chains:
@@ -1078,29 +1099,29 @@ bool parse_logical_and_expr(ParserContext *ctx) {
              * - Else (in some baseline patterns) reuse a nearby prior string literal position
              * - Else fall back to the first `&&` position itself (e.g. `x && ...`)
              */
-            if (g_last_not_valid && g_last_not_line == line) {
-                and_chain_anchor_line = g_last_not_line;
-                and_chain_anchor_col = g_last_not_col;
+            if (ps->last_not_valid && ps->last_not_line == line) {
+                and_chain_anchor_line = ps->last_not_line;
+                and_chain_anchor_col = ps->last_not_col;
                 and_chain_anchor_valid = true;
-            } else if (g_last_compare_valid && g_last_compare_line == line) {
-                if (g_last_null_valid && g_last_null_line == line) {
-                    and_chain_anchor_line = g_last_compare_line;
-                    and_chain_anchor_col = g_last_compare_col;
+            } else if (ps->last_compare_valid && ps->last_compare_line == line) {
+                if (ps->last_null_valid && ps->last_null_line == line) {
+                    and_chain_anchor_line = ps->last_compare_line;
+                    and_chain_anchor_col = ps->last_compare_col;
                     and_chain_anchor_valid = true;
-                } else if (g_last_ident_valid && g_last_ident_line == line) {
-                    and_chain_anchor_line = g_last_ident_line;
-                    and_chain_anchor_col = g_last_ident_col;
+                } else if (ps->last_ident_valid && ps->last_ident_line == line) {
+                    and_chain_anchor_line = ps->last_ident_line;
+                    and_chain_anchor_col = ps->last_ident_col;
                     and_chain_anchor_valid = true;
                 } else {
-                    and_chain_anchor_line = g_last_compare_line;
-                    and_chain_anchor_col = g_last_compare_col;
+                    and_chain_anchor_line = ps->last_compare_line;
+                    and_chain_anchor_col = ps->last_compare_col;
                     and_chain_anchor_valid = true;
                 }
-            } else if (g_last_nonempty_string_valid &&
-                       g_last_nonempty_string_line < line &&
-                       (line - g_last_nonempty_string_line) <= 3) {
-                and_chain_anchor_line = g_last_nonempty_string_line;
-                and_chain_anchor_col = g_last_nonempty_string_col;
+            } else if (ps->last_nonempty_string_valid &&
+                       ps->last_nonempty_string_line < line &&
+                       (line - ps->last_nonempty_string_line) <= 3) {
+                and_chain_anchor_line = ps->last_nonempty_string_line;
+                and_chain_anchor_col = ps->last_nonempty_string_col;
                 and_chain_anchor_valid = true;
             } else {
                 and_chain_anchor_line = line;
@@ -1293,6 +1314,7 @@ bool parse_ternary_expr(ParserContext *ctx) {
  * Everything else goes through normal expression parsing.
  */
 bool parse_assignment_expr(ParserContext *ctx) {
+    AelParserState *ps = parser_state();
     int line, col;  /* Position tracking for acomp_op calls */
 
     /* Peek ahead to check for simple assignment pattern */
@@ -1311,9 +1333,9 @@ bool parse_assignment_expr(ParserContext *ctx) {
         strncpy(name_buf, id_name ? id_name : "", sizeof(name_buf) - 1);
         name_buf[sizeof(name_buf) - 1] = '\0';
 
-        g_last_ident_line = id_line;
-        g_last_ident_col = id_col;
-        g_last_ident_valid = true;
+        ps->last_ident_line = id_line;
+        ps->last_ident_col = id_col;
+        ps->last_ident_valid = true;
 
         /* Check next token */
         int next_tok = peek_token();
@@ -1391,9 +1413,9 @@ bool parse_assignment_expr(ParserContext *ctx) {
                 /* Generate EXPR operation - use identifier position */
                 acomp_op(17, id_line, id_col, 1);
 
-                g_expr_chain_start_line = id_line;
-                g_expr_chain_start_col = id_col;
-                g_expr_chain_start_valid = true;
+                ps->expr_chain_start_line = id_line;
+                ps->expr_chain_start_col = id_col;
+                ps->expr_chain_start_valid = true;
                 return parse_expression_continue(ctx);
             }
 
@@ -1524,9 +1546,9 @@ bool parse_assignment_expr(ParserContext *ctx) {
                 return false;
             }
             /* Function call result might be used in expression - continue parsing operators */
-            g_expr_chain_start_line = id_line;
-            g_expr_chain_start_col = id_col;
-            g_expr_chain_start_valid = true;
+            ps->expr_chain_start_line = id_line;
+            ps->expr_chain_start_col = id_col;
+            ps->expr_chain_start_valid = true;
             return parse_expression_continue(ctx);
 
         } else {
@@ -1560,9 +1582,9 @@ bool parse_assignment_expr(ParserContext *ctx) {
             }
 
             /* Now parse any binary operators that follow */
-            g_expr_chain_start_line = id_line;
-            g_expr_chain_start_col = id_col;
-            g_expr_chain_start_valid = true;
+            ps->expr_chain_start_line = id_line;
+            ps->expr_chain_start_col = id_col;
+            ps->expr_chain_start_valid = true;
             return parse_expression_continue(ctx);
         }
     }
@@ -1611,6 +1633,7 @@ static bool parse_multiplicative_continue(ParserContext *ctx) {
  * Called when left operand has already been parsed and wrapped in OP=17
  */
 static bool parse_expression_continue(ParserContext *ctx) {
+    AelParserState *ps = parser_state();
     int line, col;
 
     /* Handle all binary operators with proper precedence */
@@ -1691,9 +1714,9 @@ static bool parse_expression_continue(ParserContext *ctx) {
         line = lexer_get_line();
         col = lexer_get_column();
         next_token();
-        g_last_compare_line = line;
-        g_last_compare_col = col;
-        g_last_compare_valid = true;
+        ps->last_compare_line = line;
+        ps->last_compare_col = col;
+        ps->last_compare_valid = true;
 
         /* Right operand: parse relational level */
         if (!parse_relational_expr(ctx)) {
@@ -1786,33 +1809,33 @@ static bool parse_expression_continue(ParserContext *ctx) {
         next_token();  /* Consume && */
         and_op_count++;
 
-        line = g_last_token_line;
-        col = g_last_token_col;
+        line = ps->last_token_line;
+        col = ps->last_token_col;
 
         if (!and_chain_anchor_valid) {
-            if (g_last_not_valid && g_last_not_line == line) {
-                and_chain_anchor_line = g_last_not_line;
-                and_chain_anchor_col = g_last_not_col;
+            if (ps->last_not_valid && ps->last_not_line == line) {
+                and_chain_anchor_line = ps->last_not_line;
+                and_chain_anchor_col = ps->last_not_col;
                 and_chain_anchor_valid = true;
-            } else if (g_last_compare_valid && g_last_compare_line == line) {
-                if (g_last_null_valid && g_last_null_line == line) {
-                    and_chain_anchor_line = g_last_compare_line;
-                    and_chain_anchor_col = g_last_compare_col;
+            } else if (ps->last_compare_valid && ps->last_compare_line == line) {
+                if (ps->last_null_valid && ps->last_null_line == line) {
+                    and_chain_anchor_line = ps->last_compare_line;
+                    and_chain_anchor_col = ps->last_compare_col;
                     and_chain_anchor_valid = true;
-                } else if (g_last_ident_valid && g_last_ident_line == line) {
-                    and_chain_anchor_line = g_last_ident_line;
-                    and_chain_anchor_col = g_last_ident_col;
+                } else if (ps->last_ident_valid && ps->last_ident_line == line) {
+                    and_chain_anchor_line = ps->last_ident_line;
+                    and_chain_anchor_col = ps->last_ident_col;
                     and_chain_anchor_valid = true;
                 } else {
-                    and_chain_anchor_line = g_last_compare_line;
-                    and_chain_anchor_col = g_last_compare_col;
+                    and_chain_anchor_line = ps->last_compare_line;
+                    and_chain_anchor_col = ps->last_compare_col;
                     and_chain_anchor_valid = true;
                 }
-            } else if (g_last_nonempty_string_valid &&
-                       g_last_nonempty_string_line < line &&
-                       (line - g_last_nonempty_string_line) <= 3) {
-                and_chain_anchor_line = g_last_nonempty_string_line;
-                and_chain_anchor_col = g_last_nonempty_string_col;
+            } else if (ps->last_nonempty_string_valid &&
+                       ps->last_nonempty_string_line < line &&
+                       (line - ps->last_nonempty_string_line) <= 3) {
+                and_chain_anchor_line = ps->last_nonempty_string_line;
+                and_chain_anchor_col = ps->last_nonempty_string_col;
                 and_chain_anchor_valid = true;
             } else {
                 and_chain_anchor_line = line;
@@ -1868,8 +1891,8 @@ static bool parse_expression_continue(ParserContext *ctx) {
      * `Type == "X" || ...`). We capture the last-consumed token position before
      * entering the OR loop and reuse it only for the final OP=63 of the chain.
      */
-    int or_chain_anchor_line = g_last_token_line;
-    int or_chain_anchor_col = g_last_token_col;
+    int or_chain_anchor_line = ps->last_token_line;
+    int or_chain_anchor_col = ps->last_token_col;
 
     int or_op_count = 0;
 
@@ -1882,8 +1905,8 @@ static bool parse_expression_continue(ParserContext *ctx) {
         next_token();  /* Consume || */
         or_op_count++;
 
-        line = g_last_token_line;
-        col = g_last_token_col;
+        line = ps->last_token_line;
+        col = ps->last_token_col;
 
         /* Start short-circuit OR */
         acomp_op(63, line, col, 1);  /* OP=48 arg1=63 */
@@ -1942,8 +1965,8 @@ static bool parse_expression_continue(ParserContext *ctx) {
         /* Baseline uses the condition expression start position for OP=61/60/65.
          * For expression_continue() the chain start is set by the caller (identifier-based).
          */
-        int cond_start_line = g_expr_chain_start_valid ? g_expr_chain_start_line : question_line;
-        int cond_start_col = g_expr_chain_start_valid ? g_expr_chain_start_col : question_col;
+        int cond_start_line = ps->expr_chain_start_valid ? ps->expr_chain_start_line : question_line;
+        int cond_start_col = ps->expr_chain_start_valid ? ps->expr_chain_start_col : question_col;
 
         /* True branch marker - OP=61 */
         acomp_op(61, cond_start_line, cond_start_col, 1);
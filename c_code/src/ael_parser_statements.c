@@ -22,9 +22,6 @@ extern int peek_token(void);
 extern bool expect_token(int expected_token);
 extern void parser_error(const char *message);
 
-/* External IR generation functions */
-extern int AcompDepth;
-
 /* ============================================================================
  * Function Call Parsing
  * ============================================================================ */
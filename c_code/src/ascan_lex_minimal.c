@@ -18,6 +18,7 @@
 #include "yacc_parser_globals.h"
 #include "ael_parser_new.h"  /* Use parser's token definitions */
 #include "lexer_state.h"      /* For sharing values with parser */
+#include "ael_compiler_internal.h"
 
 /* Treat lexer printf as debug-only output. */
 #define printf AEL_DEBUG_PRINTF
@@ -28,53 +29,26 @@
 
 extern __int128_emu agram_lval;  /* Current semantic value */
 
-/* Lexer state */
-static FILE *lex_input = NULL;
-static int lex_line = 1;
-static int lex_col = 1;
-static char lex_buffer[1024];
-static int lex_buf_pos = 0;
+/* Lexer state lives in the compiler bound to this thread (AelLexer, see ael_compiler_internal.h). */
+static AelLexer *cur_lexer(void)
+{
+    return &ael_compiler_current()->lex;
+}
 
-/* Token start position (saved before scanning) */
-static int token_start_line = 1;
-static int token_start_col = 1;
+/* Character classes, filled from <ctype.h> at load time so they agree with the old per-char tests. */
+enum {
+    CC_SPACE = 1,        /* isspace */
+    CC_DIGIT = 2,        /* isdigit */
+    CC_IDENT_START = 4,  /* isalpha or '_' */
+    CC_IDENT = 8         /* isalnum or '_' */
+};
 
 /* Macro to return token with position tracking */
 #define RETURN_TOKEN(tok) do { \
-    lexer_set_position(token_start_line, token_start_col); \
+    lexer_set_position(lx->token_start_line, lx->token_start_col); \
     return (tok); \
 } while(0)
 
-/* ========================================
- * Keyword Table (using parser's token values)
- * ======================================== */
-
-struct keyword {
-    const char *name;
-    int token;
-};
-
-static struct keyword keywords[] = {
-    {"decl", TOK_DECL},
-    {"defun", TOK_DEFUN},
-    {"return", TOK_RETURN},
-    {"if", TOK_IF},
-    {"else", TOK_ELSE},
-    {"while", TOK_WHILE},
-    {"for", TOK_FOR},
-    {"do", TOK_DO},
-    {"switch", TOK_SWITCH},
-    {"case", TOK_CASE},
-    {"default", TOK_DEFAULT},
-    {"break", TOK_BREAK},
-    {"continue", TOK_CONTINUE},
-    {"TRUE", TOK_TRUE},      // uppercase
-    {"FALSE", TOK_FALSE},    // uppercase
-    {"null", TOK_NULL},      // lowercase
-    {"NULL", TOK_NULL},      // uppercase
-    {NULL, 0}
-};
-
 /* ========================================
  * Helper Functions
  * ======================================== */
@@ -82,7 +56,7 @@ static struct keyword keywords[] = {
 static double ael_strtod_c(const char *s)
 {
 #if defined(_WIN32)
-    static _locale_t c_locale = NULL;
+    static AEL_THREAD_LOCAL _locale_t c_locale = NULL;
     if (!c_locale) {
         c_locale = _create_locale(LC_NUMERIC, "C");
     }
@@ -93,83 +67,197 @@ static double ael_strtod_c(const char *s)
     return strtod(s, NULL);
 }
 
-static int get_char(void)
+static void init_char_class(AelLexer *lx)
+{
+    for (int c = 0; c < 256; c++) {
+        unsigned char cc = 0;
+        if (isspace(c)) cc |= CC_SPACE;
+        if (isdigit(c)) cc |= CC_DIGIT;
+        if (isalpha(c) || c == '_') cc |= CC_IDENT_START;
+        if (isalnum(c) || c == '_') cc |= CC_IDENT;
+        lx->char_class[c] = cc;
+    }
+}
+
+static void free_input(AelLexer *lx)
+{
+    if (lx->owns_src) free(lx->src);
+    lx->src = NULL;
+    lx->owns_src = false;
+    lx->cur = NULL;
+    lx->end = NULL;
+    lx->loaded = false;
+}
+
+/* Reads the rest of `fp` into lx->src. A read error ends the input there, as fgetc() returning EOF did. */
+static bool load_input(AelLexer *lx, FILE *fp)
+{
+    size_t cap = 64 * 1024;
+    size_t len = 0;
+    unsigned char *buf = (unsigned char *)malloc(cap);
+    if (!buf) return false;
+    for (;;) {
+        size_t n = fread(buf + len, 1, cap - len, fp);
+        len += n;
+        if (len < cap) break;
+        unsigned char *nb = (unsigned char *)realloc(buf, cap * 2);
+        if (!nb) {
+            free(buf);
+            return false;
+        }
+        buf = nb;
+        cap *= 2;
+    }
+    free_input(lx);
+    init_char_class(lx);
+    lx->src = buf;
+    lx->owns_src = true;
+    lx->cur = buf;
+    lx->end = buf + len;
+    lx->loaded = true;
+    return true;
+}
+
+/* Line/column bookkeeping for one consumed character. */
+static void advance_pos(AelLexer *lx, int ch)
 {
-    int ch = fgetc(lex_input);
     if (ch == '\n') {
-        lex_line++;
-        lex_col = 1;
+        lx->line++;
+        lx->col = 1;
     } else if (ch == '\t') {
         /* Expand tab to next 4-column boundary (tab stops at 4, 8, 12, ...) */
-        lex_col = ((lex_col - 1) / 4 + 1) * 4 + 1;
-    } else if (ch != EOF) {
-        lex_col++;
+        lx->col = ((lx->col - 1) / 4 + 1) * 4 + 1;
+    } else {
+        lx->col++;
     }
+}
+
+static int get_char(AelLexer *lx)
+{
+    if (lx->cur >= lx->end) return EOF;
+    int ch = *lx->cur++;
+    advance_pos(lx, ch);
     return ch;
 }
 
-static void unget_char(int ch)
+/* The character `k` positions ahead of the cursor, without consuming it. */
+static int peek_char(const AelLexer *lx, size_t k)
 {
-    if (ch != EOF) {
-        ungetc(ch, lex_input);
-        if (ch == '\n') {
-            lex_line--;
-        } else if (ch == '\t') {
-            /* Reverse tab expansion: move back to previous tab boundary
-             * Since we don't know the original column, we approximate by moving back 4 columns
-             * This is a limitation of the unget mechanism, but in practice tokens rarely unget tabs
-             */
-            lex_col = (lex_col > 4) ? lex_col - 4 : 1;
-        } else {
-            lex_col--;
-        }
-    }
+    return (size_t)(lx->end - lx->cur) > k ? lx->cur[k] : EOF;
 }
 
-static void skip_whitespace(void)
+/* Consumes the next character if it is `ch`. */
+static bool accept_char(AelLexer *lx, int ch)
 {
-    int ch;
-    while ((ch = get_char()) != EOF) {
-        if (!isspace(ch)) {
-            unget_char(ch);
-            break;
-        }
+    if (peek_char(lx, 0) == ch) {
+        get_char(lx);
+        return true;
     }
+    return false;
 }
 
-static void skip_comment(void)
+/* Consumes everything up to `stop`. */
+static void consume_to(AelLexer *lx, const unsigned char *stop)
 {
-    int ch;
-    /* Skip until end of line */
-    while ((ch = get_char()) != EOF && ch != '\n')
-        ;
-    if (ch == '\n')
-        unget_char(ch);
+    while (lx->cur < stop) advance_pos(lx, *lx->cur++);
 }
 
-static void skip_block_comment(void)
+/* Consumes up to `stop` when the run is known to hold no newline or tab (identifier / number text). */
+static void consume_plain_to(AelLexer *lx, const unsigned char *stop)
+{
+    lx->col += (int)(stop - lx->cur);
+    lx->cur = stop;
+}
+
+static void skip_whitespace(AelLexer *lx)
+{
+    const unsigned char *p = lx->cur;
+    while (p < lx->end && (lx->char_class[*p] & CC_SPACE)) p++;
+    consume_to(lx, p);
+}
+
+static void skip_comment(AelLexer *lx)
+{
+    /* Skip until end of line; the newline itself is left for skip_whitespace */
+    const unsigned char *nl = (const unsigned char *)memchr(lx->cur, '\n', (size_t)(lx->end - lx->cur));
+    consume_to(lx, nl ? nl : lx->end);
+}
+
+static void skip_block_comment(AelLexer *lx)
 {
-    int ch;
     /* Skip until closing asterisk-slash found */
-    while ((ch = get_char()) != EOF) {
-        if (ch == '*') {
-            int next = get_char();
-            if (next == '/') {
-                /* End of block comment */
-                return;
-            } else {
-                unget_char(next);
-            }
+    const unsigned char *p = lx->cur;
+    while (p < lx->end) {
+        const unsigned char *star = (const unsigned char *)memchr(p, '*', (size_t)(lx->end - p));
+        if (!star) break;
+        if (star + 1 < lx->end && star[1] == '/') {
+            /* End of block comment */
+            consume_to(lx, star + 2);
+            return;
         }
+        p = star + 1;
     }
+    consume_to(lx, lx->end);
 }
 
-static int check_keyword(const char *str)
+/* Copies [from, to) into lx->buffer, truncated to its capacity; returns the copied length. */
+static size_t copy_token_text(AelLexer *lx, const unsigned char *from, const unsigned char *to)
 {
-    for (int i = 0; keywords[i].name != NULL; i++) {
-        if (strcmp(str, keywords[i].name) == 0) {
-            return keywords[i].token;
-        }
+    size_t n = (size_t)(to - from);
+    if (n > sizeof(lx->buffer) - 1) n = sizeof(lx->buffer) - 1;
+    memcpy(lx->buffer, from, n);
+    lx->buffer[n] = '\0';
+    return n;
+}
+
+/*
+ * Keyword lookup: switch on length, then on the first character, so an identifier costs at most
+ * one memcmp against the only keyword it could be.
+ */
+static int check_keyword(AelLexer *lx, const char *str, size_t len)
+{
+    const char *kw = NULL;
+    int token = TOK_IDENTIFIER;
+
+    switch (len) {
+        case 2:
+            if (str[0] == 'i') { kw = "if"; token = TOK_IF; }
+            else if (str[0] == 'd') { kw = "do"; token = TOK_DO; }
+            break;
+        case 3:
+            kw = "for"; token = TOK_FOR;
+            break;
+        case 4:
+            switch (str[0]) {
+                case 'd': kw = "decl"; token = TOK_DECL; break;
+                case 'e': kw = "else"; token = TOK_ELSE; break;
+                case 'c': kw = "case"; token = TOK_CASE; break;
+                case 'T': kw = "TRUE"; token = TOK_TRUE; break;      // uppercase
+                case 'n': kw = "null"; token = TOK_NULL; break;      // lowercase
+                case 'N': kw = "NULL"; token = TOK_NULL; break;      // uppercase
+            }
+            break;
+        case 5:
+            switch (str[0]) {
+                case 'd': kw = "defun"; token = TOK_DEFUN; break;
+                case 'w': kw = "while"; token = TOK_WHILE; break;
+                case 'b': kw = "break"; token = TOK_BREAK; break;
+                case 'F': kw = "FALSE"; token = TOK_FALSE; break;    // uppercase
+            }
+            break;
+        case 6:
+            if (str[0] == 'r') { kw = "return"; token = TOK_RETURN; }
+            else if (str[0] == 's') { kw = "switch"; token = TOK_SWITCH; }
+            break;
+        case 7:
+            kw = "default"; token = TOK_DEFAULT;
+            break;
+        case 8:
+            kw = "continue"; token = TOK_CONTINUE;
+            break;
+    }
+    if (kw && memcmp(str, kw, len) == 0) {
+        return token;
     }
     RETURN_TOKEN(TOK_IDENTIFIER);
 }
@@ -180,28 +268,35 @@ static int check_keyword(const char *str)
 
 int ascan_lex(int token_hint)
 {
+    AelLexer *lx = cur_lexer();
     int ch;
 
     /* Initialize on first call */
-    if (!lex_input) {
-        extern FILE *ascan_stream;
-        lex_input = ascan_stream;
-        if (!lex_input) {
+    if (!lx->loaded) {
+        if (!lx->input) {
+            extern FILE *ascan_stream;
+            lx->input = ascan_stream;
+        }
+        if (!lx->input) {
             fprintf(stderr, "[ascan_lex] Error: Input stream not initialized\n");
             RETURN_TOKEN(TOK_EOF);
         }
+        if (!load_input(lx, lx->input)) {
+            fprintf(stderr, "[ascan_lex] Error: Out of memory buffering input stream\n");
+            RETURN_TOKEN(TOK_EOF);
+        }
         printf("[ascan_lex] Initialized, reading from stream\n");
     }
 
     /* Skip whitespace and comments */
     while (1) {
-        skip_whitespace();
+        skip_whitespace(lx);
 
         /* Save token start position BEFORE reading the token */
-        token_start_line = lex_line;
-        token_start_col = lex_col;
+        lx->token_start_line = lx->line;
+        lx->token_start_col = lx->col;
 
-        ch = get_char();
+        ch = get_char(lx);
 
         if (ch == EOF) {
             printf("[ascan_lex] EOF reached\n");
@@ -210,20 +305,18 @@ int ascan_lex(int token_hint)
 
         /* Check for comment or division */
         if (ch == '/') {
-            int next = get_char();
-            if (next == '/') {
+            if (accept_char(lx, '/')) {
                 /* Single-line comment */
-                skip_comment();
+                skip_comment(lx);
                 continue;
-            } else if (next == '*') {
+            } else if (accept_char(lx, '*')) {
                 /* Block comment */
-                skip_block_comment();
+                skip_block_comment(lx);
                 continue;
-            } else if (next == '=') {
+            } else if (accept_char(lx, '=')) {
                 printf("[ascan_lex] Token: SLASH_ASSIGN '/='\n");
                 RETURN_TOKEN(TOK_SLASH_ASSIGN);
             } else {
-                unget_char(next);
                 /* Division operator */
                 printf("[ascan_lex] Token: SLASH '/'\n");
                 RETURN_TOKEN(TOK_SLASH);
@@ -260,115 +353,95 @@ int ascan_lex(int token_hint)
             printf("[ascan_lex] Token: SEMICOLON ';'\n");
             RETURN_TOKEN(TOK_SEMICOLON);
         case '=': {
-            int next = get_char();
-            if (next == '=') {
+            if (accept_char(lx, '=')) {
                 printf("[ascan_lex] Token: EQ '=='\n");
                 RETURN_TOKEN(TOK_EQ);
             } else {
-                unget_char(next);
                 printf("[ascan_lex] Token: ASSIGN '='\n");
                 RETURN_TOKEN(TOK_ASSIGN);
             }
         }
         case '+': {
-            int next = get_char();
-            if (next == '+') {
+            if (accept_char(lx, '+')) {
                 printf("[ascan_lex] Token: INCREMENT '++'\n");
                 RETURN_TOKEN(TOK_INCREMENT);
-            } else if (next == '=') {
+            } else if (accept_char(lx, '=')) {
                 printf("[ascan_lex] Token: PLUS_ASSIGN '+='\n");
                 RETURN_TOKEN(TOK_PLUS_ASSIGN);
             } else {
-                unget_char(next);
                 printf("[ascan_lex] Token: PLUS '+'\n");
                 RETURN_TOKEN(TOK_PLUS);
             }
         }
         case '-': {
-            int next = get_char();
-            if (next == '-') {
+            if (accept_char(lx, '-')) {
                 printf("[ascan_lex] Token: DECREMENT '--'\n");
                 RETURN_TOKEN(TOK_DECREMENT);
-            } else if (next == '=') {
+            } else if (accept_char(lx, '=')) {
                 printf("[ascan_lex] Token: MINUS_ASSIGN '-='\n");
                 RETURN_TOKEN(TOK_MINUS_ASSIGN);
             } else {
-                unget_char(next);
                 printf("[ascan_lex] Token: MINUS '-'\n");
                 RETURN_TOKEN(TOK_MINUS);
             }
         }
         case '*': {
-            int next = get_char();
-            if (next == '=') {
+            if (accept_char(lx, '=')) {
                 printf("[ascan_lex] Token: STAR_ASSIGN '*='\n");
                 RETURN_TOKEN(TOK_STAR_ASSIGN);
-            } else if (next == '*') {
+            } else if (accept_char(lx, '*')) {
                 printf("[ascan_lex] Token: POWER '**'\n");
                 RETURN_TOKEN(TOK_POWER);
             } else {
-                unget_char(next);
                 printf("[ascan_lex] Token: STAR '*'\n");
                 RETURN_TOKEN(TOK_STAR);
             }
         }
         case '%': {
-            int next = get_char();
-            if (next == '=') {
+            if (accept_char(lx, '=')) {
                 printf("[ascan_lex] Token: PERCENT_ASSIGN '%%='\n");
                 RETURN_TOKEN(TOK_PERCENT_ASSIGN);
             } else {
-                unget_char(next);
                 printf("[ascan_lex] Token: PERCENT '%%'\n");
                 RETURN_TOKEN(TOK_PERCENT);
             }
         }
         case '<': {
-            int next = get_char();
-            if (next == '=') {
+            if (accept_char(lx, '=')) {
                 RETURN_TOKEN(TOK_LE);
-            } else if (next == '<') {
+            } else if (accept_char(lx, '<')) {
                 RETURN_TOKEN(TOK_LSHIFT);  // <<
             } else {
-                unget_char(next);
                 RETURN_TOKEN(TOK_LT);
             }
         }
         case '>': {
-            int next = get_char();
-            if (next == '=') {
+            if (accept_char(lx, '=')) {
                 RETURN_TOKEN(TOK_GE);
-            } else if (next == '>') {
+            } else if (accept_char(lx, '>')) {
                 RETURN_TOKEN(TOK_RSHIFT);  // >>
             } else {
-                unget_char(next);
                 RETURN_TOKEN(TOK_GT);
             }
         }
         case '!': {
-            int next = get_char();
-            if (next == '=') {
+            if (accept_char(lx, '=')) {
                 RETURN_TOKEN(TOK_NE);
             } else {
-                unget_char(next);
                 RETURN_TOKEN(TOK_NOT);
             }
         }
         case '&': {
-            int next = get_char();
-            if (next == '&') {
+            if (accept_char(lx, '&')) {
                 RETURN_TOKEN(TOK_AND);
             } else {
-                unget_char(next);
                 RETURN_TOKEN(TOK_BIT_AND);  // Single &
             }
         }
         case '|': {
-            int next = get_char();
-            if (next == '|') {
+            if (accept_char(lx, '|')) {
                 RETURN_TOKEN(TOK_OR);
             } else {
-                unget_char(next);
                 RETURN_TOKEN(TOK_BIT_OR);  // Single |
             }
         }
@@ -380,141 +453,114 @@ int ascan_lex(int token_hint)
             RETURN_TOKEN(TOK_COLON);
         case '"': {
             /* String literal - preserve escape sequences for IR output */
-            int i = 0;
-            while ((ch = get_char()) != EOF && ch != '"') {
-                if (ch == '\\') {
-                    int next = get_char();
-                    if (next == '\n') {
-                        /* Line continuation inside string: "\" + newline is removed. */
-                        continue;
-                    }
-                    if (next == '\r') {
-                        /* Handle CRLF continuation if it ever reaches lexer. */
-                        int next2 = get_char();
-                        if (next2 != '\n') {
-                            unget_char(next2);
-                        }
-                        continue;
-                    }
-                    /* Keep the backslash and the escaped char as-is */
-                    if (i < sizeof(lex_buffer) - 1) {
-                        lex_buffer[i++] = '\\';
-                    }
-                    if (next != EOF && i < sizeof(lex_buffer) - 1) {
-                        lex_buffer[i++] = next;
-                    }
-                } else {
-                    if (i < sizeof(lex_buffer) - 1) {
-                        lex_buffer[i++] = ch;
-                    }
+            size_t i = 0;
+            for (;;) {
+                /* Copy the run up to the next quote or backslash in one go */
+                const unsigned char *p = lx->cur;
+                while (p < lx->end && *p != '"' && *p != '\\') p++;
+                size_t n = (size_t)(p - lx->cur);
+                if (n > sizeof(lx->buffer) - 1 - i) n = sizeof(lx->buffer) - 1 - i;
+                memcpy(lx->buffer + i, lx->cur, n);
+                i += n;
+                consume_to(lx, p);
+
+                ch = get_char(lx);
+                if (ch != '\\') break;  /* closing quote or EOF */
+                int next = get_char(lx);
+                if (next == '\n') {
+                    /* Line continuation inside string: "\" + newline is removed. */
+                    continue;
+                }
+                if (next == '\r') {
+                    /* Handle CRLF continuation if it ever reaches lexer. */
+                    accept_char(lx, '\n');
+                    continue;
+                }
+                /* Keep the backslash and the escaped char as-is */
+                if (i < sizeof(lx->buffer) - 1) {
+                    lx->buffer[i++] = '\\';
+                }
+                if (next != EOF && i < sizeof(lx->buffer) - 1) {
+                    lx->buffer[i++] = (char)next;
                 }
             }
-            lex_buffer[i] = '\0';
-            printf("[ascan_lex] Token: STRING \"%s\"\n", lex_buffer);
-            lexer_set_string(lex_buffer);
+            lx->buffer[i] = '\0';
+            printf("[ascan_lex] Token: STRING \"%s\"\n", lx->buffer);
+            lexer_set_string(lx->buffer);
             RETURN_TOKEN(TOK_STRING);
         }
     }
 
     /* Identifier or keyword */
-    if (isalpha(ch) || ch == '_') {
-        int i = 0;
-        lex_buffer[i++] = ch;
-
-        while ((ch = get_char()) != EOF) {
-            if (isalnum(ch) || ch == '_') {
-                if (i < sizeof(lex_buffer) - 1) {
-                    lex_buffer[i++] = ch;
-                }
-            } else {
-                unget_char(ch);
-                break;
-            }
-        }
-
-        lex_buffer[i] = '\0';
-
-        int token = check_keyword(lex_buffer);
+    if (lx->char_class[ch] & CC_IDENT_START) {
+        const unsigned char *start = lx->cur - 1;
+        const unsigned char *p = lx->cur;
+        while (p < lx->end && (lx->char_class[*p] & CC_IDENT)) p++;
+        consume_plain_to(lx, p);
+        size_t len = copy_token_text(lx, start, p);
+
+        int token = check_keyword(lx, lx->buffer, len);
         if (token == TOK_IDENTIFIER) {
-            printf("[ascan_lex] Token: IDENTIFIER '%s'\n", lex_buffer);
-            lexer_set_identifier(lex_buffer);  /* Store for parser */
+            printf("[ascan_lex] Token: IDENTIFIER '%s'\n", lx->buffer);
+            lexer_set_identifier(lx->buffer);  /* Store for parser */
         } else {
-            printf("[ascan_lex] Token: KEYWORD '%s' (token=%d)\n", lex_buffer, token);
+            printf("[ascan_lex] Token: KEYWORD '%s' (token=%d)\n", lx->buffer, token);
         }
         /* Set position for all identifier/keyword tokens */
-        lexer_set_position(token_start_line, token_start_col);
+        lexer_set_position(lx->token_start_line, lx->token_start_col);
         return token;
     }
 
     /* Number */
-    if (isdigit(ch)) {
-        int i = 0;
+    if (lx->char_class[ch] & CC_DIGIT) {
         bool has_dot = false;
         bool has_exp = false;
-        lex_buffer[i++] = ch;
+        const unsigned char *start = lx->cur - 1;
+        const unsigned char *p = lx->cur;
 
-        while ((ch = get_char()) != EOF) {
-            if (isdigit(ch)) {
-                if (i < sizeof(lex_buffer) - 1) {
-                    lex_buffer[i++] = ch;
-                }
-            } else if (ch == '.' && !has_dot && !has_exp) {
+        for (;;) {
+            while (p < lx->end && (lx->char_class[*p] & CC_DIGIT)) p++;
+            if (p < lx->end && *p == '.' && !has_dot && !has_exp) {
                 has_dot = true;
-                if (i < sizeof(lex_buffer) - 1) {
-                    lex_buffer[i++] = ch;
-                }
-            } else if ((ch == 'e' || ch == 'E') && !has_exp) {
-                /* Scientific notation */
+                p++;
+            } else if (p < lx->end && (*p == 'e' || *p == 'E') && !has_exp) {
+                /* Scientific notation, with an optional sign after 'e' */
                 has_exp = true;
-                if (i < sizeof(lex_buffer) - 1) {
-                    lex_buffer[i++] = ch;
-                }
-                /* Check for sign after 'e' */
-                int next = get_char();
-                if (next == '+' || next == '-') {
-                    if (i < sizeof(lex_buffer) - 1) {
-                        lex_buffer[i++] = next;
-                    }
-                } else {
-                    unget_char(next);
-                }
+                p++;
+                if (p < lx->end && (*p == '+' || *p == '-')) p++;
             } else {
-                unget_char(ch);
                 break;
             }
         }
-
-        lex_buffer[i] = '\0';
+        consume_plain_to(lx, p);
+        copy_token_text(lx, start, p);
 
         /* Check for imaginary suffix 'i' */
-        int next_ch = get_char();
-        if (next_ch == 'i') {
+        if (accept_char(lx, 'i')) {
             /* Imaginary number */
-            double imag_val = ael_strtod_c(lex_buffer);
+            double imag_val = ael_strtod_c(lx->buffer);
             lexer_set_real(imag_val);  /* Store coefficient */
-            printf("[ascan_lex] Token: IMAG '%si'\n", lex_buffer);
+            printf("[ascan_lex] Token: IMAG '%si'\n", lx->buffer);
             RETURN_TOKEN(TOK_IMAG);
-        } else {
-            unget_char(next_ch);
         }
 
         /* Store number value */
         if (has_dot || has_exp) {
-            lexer_set_real(ael_strtod_c(lex_buffer));
-            printf("[ascan_lex] Token: REAL '%s'\n", lex_buffer);
+            lexer_set_real(ael_strtod_c(lx->buffer));
+            printf("[ascan_lex] Token: REAL '%s'\n", lx->buffer);
             RETURN_TOKEN(TOK_REAL);
         } else {
             /* Check if integer is too large for int type */
             errno = 0;
-            long long val = strtoll(lex_buffer, NULL, 10);
+            long long val = strtoll(lx->buffer, NULL, 10);
             if (errno == ERANGE || val > INT_MAX || val < INT_MIN) {
                 /* Integer overflow - treat as real number */
-                lexer_set_real(ael_strtod_c(lex_buffer));
-                printf("[ascan_lex] Token: REAL '%s' (overflow, treated as real)\n", lex_buffer);
+                lexer_set_real(ael_strtod_c(lx->buffer));
+                printf("[ascan_lex] Token: REAL '%s' (overflow, treated as real)\n", lx->buffer);
                 RETURN_TOKEN(TOK_REAL);
             } else {
                 lexer_set_int((int)val);
-                printf("[ascan_lex] Token: INTEGER '%s'\n", lex_buffer);
+                printf("[ascan_lex] Token: INTEGER '%s'\n", lx->buffer);
                 RETURN_TOKEN(TOK_INTEGER);
             }
         }
@@ -531,26 +577,45 @@ int ascan_lex(int token_hint)
 
 void ascan_lex_init(FILE *fp)
 {
-    lex_input = fp;
-    lex_line = 1;
-    lex_col = 1;
-    lex_buf_pos = 0;
+    AelLexer *lx = cur_lexer();
+    free_input(lx);
+    lx->input = fp;
+    lx->line = 1;
+    lx->col = 1;
+}
+
+/* Scans `len` bytes at `data` in place; the caller keeps them alive until ascan_lex_reset(). */
+void ascan_lex_init_buffer(const char *data, size_t len)
+{
+    AelLexer *lx = cur_lexer();
+    free_input(lx);
+    init_char_class(lx);
+    lx->input = NULL;
+    lx->src = (unsigned char *)data;
+    lx->cur = (const unsigned char *)data;
+    lx->end = lx->cur + len;
+    lx->loaded = true;
+    lx->line = 1;
+    lx->col = 1;
 }
 
 void ascan_lex_reset(void)
 {
-    lex_input = NULL;
-    lex_line = 1;
-    lex_col = 1;
-    lex_buf_pos = 0;
+    AelLexer *lx = cur_lexer();
+    free_input(lx);
+    lx->input = NULL;
+    lx->line = 1;
+    lx->col = 1;
 }
 
 int ascan_lex_get_line(void)
 {
-    return lex_line;
+    AelLexer *lx = cur_lexer();
+    return lx->line;
 }
 
 int ascan_lex_get_col(void)
 {
-    return lex_col;
+    AelLexer *lx = cur_lexer();
+    return lx->col;
 }
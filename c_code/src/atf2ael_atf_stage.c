@@ -0,0 +1,71 @@
+/* atf2ael_atf_stage.c - serialized atf_to_ir() and temp files for the ATF stage */
+#include "atf2ael_atf_stage.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* Provided by atf2ir_c_code. */
+int atf_to_ir(const char *atf_file, const char *ir_file);
+
+#if defined(_WIN32)
+static SRWLOCK g_atf_to_ir_lock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t g_atf_to_ir_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+int atf2ael_atf_to_ir(const char *atf_file, const char *ir_file) {
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&g_atf_to_ir_lock);
+    int rc = atf_to_ir(atf_file, ir_file);
+    ReleaseSRWLockExclusive(&g_atf_to_ir_lock);
+#else
+    pthread_mutex_lock(&g_atf_to_ir_lock);
+    int rc = atf_to_ir(atf_file, ir_file);
+    pthread_mutex_unlock(&g_atf_to_ir_lock);
+#endif
+    return rc;
+}
+
+bool atf2ael_temp_file_create(const char *prefix, char *out_path, size_t cap) {
+    if (!out_path || cap == 0) return false;
+#if defined(_WIN32)
+    char tmp_dir[MAX_PATH];
+    DWORD n = GetTempPathA((DWORD)sizeof(tmp_dir), tmp_dir);
+    if (n == 0 || n >= sizeof(tmp_dir)) return false;
+    char tmp_name[MAX_PATH];
+    if (GetTempFileNameA(tmp_dir, prefix, 0, tmp_name) == 0) return false;
+    /* FILE_ATTRIBUTE_TEMPORARY survives the truncating reopen inside atf_to_ir(). */
+    SetFileAttributesA(tmp_name, FILE_ATTRIBUTE_TEMPORARY);
+    if (strlen(tmp_name) >= cap) {
+        DeleteFileA(tmp_name);
+        return false;
+    }
+    strcpy(out_path, tmp_name);
+    return true;
+#else
+    const char *dir = getenv("TMPDIR");
+    if (!dir || !dir[0]) dir = "/tmp";
+    int n = snprintf(out_path, cap, "%s/%sXXXXXX", dir, prefix);
+    if (n < 0 || (size_t)n >= cap) return false;
+    int fd = mkstemp(out_path);
+    if (fd < 0) return false;
+    close(fd);
+    return true;
+#endif
+}
+
+void atf2ael_temp_file_remove(const char *path) {
+#if defined(_WIN32)
+    DeleteFileA(path);
+#else
+    remove(path);
+#endif
+}
@@ -0,0 +1,650 @@
+/* atf2ael_cache.c - content-addressed on-disk cache of atf2ael conversions */
+#include "atf2ael_cache.h"
+#include "ir_text_parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define CACHE_PATH_CAP (MAX_PATH * 4)
+#define CACHE_SEP "\\"
+#define CACHE_TICKS_PER_SEC 10000000ull /* FILETIME units */
+#define CACHE_ADD(p, v) InterlockedExchangeAdd64((volatile LONG64 *)(p), (LONG64)(v))
+#define CACHE_LOAD(p) InterlockedCompareExchange64((volatile LONG64 *)(p), 0, 0)
+#define CACHE_STORE(p, v) InterlockedExchange64((volatile LONG64 *)(p), (LONG64)(v))
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+#define CACHE_PATH_CAP 4096
+#define CACHE_SEP "/"
+#define CACHE_TICKS_PER_SEC 1ull /* st_mtime units */
+#define CACHE_ADD(p, v) __atomic_fetch_add((p), (long long)(v), __ATOMIC_RELAXED)
+#define CACHE_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define CACHE_STORE(p, v) __atomic_store_n((p), (long long)(v), __ATOMIC_RELAXED)
+#endif
+
+/* Temp files left behind by a crashed worker are swept once they are this old. */
+#define CACHE_STALE_TMP_SECS 3600ull
+#define CACHE_COPY_CHUNK (64 * 1024)
+/* Room left after the cache dir for "<sep><xx><sep><key><ext>.<pid>.<seq>.tmp" or a listed file name. */
+#define CACHE_DIR_CAP (CACHE_PATH_CAP - 512)
+
+struct Atf2AelCache {
+    char dir[CACHE_DIR_CAP];
+    uint64_t max_bytes;
+    uint64_t binary_hash;         /* XXH64 of the running executable */
+    long long hits;
+    long long misses;
+    long long stores;
+    long long store_failures;
+    long long evictions;
+    long long evicted_bytes;
+    long long bytes_in_use;
+    long long tmp_seq;
+#if defined(_WIN32)
+    SRWLOCK evict_lock;
+#else
+    pthread_mutex_t evict_lock;
+#endif
+};
+
+static const char *const k_kind_ext[] = {".ael", ".ir.txt"};
+
+/* ---- Hash (XXH64) ---- */
+
+#define XXH_P1 0x9E3779B185EBCA87ull
+#define XXH_P2 0xC2B2AE3D27D4EB4Full
+#define XXH_P3 0x165667B19E3779F9ull
+#define XXH_P4 0x85EBCA77C2B2AE63ull
+#define XXH_P5 0x27D4EB2F165667C5ull
+
+static uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_P2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_P1;
+}
+
+static uint64_t xxh_merge(uint64_t acc, uint64_t val) {
+    acc ^= xxh_round(0, val);
+    return acc * XXH_P1 + XXH_P4;
+}
+
+static uint64_t xxh64(const void *data, size_t len, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        const unsigned char *limit = end - 32;
+        uint64_t v1 = seed + XXH_P1 + XXH_P2;
+        uint64_t v2 = seed + XXH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_P1;
+        do {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = seed + XXH_P5;
+    }
+    h += (uint64_t)len;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxh_round(0, read64(p));
+        h = rotl64(h, 27) * XXH_P1 + XXH_P4;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * XXH_P1;
+        h = rotl64(h, 23) * XXH_P2 + XXH_P3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (uint64_t)(*p) * XXH_P5;
+        h = rotl64(h, 11) * XXH_P1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_P2;
+    h ^= h >> 29;
+    h *= XXH_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+/* ---- Platform file helpers ---- */
+
+static bool make_dir(const char *path) {
+#if defined(_WIN32)
+    if (CreateDirectoryA(path, NULL)) return true;
+    DWORD attrs = GetFileAttributesA(path);
+    return attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    if (mkdir(path, 0777) == 0) return true;
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+static bool file_exists(const char *path) {
+#if defined(_WIN32)
+    DWORD attrs = GetFileAttributesA(path);
+    return attrs != INVALID_FILE_ATTRIBUTES && !(attrs & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+#endif
+}
+
+static bool remove_file(const char *path) {
+#if defined(_WIN32)
+    return DeleteFileA(path) != 0;
+#else
+    return remove(path) == 0;
+#endif
+}
+
+/* Atomically replaces dst with src (same directory). */
+static bool publish_file(const char *src, const char *dst) {
+#if defined(_WIN32)
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(src, dst) == 0;
+#endif
+}
+
+static uint64_t now_ticks(void) {
+#if defined(_WIN32)
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    return ((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+#else
+    return (uint64_t)time(NULL);
+#endif
+}
+
+static unsigned long process_id(void) {
+#if defined(_WIN32)
+    return (unsigned long)GetCurrentProcessId();
+#else
+    return (unsigned long)getpid();
+#endif
+}
+
+/*
+ * A cache file opened for reading. Entries are opened with delete sharing on Windows so a
+ * concurrent eviction or republish of the same key is never blocked by a reader.
+ */
+typedef struct CacheReader {
+#if defined(_WIN32)
+    HANDLE h;
+#else
+    FILE *fp;
+#endif
+} CacheReader;
+
+/* Opens path; with touch, also marks it most recently used. */
+static bool reader_open(CacheReader *r, const char *path, bool touch) {
+#if defined(_WIN32)
+    r->h = CreateFileA(path, GENERIC_READ | (touch ? FILE_WRITE_ATTRIBUTES : 0),
+                       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                       FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (r->h == INVALID_HANDLE_VALUE) return false;
+    if (touch) {
+        FILETIME ft;
+        GetSystemTimeAsFileTime(&ft);
+        SetFileTime(r->h, NULL, NULL, &ft);
+    }
+    return true;
+#else
+    r->fp = fopen(path, "rb");
+    if (!r->fp) return false;
+    if (touch) utime(path, NULL);
+    return true;
+#endif
+}
+
+static size_t reader_read(CacheReader *r, void *buf, size_t cap, bool *ok) {
+#if defined(_WIN32)
+    DWORD got = 0;
+    if (!ReadFile(r->h, buf, (DWORD)cap, &got, NULL)) *ok = false;
+    return (size_t)got;
+#else
+    size_t got = fread(buf, 1, cap, r->fp);
+    if (got < cap && ferror(r->fp)) *ok = false;
+    return got;
+#endif
+}
+
+static void reader_close(CacheReader *r) {
+#if defined(_WIN32)
+    if (r->h != INVALID_HANDLE_VALUE) CloseHandle(r->h);
+    r->h = INVALID_HANDLE_VALUE;
+#else
+    if (r->fp) fclose(r->fp);
+    r->fp = NULL;
+#endif
+}
+
+/* Drains r into dst_path. */
+static bool copy_reader_to(CacheReader *r, const char *dst_path, uint64_t *copied) {
+    FILE *out = fopen(dst_path, "wb");
+    if (!out) return false;
+    char *buf = (char *)malloc(CACHE_COPY_CHUNK);
+    bool ok = buf != NULL;
+    uint64_t total = 0;
+    while (ok) {
+        size_t got = reader_read(r, buf, CACHE_COPY_CHUNK, &ok);
+        if (!ok || got == 0) break;
+        if (fwrite(buf, 1, got, out) != got) ok = false;
+        total += got;
+    }
+    free(buf);
+    if (fclose(out) != 0) ok = false;
+    if (copied) *copied = total;
+    return ok;
+}
+
+/* ---- Eviction ---- */
+
+typedef struct CacheFileInfo {
+    char rel[48]; /* "<xx><sep><key><ext>" */
+    uint64_t size;
+    uint64_t mtime;
+} CacheFileInfo;
+
+typedef struct CacheListing {
+    CacheFileInfo *files;
+    size_t count;
+    size_t cap;
+    uint64_t total;
+} CacheListing;
+
+static bool is_fanout_dir(const char *name) {
+    return strlen(name) == 2 && strchr("0123456789abcdef", name[0]) && strchr("0123456789abcdef", name[1]);
+}
+
+static bool has_suffix(const char *s, const char *suffix) {
+    size_t n = strlen(s);
+    size_t m = strlen(suffix);
+    return n >= m && strcmp(s + (n - m), suffix) == 0;
+}
+
+/* Records one file of fan-out dir sub; temp files are swept if stale and never counted. */
+static void listing_add(Atf2AelCache *c, CacheListing *l, const char *sub, const char *name, uint64_t size,
+                        uint64_t mtime, uint64_t now) {
+    if (has_suffix(name, ".tmp")) {
+        if (now > mtime && now - mtime > CACHE_STALE_TMP_SECS * CACHE_TICKS_PER_SEC) {
+            char path[CACHE_PATH_CAP];
+            snprintf(path, sizeof(path), "%s" CACHE_SEP "%s" CACHE_SEP "%s", c->dir, sub, name);
+            remove_file(path);
+        }
+        return;
+    }
+    if (strlen(sub) + strlen(name) + 2 > sizeof(l->files[0].rel)) return; /* not one of ours */
+    if (l->count == l->cap) {
+        size_t ncap = l->cap ? l->cap * 2 : 1024;
+        CacheFileInfo *nf = (CacheFileInfo *)realloc(l->files, ncap * sizeof(*nf));
+        if (!nf) return;
+        l->files = nf;
+        l->cap = ncap;
+    }
+    CacheFileInfo *f = &l->files[l->count++];
+    snprintf(f->rel, sizeof(f->rel), "%s" CACHE_SEP "%s", sub, name);
+    f->size = size;
+    f->mtime = mtime;
+    l->total += size;
+}
+
+static void list_fanout_dir(Atf2AelCache *c, CacheListing *l, const char *sub, uint64_t now) {
+    char path[CACHE_DIR_CAP + 8];
+#if defined(_WIN32)
+    snprintf(path, sizeof(path), "%s\\%s\\*", c->dir, sub);
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(path, &fd);
+    if (h == INVALID_HANDLE_VALUE) return;
+    do {
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        uint64_t size = ((uint64_t)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+        uint64_t mtime = ((uint64_t)fd.ftLastWriteTime.dwHighDateTime << 32) | fd.ftLastWriteTime.dwLowDateTime;
+        listing_add(c, l, sub, fd.cFileName, size, mtime, now);
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    snprintf(path, sizeof(path), "%s/%s", c->dir, sub);
+    DIR *d = opendir(path);
+    if (!d) return;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        char file[CACHE_PATH_CAP];
+        struct stat st;
+        snprintf(file, sizeof(file), "%s/%s", path, de->d_name);
+        if (stat(file, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        listing_add(c, l, sub, de->d_name, (uint64_t)st.st_size, (uint64_t)st.st_mtime, now);
+    }
+    closedir(d);
+#endif
+}
+
+static void list_cache(Atf2AelCache *c, CacheListing *l) {
+    uint64_t now = now_ticks();
+#if defined(_WIN32)
+    char pattern[CACHE_PATH_CAP];
+    snprintf(pattern, sizeof(pattern), "%s\\*", c->dir);
+    WIN32_FIND_DATAA fd;
+    HANDLE h = FindFirstFileA(pattern, &fd);
+    if (h == INVALID_HANDLE_VALUE) return;
+    do {
+        if ((fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && is_fanout_dir(fd.cFileName)) {
+            list_fanout_dir(c, l, fd.cFileName, now);
+        }
+    } while (FindNextFileA(h, &fd));
+    FindClose(h);
+#else
+    DIR *d = opendir(c->dir);
+    if (!d) return;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (is_fanout_dir(de->d_name)) list_fanout_dir(c, l, de->d_name, now);
+    }
+    closedir(d);
+#endif
+}
+
+static int cmp_mtime(const void *a, const void *b) {
+    const CacheFileInfo *fa = (const CacheFileInfo *)a;
+    const CacheFileInfo *fb = (const CacheFileInfo *)b;
+    if (fa->mtime != fb->mtime) return fa->mtime < fb->mtime ? -1 : 1;
+    return strcmp(fa->rel, fb->rel);
+}
+
+static bool try_lock_evict(Atf2AelCache *c) {
+#if defined(_WIN32)
+    return TryAcquireSRWLockExclusive(&c->evict_lock) != 0;
+#else
+    return pthread_mutex_trylock(&c->evict_lock) == 0;
+#endif
+}
+
+static void unlock_evict(Atf2AelCache *c) {
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&c->evict_lock);
+#else
+    pthread_mutex_unlock(&c->evict_lock);
+#endif
+}
+
+/*
+ * Re-sizes the directory from disk and, if it is over the bound, removes least recently used
+ * files down to 90% of it. One thread per process runs a pass at a time; others just skip, since
+ * the pass in flight will account for their stores. Other processes may evict concurrently: a
+ * failed delete is simply not counted.
+ */
+static void cache_evict(Atf2AelCache *c) {
+    if (!try_lock_evict(c)) return;
+
+    CacheListing l;
+    memset(&l, 0, sizeof(l));
+    list_cache(c, &l);
+
+    if (c->max_bytes && l.total > c->max_bytes) {
+        uint64_t target = c->max_bytes / 10 * 9;
+        qsort(l.files, l.count, sizeof(*l.files), cmp_mtime);
+        for (size_t k = 0; k < l.count && l.total > target; k++) {
+            char path[CACHE_PATH_CAP];
+            snprintf(path, sizeof(path), "%s" CACHE_SEP "%s", c->dir, l.files[k].rel);
+            if (!remove_file(path)) continue;
+            l.total -= l.files[k].size;
+            CACHE_ADD(&c->evictions, 1);
+            CACHE_ADD(&c->evicted_bytes, l.files[k].size);
+        }
+    }
+    CACHE_STORE(&c->bytes_in_use, l.total);
+    free(l.files);
+    unlock_evict(c);
+}
+
+/* Hashes the running executable: any rebuild of the converter gets its own keys. */
+static bool hash_own_binary(uint64_t *out, char *err, size_t err_cap) {
+#if defined(_WIN32)
+    char path[CACHE_PATH_CAP];
+    DWORD n = GetModuleFileNameA(NULL, path, (DWORD)sizeof(path));
+    if (n == 0 || n >= sizeof(path)) {
+        if (err && err_cap) snprintf(err, err_cap, "Cannot locate the converter executable");
+        return false;
+    }
+#else
+    const char *path = "/proc/self/exe";
+#endif
+    char detail[512];
+    IRFileView view;
+    if (!ir_file_view_open(path, &view, detail, sizeof(detail))) {
+        if (err && err_cap) snprintf(err, err_cap, "Cannot hash the converter executable: %s", detail);
+        return false;
+    }
+    *out = xxh64(view.data, view.len, 0);
+    ir_file_view_close(&view);
+    return true;
+}
+
+/* ---- Public API ---- */
+
+Atf2AelCache *atf2ael_cache_open(const char *dir, uint64_t max_bytes, char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (!dir || !dir[0]) {
+        if (err && err_cap) snprintf(err, err_cap, "invalid argument");
+        return NULL;
+    }
+    size_t n = strlen(dir);
+    while (n > 1 && (dir[n - 1] == '/' || dir[n - 1] == '\\')) n--;
+    if (n >= CACHE_DIR_CAP) {
+        if (err && err_cap) snprintf(err, err_cap, "Cache path too long: %s", dir);
+        return NULL;
+    }
+
+    Atf2AelCache *c = (Atf2AelCache *)calloc(1, sizeof(*c));
+    if (!c) {
+        if (err && err_cap) snprintf(err, err_cap, "out of memory");
+        return NULL;
+    }
+    if (!hash_own_binary(&c->binary_hash, err, err_cap)) {
+        free(c);
+        return NULL;
+    }
+    memcpy(c->dir, dir, n);
+    c->dir[n] = '\0';
+    c->max_bytes = max_bytes;
+#if defined(_WIN32)
+    InitializeSRWLock(&c->evict_lock);
+#else
+    pthread_mutex_init(&c->evict_lock, NULL);
+#endif
+
+    /* Create every missing component, as make_parent_dirs does for outputs. */
+    char tmp[CACHE_DIR_CAP];
+    memcpy(tmp, c->dir, n + 1);
+    for (char *p = tmp + 1; *p; p++) {
+        if (*p != '/' && *p != '\\') continue;
+        char ch = *p;
+        *p = '\0';
+        make_dir(tmp);
+        *p = ch;
+    }
+    if (!make_dir(tmp)) {
+        if (err && err_cap) snprintf(err, err_cap, "Cannot create cache directory: %s", c->dir);
+        atf2ael_cache_close(c);
+        return NULL;
+    }
+
+    cache_evict(c);
+    return c;
+}
+
+void atf2ael_cache_close(Atf2AelCache *cache) {
+    if (!cache) return;
+#if !defined(_WIN32)
+    pthread_mutex_destroy(&cache->evict_lock);
+#endif
+    free(cache);
+}
+
+bool atf2ael_cache_key_file(const Atf2AelCache *cache, const char *atf_path, bool strict_pos, bool allow_scope_blocks,
+                            Atf2AelCacheKey *key, char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (!cache || !atf_path || !key) {
+        if (err && err_cap) snprintf(err, err_cap, "invalid argument");
+        return false;
+    }
+    key->name[0] = '\0';
+
+    char salt[128];
+    int salt_len = snprintf(salt, sizeof(salt), "atf2ael-%016llx|strict_pos=%d|allow_scope_blocks=%d",
+                            (unsigned long long)cache->binary_hash, strict_pos ? 1 : 0, allow_scope_blocks ? 1 : 0);
+    uint64_t seed = xxh64(salt, (size_t)salt_len, 0);
+
+    char detail[512];
+    IRFileView view;
+    if (!ir_file_view_open(atf_path, &view, detail, sizeof(detail))) {
+        if (err && err_cap) snprintf(err, err_cap, "ATF read failed: %s", detail);
+        return false;
+    }
+    uint64_t h = xxh64(view.data, view.len, seed);
+    snprintf(key->name, sizeof(key->name), "%016llx-%llx", (unsigned long long)h, (unsigned long long)view.len);
+    ir_file_view_close(&view);
+    return true;
+}
+
+static bool entry_path(const Atf2AelCache *c, const Atf2AelCacheKey *key, Atf2AelCacheKind kind, char *out,
+                       size_t cap) {
+    int n = snprintf(out, cap, "%s" CACHE_SEP "%.2s" CACHE_SEP "%s%s", c->dir, key->name, key->name,
+                     k_kind_ext[kind]);
+    return n > 0 && (size_t)n < cap;
+}
+
+bool atf2ael_cache_lookup(Atf2AelCache *cache, const Atf2AelCacheKey *key, const char *out_ael, const char *out_ir) {
+    if (!cache || !key || !key->name[0] || !out_ael) return false;
+
+    char ael_path[CACHE_PATH_CAP];
+    char ir_path[CACHE_PATH_CAP];
+    CacheReader ael_r;
+    CacheReader ir_r;
+    bool need_ir = out_ir != NULL;
+    bool ok = entry_path(cache, key, ATF2AEL_CACHE_AEL, ael_path, sizeof(ael_path)) &&
+              entry_path(cache, key, ATF2AEL_CACHE_IR, ir_path, sizeof(ir_path));
+
+    /* Open every requested part before writing anything, so a partial entry is a clean miss. */
+    bool ael_open = ok && reader_open(&ael_r, ael_path, true);
+    bool ir_open = ael_open && need_ir && reader_open(&ir_r, ir_path, true);
+    ok = ael_open && (!need_ir || ir_open);
+
+    if (ok) ok = copy_reader_to(&ael_r, out_ael, NULL);
+    if (ok && need_ir) ok = copy_reader_to(&ir_r, out_ir, NULL);
+    if (ael_open) reader_close(&ael_r);
+    if (ir_open) reader_close(&ir_r);
+
+    CACHE_ADD(ok ? &cache->hits : &cache->misses, 1);
+    return ok;
+}
+
+/* Writes a part through a unique temp file in the entry's fan-out dir and renames it into place. */
+static bool store_part(Atf2AelCache *c, const Atf2AelCacheKey *key, Atf2AelCacheKind kind, const char *src_path,
+                       const void *data, size_t n) {
+    if (!c || !key || !key->name[0]) return false;
+
+    char final_path[CACHE_DIR_CAP + 64];
+    char tmp_path[CACHE_PATH_CAP];
+    char sub[CACHE_PATH_CAP];
+    snprintf(sub, sizeof(sub), "%s" CACHE_SEP "%.2s", c->dir, key->name);
+    if (!entry_path(c, key, kind, final_path, sizeof(final_path)) || !make_dir(sub)) {
+        CACHE_ADD(&c->store_failures, 1);
+        return false;
+    }
+    /* Same key means same bytes: whoever published first wins. */
+    if (file_exists(final_path)) return true;
+
+    long long seq = CACHE_ADD(&c->tmp_seq, 1);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%lu.%lld.tmp", final_path, process_id(), seq);
+
+    uint64_t written = 0;
+    bool ok;
+    if (src_path) {
+        CacheReader r;
+        ok = reader_open(&r, src_path, false);
+        if (ok) {
+            ok = copy_reader_to(&r, tmp_path, &written);
+            reader_close(&r);
+        }
+    } else {
+        FILE *fp = fopen(tmp_path, "wb");
+        ok = fp != NULL;
+        if (ok) {
+            ok = n == 0 || fwrite(data, 1, n, fp) == n;
+            if (fclose(fp) != 0) ok = false;
+            written = n;
+        }
+    }
+    if (ok) ok = publish_file(tmp_path, final_path);
+    if (!ok) {
+        remove_file(tmp_path);
+        CACHE_ADD(&c->store_failures, 1);
+        return false;
+    }
+
+    CACHE_ADD(&c->stores, 1);
+    long long in_use = CACHE_ADD(&c->bytes_in_use, written) + (long long)written;
+    if (c->max_bytes && (uint64_t)in_use > c->max_bytes) cache_evict(c);
+    return true;
+}
+
+bool atf2ael_cache_store_file(Atf2AelCache *cache, const Atf2AelCacheKey *key, Atf2AelCacheKind kind,
+                              const char *src_path) {
+    if (!src_path) return false;
+    return store_part(cache, key, kind, src_path, NULL, 0);
+}
+
+bool atf2ael_cache_store_bytes(Atf2AelCache *cache, const Atf2AelCacheKey *key, Atf2AelCacheKind kind,
+                               const void *data, size_t n) {
+    if (!data && n) return false;
+    return store_part(cache, key, kind, NULL, data, n);
+}
+
+void atf2ael_cache_get_stats(Atf2AelCache *cache, Atf2AelCacheStats *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!cache) return;
+    out->hits = (uint64_t)CACHE_LOAD(&cache->hits);
+    out->misses = (uint64_t)CACHE_LOAD(&cache->misses);
+    out->stores = (uint64_t)CACHE_LOAD(&cache->stores);
+    out->store_failures = (uint64_t)CACHE_LOAD(&cache->store_failures);
+    out->evictions = (uint64_t)CACHE_LOAD(&cache->evictions);
+    out->evicted_bytes = (uint64_t)CACHE_LOAD(&cache->evicted_bytes);
+    out->bytes_in_use = (uint64_t)CACHE_LOAD(&cache->bytes_in_use);
+}
@@ -0,0 +1,137 @@
+/* atf2ael_lib.c - buffer-to-sink conversion entry points with explicit contexts */
+#include "atf2ael_lib.h"
+#include "ael_compiler_internal.h"
+#include "ael_emit.h"
+#include "ir2ael_convert.h"
+#include "ir_binary.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Atf2AelContext {
+    Atf2AelOptions opts;
+    AelCompiler compiler;         /* reused by every ael_compile_buffer call on this context */
+};
+
+Atf2AelContext *atf2ael_context_create(const Atf2AelOptions *opts) {
+    Atf2AelContext *ctx = (Atf2AelContext *)malloc(sizeof(*ctx));
+    if (!ctx) return NULL;
+    if (opts) {
+        ctx->opts = *opts;
+    } else {
+        ctx->opts.strict_pos = false;
+        ctx->opts.allow_scope_blocks = false;
+        ctx->opts.jobs = 1;
+    }
+    ael_compiler_init(&ctx->compiler);
+    return ctx;
+}
+
+void atf2ael_context_destroy(Atf2AelContext *ctx) {
+    if (!ctx) return;
+    ael_compiler_release(&ctx->compiler);
+    free(ctx);
+}
+
+void atf2ael_buffer_init(Atf2AelBuffer *buf) {
+    if (!buf) return;
+    memset(buf, 0, sizeof(*buf));
+}
+
+bool atf2ael_buffer_sink(void *buf, const char *data, size_t len) {
+    Atf2AelBuffer *b = (Atf2AelBuffer *)buf;
+    if (!b) return false;
+    if (len > b->cap - b->len) {
+        size_t ncap = b->cap ? b->cap : 4096;
+        while (ncap - b->len < len) {
+            if (ncap > (size_t)-1 / 2) return false;
+            ncap *= 2;
+        }
+        char *nd = (char *)realloc(b->data, ncap);
+        if (!nd) return false;
+        b->data = nd;
+        b->cap = ncap;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    return true;
+}
+
+void atf2ael_buffer_free(Atf2AelBuffer *buf) {
+    if (!buf) return;
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+}
+
+bool ir2ael_convert_program_to_sink(Atf2AelContext *ctx, const IRProgram *program, Atf2AelSinkFn sink,
+                                    void *sink_ctx, char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (!ctx || !program || !sink) {
+        if (err && err_cap) snprintf(err, err_cap, "invalid argument");
+        return false;
+    }
+
+    AelEmitter emitter;
+    if (!ael_emit_init_sink(&emitter, sink, sink_ctx, ctx->opts.strict_pos)) {
+        if (err && err_cap) snprintf(err, err_cap, "out of memory");
+        return false;
+    }
+    emitter.allow_num_local_scope_blocks = ctx->opts.allow_scope_blocks;
+
+    Ir2AelConvertOptions conv_opt;
+    conv_opt.jobs = ctx->opts.jobs;
+
+    char detail[512];
+    bool ok = ir2ael_convert_program_ex(program, &emitter, &conv_opt, detail, sizeof(detail));
+    ael_emit_free(&emitter);
+    if (!ok && err && err_cap) snprintf(err, err_cap, "Convert failed: %s", detail);
+    return ok;
+}
+
+bool ir2ael_convert_buffer(Atf2AelContext *ctx, const void *ir, size_t n, Atf2AelSinkFn sink, void *sink_ctx,
+                           char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (!ctx || (!ir && n) || !sink) {
+        if (err && err_cap) snprintf(err, err_cap, "invalid argument");
+        return false;
+    }
+
+    char detail[512];
+    IRProgram program;
+    if (!ir_program_init(&program)) {
+        if (err && err_cap) snprintf(err, err_cap, "out of memory");
+        return false;
+    }
+    bool parse_ok = ir_binary_detect(ir, n) ?
+                    ir_binary_load_buffer(ir, n, &program, detail, sizeof(detail)) :
+                    ir_parse_buffer((const char *)ir, n, &program, detail, sizeof(detail));
+    if (!parse_ok) {
+        if (err && err_cap) snprintf(err, err_cap, "IR parse failed: %s", detail);
+        ir_program_free(&program);
+        return false;
+    }
+    bool ok = ir2ael_convert_program_to_sink(ctx, &program, sink, sink_ctx, err, err_cap);
+    ir_program_free(&program);
+    return ok;
+}
+
+bool ael_compile_buffer(Atf2AelContext *ctx, const char *ael, size_t n, Atf2AelSinkFn sink, void *sink_ctx,
+                        char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (!ctx || (!ael && n) || !sink) {
+        if (err && err_cap) snprintf(err, err_cap, "invalid argument");
+        return false;
+    }
+    if (!ael_compiler_parse_buffer(&ctx->compiler, ael, n)) {
+        if (err && err_cap) snprintf(err, err_cap, "AEL parse failed: %s", ael_compiler_error(&ctx->compiler));
+        return false;
+    }
+    if (!ael_compiler_write_ir_sink(&ctx->compiler, sink, sink_ctx)) {
+        if (err && err_cap) snprintf(err, err_cap, "IR write failed");
+        return false;
+    }
+    return true;
+}
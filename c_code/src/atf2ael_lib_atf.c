@@ -0,0 +1,73 @@
+/* atf2ael_lib_atf.c - ATF stage of libatf2ael (needs atf2ir_c_code linked in) */
+#include "atf2ael_lib.h"
+#include "atf2ael_atf_stage.h"
+
+#include <stdio.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define ATF_PATH_CAP (MAX_PATH * 4)
+#else
+#define ATF_PATH_CAP 4096
+#endif
+
+static bool write_whole_file(const char *path, const void *data, size_t n) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return false;
+    bool ok = n == 0 || fwrite(data, 1, n, fp) == n;
+    if (fclose(fp) != 0) ok = false;
+    return ok;
+}
+
+/*
+ * The ATF bytes are staged in a temp file for atf_to_ir() (see atf2ael_atf_stage.h). The temp files
+ * are removed before returning, the IR file once its view is unmapped.
+ */
+bool atf2ael_convert_buffer(Atf2AelContext *ctx, const void *atf, size_t n, Atf2AelSinkFn sink, void *sink_ctx,
+                            char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (!ctx || (!atf && n) || !sink) {
+        if (err && err_cap) snprintf(err, err_cap, "invalid argument");
+        return false;
+    }
+
+    char atf_path[ATF_PATH_CAP];
+    char ir_path[ATF_PATH_CAP];
+    if (!atf2ael_temp_file_create("atf", atf_path, sizeof(atf_path))) {
+        if (err && err_cap) snprintf(err, err_cap, "Failed to create temp ATF file.");
+        return false;
+    }
+    if (!atf2ael_temp_file_create("air", ir_path, sizeof(ir_path))) {
+        atf2ael_temp_file_remove(atf_path);
+        if (err && err_cap) snprintf(err, err_cap, "Failed to create temp IR file.");
+        return false;
+    }
+    if (!write_whole_file(atf_path, atf, n)) {
+        atf2ael_temp_file_remove(atf_path);
+        atf2ael_temp_file_remove(ir_path);
+        if (err && err_cap) snprintf(err, err_cap, "Failed to write temp ATF file.");
+        return false;
+    }
+
+    int rc = atf2ael_atf_to_ir(atf_path, ir_path);
+    atf2ael_temp_file_remove(atf_path);
+    if (rc != 0) {
+        atf2ael_temp_file_remove(ir_path);
+        if (err && err_cap) snprintf(err, err_cap, "ATF->IR failed (rc=%d)", rc);
+        return false;
+    }
+
+    char detail[512];
+    IRFileView view;
+    if (!ir_file_view_open(ir_path, &view, detail, sizeof(detail))) {
+        atf2ael_temp_file_remove(ir_path);
+        if (err && err_cap) snprintf(err, err_cap, "IR read failed: %s", detail);
+        return false;
+    }
+
+    bool ok = ir2ael_convert_buffer(ctx, view.data, view.len, sink, sink_ctx, err, err_cap);
+    ir_file_view_close(&view);
+    /* Windows refuses to delete a file while a view of it is mapped, so this waits for the close. */
+    atf2ael_temp_file_remove(ir_path);
+    return ok;
+}
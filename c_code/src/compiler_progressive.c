@@ -44,11 +44,6 @@ static int ascan_state_6 = 0;  // dword_180080258
  * 编译器全局状态变量 (从反编译代码提取)
  * ======================================== */
 
-/* 编译器状态 - 从 ir_generator.h 引用 */
-extern int AcompDepth;         // 已在 ir_generator.c 中定义
-extern int AcompInteract;      // 已在 ir_generator.c 中定义
-extern int AerrFlag;           // 已在 ir_generator.c 中定义
-
 /* 编译器额外状态 */
 int ArrayDimMax = 0;        // 数组维度最大值 (exported to yacc_parser.c)
 int ArrayDimStart = 0;      // 数组维度起始 (exported to yacc_parser.c)
@@ -6,7 +6,47 @@
 #include <string.h>
 #include <ctype.h>
 
+Ir2AelStatus ir2ael_convert_inst(Ir2AelState *s, size_t *i) {
+    if (!s || !i || *i >= s->program->count) return IR2AEL_STATUS_FAIL;
+    const IRInst *inst = &s->program->insts[*i];
+
+    /* No Expr outlives the expression stack, so an empty stack means the arena is free. */
+    if (s->stack_len == 0) expr_arena_reset(&s->expr_arena);
+    Ir2AelStatus rc = ir2ael_preprocess_inst(s, *i, inst);
+    if (rc < 0) return rc;
+
+    rc = ir2ael_dispatch_inst(s, i, inst);
+    if (rc != IR2AEL_STATUS_NOT_HANDLED) return rc;
+
+    /* If we have a pending decl group with no initializer, emit it before moving on. */
+    if (s->pending_decls.count > 0) {
+        int decl_line0 = s->out->line0;
+        int decl_col0 = 0;
+        if (s->pending_decls.is_local && (s->in_function || s->pending_defun) && s->current_defun_line0 >= 0) {
+            if (s->pending_decls.depth <= 1) {
+                decl_line0 = s->current_defun_line0 + 2;
+            }
+            decl_col0 = decl_indent_col0_from_depth(s->pending_decls.depth > 0 ? s->pending_decls.depth : 1);
+        }
+        if (!decl_group_emit_and_track(s->out, &s->pending_decls, decl_line0, decl_col0, &s->local_init)) {
+            return IR2AEL_STATUS_FAIL_EMIT;
+        }
+        decl_group_clear(&s->pending_decls);
+    }
+
+    /* Ignore DEPTH, comments already filtered; anything else is unsupported in M1/M2 subset. */
+    if (s->err && s->err_cap) {
+        snprintf(s->err, s->err_cap, "unsupported opcode OP=%d at IR index %zu", inst->op, *i);
+    }
+    return IR2AEL_STATUS_FAIL;
+}
+
 bool ir2ael_convert_program(const IRProgram *program, AelEmitter *out, char *err, size_t err_cap) {
+    return ir2ael_convert_program_ex(program, out, NULL, err, err_cap);
+}
+
+bool ir2ael_convert_program_ex(const IRProgram *program, AelEmitter *out, const Ir2AelConvertOptions *opts,
+                               char *err, size_t err_cap) {
     if (err && err_cap) err[0] = '\0';
     if (!program || !out) return false;
 
@@ -14,95 +54,71 @@ bool ir2ael_convert_program(const IRProgram *program, AelEmitter *out, char *err
     ir2ael_state_init(&st, program, out, err, err_cap);
     Ir2AelStatus rc = IR2AEL_STATUS_NOT_HANDLED;
 
+    Ir2AelParallel par;
+    memset(&par, 0, sizeof(par));
+    int jobs = opts ? opts->jobs : 1;
+    if (jobs != 1) (void)ir2ael_parallel_prepare(&par, &st, jobs);
+
     size_t i = 0;
     const IRInst *inst = NULL;
     for (; i < program->count; i++) {
         inst = &program->insts[i];
-        rc = ir2ael_preprocess_inst(&st, i, inst);
-        if (rc < 0) goto fail_by_rc;
-
-        rc = ir2ael_handle_function_ops(&st, i, inst);
-        if (rc < 0) goto fail_by_rc;
-        if (rc > 0) continue;
-
-        rc = ir2ael_handle_decl_ops(&st, inst);
-        if (rc < 0) goto fail_by_rc;
-        if (rc > 0) continue;
-
-        rc = ir2ael_handle_scope_ops(&st, &i, inst);
-        if (rc < 0) goto fail_by_rc;
-        if (rc > 0) continue;
-
-        rc = ir2ael_handle_load_ops(&st, inst);
-        if (rc < 0) goto fail_by_rc;
-        if (rc > 0) continue;
-
-        rc = ir2ael_handle_flow_ops(&st, &i, inst);
-        if (rc < 0) goto fail_by_rc;
-        if (rc > 0) continue;
-
-        rc = ir2ael_handle_expr_ops(&st, &i, inst);
-        if (rc < 0) goto fail_by_rc;
-        if (rc > 0) continue;
-
-        /* If we have a pending decl group with no initializer, emit it before moving on. */
-        if (st.pending_decls.count > 0) {
-            int decl_line0 = out->line0;
-            int decl_col0 = 0;
-            if (st.pending_decls.is_local && (st.in_function || st.pending_defun) && st.current_defun_line0 >= 0) {
-                if (st.pending_decls.depth <= 1) {
-                    decl_line0 = st.current_defun_line0 + 2;
-                }
-                decl_col0 = decl_indent_col0_from_depth(st.pending_decls.depth > 0 ? st.pending_decls.depth : 1);
-            }
-            if (!decl_group_emit_and_track(out, &st.pending_decls, decl_line0, decl_col0, &st.local_init)) goto fail_emit;
-            decl_group_clear(&st.pending_decls);
+        /* A top-level function converted ahead of time is spliced in (see ir2ael_parallel_splice). */
+        if (par.count > 0 && inst->op == OP_BEGIN_FUNCT && ir2ael_state_is_quiescent(&st)) {
+            rc = ir2ael_parallel_splice(&st, &par, &i);
+            if (rc < 0) goto fail_by_rc;
+            if (rc > 0) continue;
         }
-
-        /* Ignore DEPTH, comments already filtered; anything else is unsupported in M1/M2 subset. */
-        if (err && err_cap) snprintf(err, err_cap, "unsupported opcode OP=%d at IR index %zu", inst->op, i);
-        goto fail;
+        rc = ir2ael_convert_inst(&st, &i);
+        if (rc < 0) goto fail_by_rc;
     }
+    ir2ael_parallel_free(&par);
 
     rc = ir2ael_finalize(&st);
     if (rc < 0) goto fail_by_rc;
     ir2ael_state_free(&st);
+    if (!ael_emit_flush(out)) {
+        if (err && err_cap) snprintf(err, err_cap, "emit failed while flushing output (io)");
+        return false;
+    }
     return true;
 
 fail_by_rc:
-    if (rc == IR2AEL_STATUS_OOM) goto oom;
-    if (rc == IR2AEL_STATUS_FAIL_EMIT) goto fail_emit;
-    goto fail;
-
-oom:
-    if (err && err_cap) snprintf(err, err_cap, "out of memory");
-fail:
+    ir2ael_report_failure(rc, out, inst, i, err, err_cap);
+    ir2ael_parallel_free(&par);
     ir2ael_state_free(&st);
+    (void)ael_emit_flush(out); /* keep partial output for diagnostics */
     return false;
+}
 
-fail_emit:
-    if (err && err_cap) {
-        const char *reason = (out && out->last_fail_reason == AEL_EMIT_FAIL_BACKWARD_LINE) ? "backward_line" :
-                             (out && out->last_fail_reason == AEL_EMIT_FAIL_BACKWARD_COL) ? "backward_col" :
-                             (out && out->last_fail_reason == AEL_EMIT_FAIL_IO) ? "io" : "unknown";
-        if (inst) {
-            snprintf(err, err_cap,
-                     "emit failed at IR index %zu (OP=%d arg1=%d arg2=%d arg3=%d) at out=%d:%d req=%d:%d (%s)",
-                     i, inst->op,
-                     inst->has_arg1 ? inst->arg1 : 0,
-                     inst->has_arg2 ? inst->arg2 : 0,
-                     inst->has_arg3 ? inst->arg3 : 0,
-                     out ? out->line0 : -1, out ? out->col0 : -1,
-                     out ? out->last_req_line0 : -1, out ? out->last_req_col0 : -1,
-                     reason);
-        } else {
-            snprintf(err, err_cap,
-                     "emit failed at IR index %zu at out=%d:%d req=%d:%d (%s)",
-                     i,
-                     out ? out->line0 : -1, out ? out->col0 : -1,
-                     out ? out->last_req_line0 : -1, out ? out->last_req_col0 : -1,
-                     reason);
-        }
+void ir2ael_report_failure(Ir2AelStatus rc, const AelEmitter *out, const IRInst *inst, size_t i, char *err,
+                           size_t err_cap) {
+    if (!err || !err_cap) return;
+    if (rc == IR2AEL_STATUS_OOM) {
+        snprintf(err, err_cap, "out of memory");
+        return;
+    }
+    if (rc != IR2AEL_STATUS_FAIL_EMIT) return; /* the handler already described the failure */
+
+    const char *reason = (out && out->last_fail_reason == AEL_EMIT_FAIL_BACKWARD_LINE) ? "backward_line" :
+                         (out && out->last_fail_reason == AEL_EMIT_FAIL_BACKWARD_COL) ? "backward_col" :
+                         (out && out->last_fail_reason == AEL_EMIT_FAIL_IO) ? "io" : "unknown";
+    if (inst) {
+        snprintf(err, err_cap,
+                 "emit failed at IR index %zu (OP=%d arg1=%d arg2=%d arg3=%d) at out=%d:%d req=%d:%d (%s)",
+                 i, inst->op,
+                 inst->has_arg1 ? inst->arg1 : 0,
+                 inst->has_arg2 ? inst->arg2 : 0,
+                 inst->has_arg3 ? inst->arg3 : 0,
+                 out ? out->line0 : -1, out ? out->col0 : -1,
+                 out ? out->last_req_line0 : -1, out ? out->last_req_col0 : -1,
+                 reason);
+    } else {
+        snprintf(err, err_cap,
+                 "emit failed at IR index %zu at out=%d:%d req=%d:%d (%s)",
+                 i,
+                 out ? out->line0 : -1, out ? out->col0 : -1,
+                 out ? out->last_req_line0 : -1, out ? out->last_req_col0 : -1,
+                 reason);
     }
-    goto fail;
 }
@@ -1,6 +1,5 @@
 /* ir2ael_convert_decl.c - defun and declaration handling */
 #include "ir2ael_internal.h"
-#include <string.h>
 
 Ir2AelStatus ir2ael_preprocess_inst(Ir2AelState *s, size_t i, const IRInst *inst) {
     if (!s || !inst) return IR2AEL_STATUS_FAIL;
@@ -25,7 +24,7 @@ Ir2AelStatus ir2ael_preprocess_inst(Ir2AelState *s, size_t i, const IRInst *inst
         s->in_function = true;
         s->function_brace_open = true;
         s->current_defun_line0 = s->pending_defun_line0;
-        s->anon_depth_sp = 0;
+        s->anon.sp = 0;
         local_init_clear(&s->local_init);
     }
 
@@ -35,8 +34,8 @@ Ir2AelStatus ir2ael_preprocess_inst(Ir2AelState *s, size_t i, const IRInst *inst
         int decl_col0 = s->pending_decls.is_local ?
             decl_indent_col0_from_depth(s->pending_decls.depth > 0 ? s->pending_decls.depth : 1) : 0;
 
-        if (s->pending_decls.is_local && inst->op == OP_LOAD_VAR && inst->str &&
-            strcmp(inst->str, s->pending_decls.names[s->pending_decls.count - 1]) == 0) {
+        if (s->pending_decls.is_local && inst->op == OP_LOAD_VAR &&
+            decl_group_name_is(&s->pending_decls, s->pending_decls.count - 1, inst)) {
 
             DeclGroup prefix = s->pending_decls;
             prefix.count = s->pending_decls.count - 1;
@@ -45,8 +44,8 @@ Ir2AelStatus ir2ael_preprocess_inst(Ir2AelState *s, size_t i, const IRInst *inst
                     return IR2AEL_STATUS_FAIL_EMIT;
                 }
             }
-            strncpy(s->pending_decls.names[0], s->pending_decls.names[s->pending_decls.count - 1], 255);
-            s->pending_decls.names[0][255] = '\0';
+            s->pending_decls.names[0] = s->pending_decls.names[s->pending_decls.count - 1];
+            s->pending_decls.ids[0] = s->pending_decls.ids[s->pending_decls.count - 1];
             s->pending_decls.count = 1;
         } else {
             if (!decl_group_emit_and_track(s->out, &s->pending_decls, decl_line0, decl_col0, &s->local_init)) {
@@ -57,10 +56,9 @@ Ir2AelStatus ir2ael_preprocess_inst(Ir2AelState *s, size_t i, const IRInst *inst
     }
 
     if (s->pending_decls.count == 1 && s->stack_len == 0 && inst->op != OP_ADD_GLOBAL && inst->op != OP_ADD_LOCAL) {
-        bool is_pending_name_load = (inst->op == OP_LOAD_VAR && inst->str &&
-                                     strcmp(inst->str, s->pending_decls.names[0]) == 0);
+        bool is_pending_name_load = (inst->op == OP_LOAD_VAR && decl_group_name_is(&s->pending_decls, 0, inst));
         if (!is_pending_name_load) {
-            bool has_init_soon = scan_for_assignment_to_var(s->program, i, 128, s->pending_decls.names[0],
+            bool has_init_soon = scan_for_assignment_to_var(s->program, i, IR2AEL_SCAN_DECL_INIT, s->pending_decls.names[0],
                                                            s->pending_decls.depth, s->out->strict_pos);
             if (!has_init_soon) {
                 int decl_line0 = s->out->line0;
@@ -108,11 +106,11 @@ Ir2AelStatus ir2ael_handle_function_ops(Ir2AelState *s, size_t i, const IRInst *
                     }
                     if (!ael_emit_at(s->out, s->out->line0, close_col0)) return IR2AEL_STATUS_FAIL_EMIT;
                     if (!ael_emit_text(s->out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-                    anon_depth_pop_expected(&s->anon_depth_sp, s->anon_depth_stack, ctx->depth + 1, true);
+                    anon_depth_pop_expected(&s->anon, ctx->depth + 1, true);
                 }
                 s->if_sp--;
             }
-            if (!anon_close_scope_blocks_at_function_end(s->out, &s->anon_depth_sp, s->anon_depth_stack, 1, s->out->line0)) {
+            if (!anon_close_scope_blocks_at_function_end(s->out, &s->anon, 1, s->out->line0)) {
                 return IR2AEL_STATUS_FAIL_EMIT;
             }
             if (!ael_emit_at(s->out, s->out->line0, 0)) return IR2AEL_STATUS_FAIL_EMIT;
@@ -120,7 +118,7 @@ Ir2AelStatus ir2ael_handle_function_ops(Ir2AelState *s, size_t i, const IRInst *
             s->in_function = false;
             s->function_brace_open = false;
             local_init_clear(&s->local_init);
-            s->anon_depth_sp = 0;
+            s->anon.sp = 0;
             s->if_sp = 0;
             s->loop_sp = 0;
             s->for_hdr_sp = 0;
@@ -137,17 +135,12 @@ Ir2AelStatus ir2ael_handle_function_ops(Ir2AelState *s, size_t i, const IRInst *
         s->pending_defun = true;
         s->pending_defun_param_count = 0;
         s->pending_defun_line0 = inst->has_arg1 ? inst->arg1 : 0;
-        strncpy(s->pending_defun_name, inst->str ? inst->str : "f", sizeof(s->pending_defun_name) - 1);
-        s->pending_defun_name[sizeof(s->pending_defun_name) - 1] = '\0';
+        s->pending_defun_name = inst->str ? inst->str : "f";
         return IR2AEL_STATUS_HANDLED;
     }
 
     if (inst->op == 45) {
-        if (s->pending_defun && s->pending_defun_param_count < 32 && inst->str) {
-            strncpy(s->pending_defun_params[s->pending_defun_param_count], inst->str, 255);
-            s->pending_defun_params[s->pending_defun_param_count][255] = '\0';
-            s->pending_defun_param_count++;
-        }
+        if (s->pending_defun && inst->str && !ir2ael_defun_param_push(s, inst->str)) return IR2AEL_STATUS_OOM;
         return IR2AEL_STATUS_HANDLED;
     }
 
@@ -156,7 +149,7 @@ Ir2AelStatus ir2ael_handle_function_ops(Ir2AelState *s, size_t i, const IRInst *
         int end_col0 = inst->has_arg3 ? inst->arg3 : 0;
 
         int next_begin_line0 = -1;
-        for (size_t j = i + 1; j < s->program->count && j < i + 512; j++) {
+        for (size_t j = i + 1; j < s->program->count && j < i + IR2AEL_SCAN_STMT_BODY; j++) {
             const IRInst *n = &s->program->insts[j];
             if (n->op == OP_BEGIN_FUNCT && n->has_arg1) {
                 next_begin_line0 = n->arg1;
@@ -177,7 +170,7 @@ Ir2AelStatus ir2ael_handle_function_ops(Ir2AelState *s, size_t i, const IRInst *
                 }
                 if (!ael_emit_at(s->out, s->out->line0, close_col0)) return IR2AEL_STATUS_FAIL_EMIT;
                 if (!ael_emit_text(s->out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-                anon_depth_pop_expected(&s->anon_depth_sp, s->anon_depth_stack, ctx->depth + 1, true);
+                anon_depth_pop_expected(&s->anon, ctx->depth + 1, true);
             }
             s->if_sp--;
         }
@@ -186,10 +179,10 @@ Ir2AelStatus ir2ael_handle_function_ops(Ir2AelState *s, size_t i, const IRInst *
         s->pending_inline_else_col0 = -1;
 
         if (s->in_function) {
-            if (!anon_close_scope_blocks_at_function_end(s->out, &s->anon_depth_sp, s->anon_depth_stack, 1, end_line0)) {
+            if (!anon_close_scope_blocks_at_function_end(s->out, &s->anon, 1, end_line0)) {
                 return IR2AEL_STATUS_FAIL_EMIT;
             }
-            s->anon_depth_sp = 0;
+            s->anon.sp = 0;
         }
         if (end_col0 < 0) end_col0 = 0;
         if (!ael_emit_at(s->out, end_line0, end_col0)) return IR2AEL_STATUS_FAIL_EMIT;
@@ -247,9 +240,8 @@ Ir2AelStatus ir2ael_handle_decl_ops(Ir2AelState *s, const IRInst *inst) {
             s->pending_decls.depth = s->cur_depth;
         }
         if (s->pending_decls.count < max_decl_names) {
-            strncpy(s->pending_decls.names[s->pending_decls.count], inst->str, 255);
-            s->pending_decls.names[s->pending_decls.count][255] = '\0';
-            s->pending_decls.count++;
+            s->pending_decls.ids[s->pending_decls.count] = inst->str_id;
+            s->pending_decls.names[s->pending_decls.count++] = inst->str;
         }
     }
 
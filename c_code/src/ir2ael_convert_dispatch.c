@@ -0,0 +1,92 @@
+/* ir2ael_convert_dispatch.c - opcode-indexed handler dispatch */
+#include "ir2ael_internal.h"
+#include "ir2ael_prof.h"
+
+#define IR2AEL_MAX_HANDLERS_PER_OP 4
+
+/* Adapters so every registered handler shares the Ir2AelOpHandler signature. */
+static Ir2AelStatus dispatch_function_ops(Ir2AelState *s, size_t *i, const IRInst *inst) {
+    return ir2ael_handle_function_ops(s, *i, inst);
+}
+
+static Ir2AelStatus dispatch_decl_ops(Ir2AelState *s, size_t *i, const IRInst *inst) {
+    (void)i;
+    return ir2ael_handle_decl_ops(s, inst);
+}
+
+static Ir2AelStatus dispatch_load_ops(Ir2AelState *s, size_t *i, const IRInst *inst) {
+    (void)i;
+    return ir2ael_handle_load_ops(s, inst);
+}
+
+/*
+ * Handler chains, registered per opcode. Each chain is NULL-terminated and tried in order until a
+ * handler returns something other than IR2AEL_STATUS_NOT_HANDLED. Every handler is gated on its own
+ * opcodes, so an opcode only needs to list the handlers that can claim it; the relative order within
+ * a chain matches the order the handlers used to be tried in.
+ */
+static const Ir2AelOpHandler k_op_handlers[IR2AEL_OP_SLOTS][IR2AEL_MAX_HANDLERS_PER_OP] = {
+    [OP_LOAD_INT]         = { dispatch_load_ops },
+    [OP_LOAD_STR]         = { dispatch_load_ops },
+    [5]                   = { dispatch_load_ops },                /* LOAD_BOOL */
+    [OP_LOAD_TRUE]        = { ir2ael_flow_handle_load_true },
+    [OP_LOAD_REAL]        = { dispatch_load_ops },
+    [OP_LOAD_IMAG]        = { dispatch_load_ops },
+    [OP_LOAD_NULL]        = { dispatch_load_ops },
+    [OP_LOAD_VAR]         = { dispatch_load_ops },
+    [OP_ADD_LOCAL]        = { dispatch_decl_ops },
+    [OP_BEGIN_FUNCT]      = { dispatch_function_ops },
+    [OP_DEFINE_FUNCT]     = { dispatch_function_ops },
+    [OP_BRANCH_TRUE]      = { ir2ael_flow_handle_branch_true },
+    [OP_BEGIN_LOOP]       = { ir2ael_flow_handle_begin_loop },
+    [OP_END_LOOP]         = { ir2ael_flow_handle_end_loop },
+    [OP_LOOP_AGAIN]       = { ir2ael_flow_handle_loop_ctrl },
+    [OP_LOOP_EXIT]        = { ir2ael_flow_handle_loop_ctrl },
+    [OP_ADD_CASE]         = { ir2ael_flow_handle_switch_ops },
+    [OP_BRANCH_TABLE]     = { ir2ael_flow_handle_switch_ops },
+    [OP_SET_LABEL]        = { ir2ael_flow_handle_set_label },
+    [OP_ADD_LABEL]        = { ir2ael_flow_handle_add_label },
+    [OP_ADD_GLOBAL]       = { dispatch_decl_ops },
+    [45]                  = { dispatch_function_ops },            /* defun parameter */
+    [OP_OP]               = { ir2ael_handle_expr_ops },
+    [OP_NUM_LOCAL]        = { ir2ael_handle_scope_ops },
+    [OP_SET_LOOP_DEFAULT] = { ir2ael_flow_handle_switch_ops },
+    [OP_DROP_LOCAL]       = { ir2ael_handle_scope_ops },
+};
+
+#if IR2AEL_PROF_ENABLED
+static Ir2AelProfHandler prof_handler_id(Ir2AelOpHandler fn) {
+    if (fn == dispatch_function_ops) return IR2AEL_PROF_H_FUNCTION_OPS;
+    if (fn == dispatch_decl_ops) return IR2AEL_PROF_H_DECL_OPS;
+    if (fn == ir2ael_handle_scope_ops) return IR2AEL_PROF_H_SCOPE_OPS;
+    if (fn == dispatch_load_ops) return IR2AEL_PROF_H_LOAD_OPS;
+    if (fn == ir2ael_handle_expr_ops) return IR2AEL_PROF_H_EXPR_OPS;
+    if (fn == ir2ael_flow_handle_switch_ops) return IR2AEL_PROF_H_SWITCH_OPS;
+    if (fn == ir2ael_flow_handle_begin_loop) return IR2AEL_PROF_H_BEGIN_LOOP;
+    if (fn == ir2ael_flow_handle_end_loop) return IR2AEL_PROF_H_END_LOOP;
+    if (fn == ir2ael_flow_handle_loop_ctrl) return IR2AEL_PROF_H_LOOP_CTRL;
+    if (fn == ir2ael_flow_handle_add_label) return IR2AEL_PROF_H_ADD_LABEL;
+    if (fn == ir2ael_flow_handle_set_label) return IR2AEL_PROF_H_SET_LABEL;
+    if (fn == ir2ael_flow_handle_branch_true) return IR2AEL_PROF_H_BRANCH_TRUE;
+    if (fn == ir2ael_flow_handle_load_true) return IR2AEL_PROF_H_LOAD_TRUE;
+    return IR2AEL_PROF_H_COUNT;
+}
+#endif
+
+Ir2AelStatus ir2ael_dispatch_inst(Ir2AelState *s, size_t *i, const IRInst *inst) {
+    if (!s || !i || !inst) return IR2AEL_STATUS_FAIL;
+    if (inst->op < 0 || inst->op >= IR2AEL_OP_SLOTS) return IR2AEL_STATUS_NOT_HANDLED;
+
+    const Ir2AelOpHandler *chain = k_op_handlers[inst->op];
+    for (int h = 0; h < IR2AEL_MAX_HANDLERS_PER_OP && chain[h]; h++) {
+#if IR2AEL_PROF_ENABLED
+        uint64_t t0 = ir2ael_prof_now();
+        Ir2AelStatus rc = chain[h](s, i, inst);
+        ir2ael_prof_handler(prof_handler_id(chain[h]), rc, ir2ael_prof_now() - t0);
+#else
+        Ir2AelStatus rc = chain[h](s, i, inst);
+#endif
+        if (rc != IR2AEL_STATUS_NOT_HANDLED) return rc;
+    }
+    return IR2AEL_STATUS_NOT_HANDLED;
+}
@@ -41,17 +41,19 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
 
                     int false_label = program->insts[p4].arg1;
                     size_t then_start = p5 + 1;
+                    /* Label ids restart per function: the template never continues past its own. */
+                    size_t fn_end = ir_next_funct_boundary(program, then_start, program->count);
 
                     size_t idx_op60 = (size_t)-1;
                     size_t idx_load_true = (size_t)-1;
                     size_t idx_branch_end = (size_t)-1;
                     size_t idx_set_false = (size_t)-1;
-                    for (size_t j = then_start; j < program->count; j++) {
-                        if (!(program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 60)) continue;
+                    for (size_t j = ir_next_marker(program, 60, then_start, fn_end); j < fn_end;
+                         j = ir_next_marker(program, 60, j + 1, fn_end)) {
                         size_t k1 = ir_skip_scope_bookkeeping(program, j + 1);
                         size_t k2 = ir_skip_scope_bookkeeping(program, k1 + 1);
                         size_t k3 = ir_skip_scope_bookkeeping(program, k2 + 1);
-                        if (k3 >= program->count) break;
+                        if (k3 >= fn_end) break;
                         if (ir_inst_is_load_trueish(&program->insts[k1]) &&
                             program->insts[k2].op == OP_BRANCH_TRUE && program->insts[k2].has_arg1 &&
                             program->insts[k3].op == OP_SET_LABEL && program->insts[k3].has_arg1 &&
@@ -69,10 +71,10 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                         size_t else_start = idx_set_false + 1;
                         size_t idx_op65 = (size_t)-1;
                         size_t idx_set_end = (size_t)-1;
-                        for (size_t j = else_start; j < program->count; j++) {
-                            if (!(program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 65)) continue;
+                        for (size_t j = ir_next_marker(program, 65, else_start, fn_end); j < fn_end;
+                             j = ir_next_marker(program, 65, j + 1, fn_end)) {
                             size_t k1 = ir_skip_scope_bookkeeping(program, j + 1);
-                            if (k1 >= program->count) break;
+                            if (k1 >= fn_end) break;
                             if (program->insts[k1].op == OP_SET_LABEL && program->insts[k1].has_arg1 &&
                                 program->insts[k1].arg1 == end_label) {
                                 idx_op65 = j;
@@ -158,9 +160,11 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
 
                     size_t rhs_start = idx_bt + 3;
                     size_t rhs_marker = (size_t)-1;
-                    for (size_t j = rhs_start; j + 1 < program->count; j++) {
-                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == op_code &&
-                            program->insts[j + 1].op == OP_SET_LABEL && program->insts[j + 1].has_arg1 && program->insts[j + 1].arg1 == end_label) {
+                    size_t fn_end = ir_next_funct_boundary(program, rhs_start, program->count);
+                    for (size_t lab = ir_next_set_label(program, end_label, rhs_start + 1, fn_end); lab < fn_end;
+                         lab = ir_next_set_label(program, end_label, lab + 1, fn_end)) {
+                        size_t j = lab - 1;
+                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == op_code) {
                             rhs_marker = j;
                             break;
                         }
@@ -230,14 +234,15 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                 program->insts[i + 5].op == OP_OP && program->insts[i + 5].has_arg1 && program->insts[i + 5].arg1 == 61) {
 
                 int false_label = program->insts[i + 4].arg1;
+                size_t fn_end = ir_next_funct_boundary(program, i, program->count);
 
                 size_t idx_op60 = (size_t)-1;
-                for (size_t j = i + 6; j + 3 < program->count; j++) {
+                for (size_t lab = ir_next_set_label(program, false_label, i + 9, fn_end); lab < fn_end;
+                     lab = ir_next_set_label(program, false_label, lab + 1, fn_end)) {
+                    size_t j = lab - 3;
                     if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 60 &&
                         ir_inst_is_load_trueish(&program->insts[j + 1]) &&
-                        program->insts[j + 2].op == OP_BRANCH_TRUE && program->insts[j + 2].has_arg1 &&
-                        program->insts[j + 3].op == OP_SET_LABEL && program->insts[j + 3].has_arg1 &&
-                        program->insts[j + 3].arg1 == false_label) {
+                        program->insts[j + 2].op == OP_BRANCH_TRUE && program->insts[j + 2].has_arg1) {
                         idx_op60 = j;
                         break;
                     }
@@ -247,10 +252,10 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                     int end_label = program->insts[idx_op60 + 2].arg1;
                     size_t else_start = idx_op60 + 4;
                     size_t idx_op65 = (size_t)-1;
-                    for (size_t j = else_start; j + 1 < program->count; j++) {
-                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 65 &&
-                            program->insts[j + 1].op == OP_SET_LABEL && program->insts[j + 1].has_arg1 &&
-                            program->insts[j + 1].arg1 == end_label) {
+                    for (size_t lab = ir_next_set_label(program, end_label, else_start + 1, fn_end); lab < fn_end;
+                         lab = ir_next_set_label(program, end_label, lab + 1, fn_end)) {
+                        size_t j = lab - 1;
+                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 65) {
                             idx_op65 = j;
                             break;
                         }
@@ -357,11 +362,11 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                     }
                     decl_group_clear(&st->pending_decls);
                 }
-                if (!switch_emit_pending_case_before_stmt(out, &st->sw, line0, if_col0_pre, &st->anon_depth_sp, st->anon_depth_stack)) {
+                if (!switch_emit_pending_case_before_stmt(out, &st->sw, line0, if_col0_pre, &st->anon)) {
                     expr_free(cond);
                     goto fail_emit;
                 }
-                if (!if_close_braced_else_on_depth_exit(out, st->if_stack, &st->if_sp, st->cur_depth, &st->anon_depth_sp, st->anon_depth_stack)) goto fail_emit;
+                if (!if_close_braced_else_on_depth_exit(out, st->if_stack, &st->if_sp, st->cur_depth, &st->anon)) goto fail_emit;
 
                 /* Single-statement if for break/continue (no braces): if(cond) continue; / break; */
                 if (i + 7 < program->count &&
@@ -425,7 +430,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                 bool best_brace_style = true;
                 int best_inferred_end_label = -1;
 
-                for (size_t j = i + 4; j < program->count && j < i + 512; j++) {
+                for (size_t j = i + 4; j < program->count && j < i + IR2AEL_SCAN_STMT_BODY; j++) {
                     if (program->insts[j].op == OP_SET_LABEL && program->insts[j].has_arg1 &&
                         program->insts[j].arg1 == else_label) {
                         break;
@@ -467,7 +472,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                         if (close_col0 > base_indent + 8) {
                             /* Guard: only treat this as an else-header if we soon encounter the else-label. */
                             bool has_else_label_soon = false;
-                            for (size_t k = j + 2; k < program->count && k < j + 16; k++) {
+                            for (size_t k = j + 2; k < program->count && k < j + IR2AEL_SCAN_ELSE_HEAD; k++) {
                                 if (program->insts[k].op == OP_SET_LABEL && program->insts[k].has_arg1 &&
                                     program->insts[k].arg1 == else_label) {
                                     has_else_label_soon = true;
@@ -557,7 +562,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                             if (!ael_emit_at(out, line0 + 1, if_col0)) goto fail_emit;
                             if (!ael_emit_text(out, "{\n")) goto fail_emit;
                         }
-                        if (st->if_sp < (int)(sizeof(st->if_stack) / sizeof(st->if_stack[0]))) {
+                        if (ir2ael_if_stack_reserve(st)) {
                             st->if_stack[st->if_sp].else_label = else_label;
                             st->if_stack[st->if_sp].end_label = -1;
                             st->if_stack[st->if_sp].stage = 1;
@@ -566,16 +571,13 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                             st->if_stack[st->if_sp].depth = st->cur_depth;
                             st->if_sp++;
                         } else {
-                            if (err && err_cap) snprintf(err, err_cap, "if st->stack overflow at IR index %zu", i);
-                            goto fail;
-                        }
-                        if (st->anon_depth_sp < (int)(sizeof(st->anon_depth_stack) / sizeof(st->anon_depth_stack[0]))) {
-                            (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, st->cur_depth + 1, true);
+                            goto oom;
                         }
+                        (void)anon_depth_push_marked(&st->anon, st->cur_depth + 1, true);
                     } else {
                         /* Some baselines keep the statement on the same line: "if (cond) stmt;". */
                         int inline_stmt_col0 = -1;
-                        for (size_t j = i + 4; j < program->count && j < i + 96; j++) {
+                        for (size_t j = i + 4; j < program->count && j < i + IR2AEL_SCAN_INLINE_STMT; j++) {
                             const IRInst *mj = &program->insts[j];
                             if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == else_label) break;
                             if (mj->op == OP_OP && mj->has_arg2 && mj->has_arg3 &&
@@ -640,7 +642,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                 } else {
                     /* Some baselines keep the statement on the same line: "if (cond) stmt;". */
                     int inline_stmt_col0 = -1;
-                    for (size_t j = i + 4; j < program->count && j < i + 96; j++) {
+                    for (size_t j = i + 4; j < program->count && j < i + IR2AEL_SCAN_INLINE_STMT; j++) {
                         const IRInst *mj = &program->insts[j];
                         if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == else_label) break;
                         if (mj->op == OP_OP && mj->has_arg2 && mj->has_arg3 &&
@@ -655,7 +657,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                     }
                 }
 
-                if (st->if_sp < (int)(sizeof(st->if_stack) / sizeof(st->if_stack[0]))) {
+                if (ir2ael_if_stack_reserve(st)) {
                     st->if_stack[st->if_sp].else_label = else_label;
                     st->if_stack[st->if_sp].end_label = inferred_end_label;
                     st->if_stack[st->if_sp].stage = 1;
@@ -664,12 +666,11 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                     st->if_stack[st->if_sp].depth = st->cur_depth;
                     st->if_sp++;
                 } else {
-                    if (err && err_cap) snprintf(err, err_cap, "if st->stack overflow at IR index %zu", i);
-                    goto fail;
+                    goto oom;
                 }
                 if (brace_style) {
                     /* Track brace-open depth so scope reconstruction (and later brace closes) stay consistent. */
-                    (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, st->cur_depth + 1, true);
+                    (void)anon_depth_push_marked(&st->anon, st->cur_depth + 1, true);
                 }
 
                 i += 3; /* consume header ops */
@@ -696,7 +697,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                        before the body when the body starts with '{'. */
                     bool body_is_block = !out->allow_num_local_scope_blocks;
                     if (!body_is_block) {
-                        for (size_t j = i + 1; j < program->count && j < i + 64; j++) {
+                        for (size_t j = i + 1; j < program->count && j < i + IR2AEL_SCAN_FOR_SCAFFOLD; j++) {
                             const IRInst *mj = &program->insts[j];
                             if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
                             if (mj->op == OP_NUM_LOCAL && mj->has_depth && mj->depth > st->cur_depth) {
@@ -719,7 +720,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                         }
                     } else {
                         int body_line0 = -1;
-                        for (size_t j = i + 1; j < program->count && j < i + 256; j++) {
+                        for (size_t j = i + 1; j < program->count && j < i + IR2AEL_SCAN_ELSE_IF; j++) {
                             const IRInst *mj = &program->insts[j];
                             if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
                             if (mj->op == OP_OP && mj->has_arg2) {
@@ -744,7 +745,7 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                         if (st->loop_sp > 0 && st->loop_stack[st->loop_sp - 1].kind == 3) {
                             st->loop_stack[st->loop_sp - 1].body_has_brace = true;
                         }
-                        (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, st->cur_depth + 1, true);
+                        (void)anon_depth_push_marked(&st->anon, st->cur_depth + 1, true);
                     }
                     st->for_hdr_sp--;
                     continue;
@@ -775,15 +776,15 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                         int stmt_line0 = expr_min_line0(stmt);
                         if (stmt_line0 < 0) stmt_line0 = semi_line0;
                         int start_col0 = expr_start_col0(stmt, stmt_line0);
-                        if (!switch_emit_pending_case_before_stmt(out, &st->sw, stmt_line0, start_col0, &st->anon_depth_sp, st->anon_depth_stack)) {
+                        if (!switch_emit_pending_case_before_stmt(out, &st->sw, stmt_line0, start_col0, &st->anon)) {
                             expr_free(stmt);
                             goto fail_emit;
                         }
-                        if (!if_close_braced_else_on_depth_exit(out, st->if_stack, &st->if_sp, st->cur_depth, &st->anon_depth_sp, st->anon_depth_stack)) {
+                        if (!if_close_braced_else_on_depth_exit(out, st->if_stack, &st->if_sp, st->cur_depth, &st->anon)) {
                             expr_free(stmt);
                             goto fail_emit;
                         }
-                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, st->cur_depth, stmt_line0)) {
+                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, st->cur_depth, stmt_line0)) {
                             expr_free(stmt);
                             goto fail_emit;
                         }
@@ -822,15 +823,15 @@ Ir2AelStatus ir2ael_handle_expr_ops(Ir2AelState *s, size_t *idx, const IRInst *i
                 Expr *ret = stack_pop(st->stack, &st->stack_len);
                 int rline0 = inst->has_arg2 ? inst->arg2 : 0;
                 int rcol0 = inst->has_arg3 ? inst->arg3 : 0;
-                if (!switch_emit_pending_case_before_stmt(out, &st->sw, rline0, rcol0, &st->anon_depth_sp, st->anon_depth_stack)) {
+                if (!switch_emit_pending_case_before_stmt(out, &st->sw, rline0, rcol0, &st->anon)) {
                     expr_free(ret);
                     goto fail_emit;
                 }
-                if (!if_close_braced_else_on_depth_exit(out, st->if_stack, &st->if_sp, st->cur_depth, &st->anon_depth_sp, st->anon_depth_stack)) {
+                if (!if_close_braced_else_on_depth_exit(out, st->if_stack, &st->if_sp, st->cur_depth, &st->anon)) {
                     expr_free(ret);
                     goto fail_emit;
                 }
-                if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, st->cur_depth, rline0)) {
+                if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, st->cur_depth, rline0)) {
                     expr_free(ret);
                     goto fail_emit;
                 }
@@ -6,25 +6,25 @@
 
 static Expr *build_fallback_assign_call(Expr *lhs, Expr *rhs, const IRInst *inst) {
     if (!lhs || !rhs || !inst) return NULL;
-    Expr **args = (Expr **)calloc(2, sizeof(Expr *));
+    Expr **args = expr_array_new(2);
     if (!args) return NULL;
     args[0] = lhs;
     args[1] = rhs;
     Expr *callee = expr_new(EXPR_VAR);
     if (!callee) {
-        free(args);
+        expr_array_free(args);
         return NULL;
     }
-    callee->text = _strdup("__assign");
+    callee->text = expr_strdup("__assign");
     if (!callee->text) {
         expr_free(callee);
-        free(args);
+        expr_array_free(args);
         return NULL;
     }
     Expr *ce = expr_new(EXPR_CALL);
     if (!ce) {
         expr_free(callee);
-        free(args);
+        expr_array_free(args);
         return NULL;
     }
     ce->lhs = callee;
@@ -116,7 +116,7 @@ static Ir2AelStatus try_emit_for_header_init(Ir2AelState *st, const IRInst *inst
     int for_col0 = lparen_col0 - 4; /* strlen("for ") */
     if (for_col0 < 0) for_col0 = 0;
     int cond_col0 = -1;
-    if (!find_for_header_cond_col0(program, i + 1, 80, line0, &cond_col0)) {
+    if (!find_for_header_cond_col0(program, i + 1, IR2AEL_SCAN_FOR_COND, line0, &cond_col0)) {
         cond_col0 = id_col0 + 6;
     }
     int semi1_col0 = cond_col0 - 2;
@@ -131,7 +131,7 @@ static Ir2AelStatus try_emit_for_header_init(Ir2AelState *st, const IRInst *inst
         int decl_line0 = line0 - 1;
         if (decl_line0 < out->line0) decl_line0 = out->line0;
         int decl_col0 = decl_indent_col0_from_depth(st->cur_depth > 0 ? st->cur_depth : 1);
-        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, st->cur_depth, decl_line0)) return IR2AEL_STATUS_FAIL_EMIT;
+        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, st->cur_depth, decl_line0)) return IR2AEL_STATUS_FAIL_EMIT;
         if (!decl_group_emit_and_track(out, &st->pending_decls, decl_line0, decl_col0, &st->local_init)) return IR2AEL_STATUS_FAIL_EMIT;
         decl_group_clear(&st->pending_decls);
     }
@@ -149,13 +149,15 @@ static Ir2AelStatus try_emit_for_header_init(Ir2AelState *st, const IRInst *inst
     if (!ael_emit_at(out, line0, semi1_col0)) return IR2AEL_STATUS_FAIL_EMIT;
     if (!ael_emit_text(out, "; ")) return IR2AEL_STATUS_FAIL_EMIT;
 
-    if (st->for_hdr_sp < (int)(sizeof(st->for_hdr_stack) / sizeof(st->for_hdr_stack[0]))) {
+    if (ir2ael_for_hdr_stack_reserve(st)) {
         st->for_hdr_stack[st->for_hdr_sp].line0 = line0;
         st->for_hdr_stack[st->for_hdr_sp].cond_start_col0 = cond_col0;
         st->for_hdr_stack[st->for_hdr_sp].stage = 1;
         st->for_hdr_sp++;
+    } else {
+        return IR2AEL_STATUS_OOM;
     }
-    if (st->loop_sp < (int)(sizeof(st->loop_stack) / sizeof(st->loop_stack[0]))) {
+    if (ir2ael_loop_stack_reserve(st)) {
         st->loop_stack[st->loop_sp].kind = 3; /* for */
         st->loop_stack[st->loop_sp].depth = st->cur_depth;
         st->loop_stack[st->loop_sp].start_label = -1;
@@ -167,6 +169,8 @@ static Ir2AelStatus try_emit_for_header_init(Ir2AelState *st, const IRInst *inst
         st->loop_stack[st->loop_sp].header_emitted = true;
         st->loop_stack[st->loop_sp].body_has_brace = false;
         st->loop_sp++;
+    } else {
+        return IR2AEL_STATUS_OOM;
     }
 
     return IR2AEL_STATUS_HANDLED;
@@ -247,7 +251,7 @@ Ir2AelStatus ir2ael_expr_handle_assign_ops(Ir2AelState *s, size_t *idx, const IR
                     continue;
                 }
                 if (lhs->kind == EXPR_VAR && lhs->text) {
-                    local_init_mark_assigned(&st->local_init, lhs->text);
+                    local_init_mark_assigned(&st->local_init, lhs->text, lhs->text_id);
                 }
 
                 /* Assignment used as an expression (no trailing STMT_END): push "lhs = rhs" back onto the st->stack. */
@@ -352,12 +356,12 @@ Ir2AelStatus ir2ael_expr_handle_assign_ops(Ir2AelState *s, size_t *idx, const IR
                         if (decl_line0 < out->line0) decl_line0 = out->line0;
                         int decl_col0 = prefix.is_local ? decl_indent_col0_from_depth(prefix.depth > 0 ? prefix.depth : 1) : 0;
 
-                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, st->cur_depth, decl_line0)) goto fail_emit_assign;
+                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, st->cur_depth, decl_line0)) goto fail_emit_assign;
                         if (!decl_group_emit_and_track(out, &prefix, decl_line0, decl_col0, &st->local_init)) goto fail_emit_assign;
 
                         /* Keep only the last name pending so it can be emitted as a decl initializer. */
-                        strncpy(st->pending_decls.names[0], st->pending_decls.names[pending_decl_match], 255);
-                        st->pending_decls.names[0][255] = '\0';
+                        st->pending_decls.names[0] = st->pending_decls.names[pending_decl_match];
+                        st->pending_decls.ids[0] = st->pending_decls.ids[pending_decl_match];
                         st->pending_decls.count = 1;
                         pending_decl_match = 0;
                     }
@@ -408,12 +412,12 @@ Ir2AelStatus ir2ael_expr_handle_assign_ops(Ir2AelState *s, size_t *idx, const IR
                         bool chain_continue = allow_decl_init_chain && chain_continue_candidate;
 
                         if (!chain_continue) {
-                            if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, st->cur_depth, eq_line0)) goto fail_emit_assign;
+                            if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, st->cur_depth, eq_line0)) goto fail_emit_assign;
                             if (st->pending_decls.is_local && st->pending_decls.depth > 1) {
                                 /* Rely on explicit control-flow braces; avoid inserting extra blocks that can
                                    break if/else association (e.g., "if (...) { { ... } else ..."). */
                             }
-                            if (!switch_emit_pending_case_before_stmt(out, &st->sw, eq_line0, decl_col0, &st->anon_depth_sp, st->anon_depth_stack)) goto fail_emit_assign;
+                            if (!switch_emit_pending_case_before_stmt(out, &st->sw, eq_line0, decl_col0, &st->anon)) goto fail_emit_assign;
 
                             if (!emit_do_while_header_if_needed(st, eq_line0, eq_col0, -2)) goto fail_emit_assign;
 
@@ -466,7 +470,7 @@ Ir2AelStatus ir2ael_expr_handle_assign_ops(Ir2AelState *s, size_t *idx, const IR
                         /* Assignment statement: arg2/arg3 refers to identifier position. */
                         int id_line0 = inst->has_arg2 ? inst->arg2 : 0;
                         int id_col0 = inst->has_arg3 ? inst->arg3 : 0;
-                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, st->cur_depth, id_line0)) goto fail_emit_assign;
+                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, st->cur_depth, id_line0)) goto fail_emit_assign;
 
                         /* Ensure pending decls (e.g., 'decl x;') are emitted before first use. */
                         if (st->pending_decls.count > 0) {
@@ -482,7 +486,7 @@ Ir2AelStatus ir2ael_expr_handle_assign_ops(Ir2AelState *s, size_t *idx, const IR
                             decl_group_clear(&st->pending_decls);
                         }
 
-                    if (!switch_emit_pending_case_before_stmt(out, &st->sw, id_line0, id_col0, &st->anon_depth_sp, st->anon_depth_stack)) goto fail_emit_assign;
+                    if (!switch_emit_pending_case_before_stmt(out, &st->sw, id_line0, id_col0, &st->anon)) goto fail_emit_assign;
 
                     if (!emit_do_while_header_if_needed(st, id_line0, id_col0, -4)) goto fail_emit_assign;
 
@@ -34,13 +34,13 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                 if (n < 0) n = 0;
                 Expr **items = NULL;
                 if (n > 0) {
-                    items = (Expr **)calloc((size_t)n, sizeof(Expr *));
+                    items = expr_array_new((size_t)n);
                     if (!items) goto oom;
                     for (int k = n - 1; k >= 0; k--) {
                         items[k] = stack_pop(st->stack, &st->stack_len);
                         if (!items[k]) {
                             for (int t = k; t < n; t++) expr_free(items[t]);
-                            free(items);
+                            expr_array_free(items);
                             if (err && err_cap) snprintf(err, err_cap, "bad list st->stack at IR index %zu", i);
                             goto fail;
                         }
@@ -49,7 +49,7 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                 Expr *e = expr_new(EXPR_LIST);
                 if (!e) {
                     for (int k = 0; k < n; k++) expr_free(items[k]);
-                    free(items);
+                    expr_array_free(items);
                     goto oom;
                 }
                 e->items = items;
@@ -87,7 +87,7 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
 
                     Expr **args = NULL;
                     if (argc > 0) {
-                        args = (Expr **)calloc((size_t)argc, sizeof(Expr *));
+                        args = expr_array_new((size_t)argc);
                         if (!args) {
                             expr_free(m);
                             goto oom;
@@ -96,7 +96,7 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                             args[k] = stack_pop(st->stack, &st->stack_len);
                             if (!args[k]) {
                                 for (int t = k; t < argc; t++) expr_free(args[t]);
-                                free(args);
+                                expr_array_free(args);
                                 expr_free(m);
                                 if (err && err_cap) snprintf(err, err_cap, "bad call args st->stack at IR index %zu", i);
                                 goto fail;
@@ -107,7 +107,7 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                     Expr *callee = stack_pop(st->stack, &st->stack_len);
                     if (!callee) {
                         for (int t = 0; t < argc; t++) expr_free(args ? args[t] : NULL);
-                        free(args);
+                        expr_array_free(args);
                         expr_free(m);
                         if (err && err_cap) snprintf(err, err_cap, "bad call callee st->stack at IR index %zu", i);
                         goto fail;
@@ -117,7 +117,7 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                     if (!ce) {
                         expr_free(callee);
                         for (int t = 0; t < argc; t++) expr_free(args ? args[t] : NULL);
-                        free(args);
+                        expr_array_free(args);
                         expr_free(m);
                         goto oom;
                     }
@@ -166,13 +166,13 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                     goto fail;
                 }
 
-                Expr **all_idxs = (Expr **)calloc((size_t)total_index_items, sizeof(Expr *));
+                Expr **all_idxs = expr_array_new((size_t)total_index_items);
                 if (!all_idxs) goto oom;
                 for (int k = total_index_items - 1; k >= 0; k--) {
                     all_idxs[k] = stack_pop(st->stack, &st->stack_len);
                     if (!all_idxs[k]) {
                         for (int t = k; t < total_index_items; t++) expr_free(all_idxs[t]);
-                        free(all_idxs);
+                        expr_array_free(all_idxs);
                         if (err && err_cap) snprintf(err, err_cap, "bad index st->stack at IR index %zu", i);
                         goto fail;
                     }
@@ -180,7 +180,7 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                 Expr *base = stack_pop(st->stack, &st->stack_len);
                 if (!base) {
                     for (int t = 0; t < total_index_items; t++) expr_free(all_idxs[t]);
-                    free(all_idxs);
+                    expr_array_free(all_idxs);
                     if (err && err_cap) snprintf(err, err_cap, "bad index base st->stack at IR index %zu", i);
                     goto fail;
                 }
@@ -189,11 +189,11 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                 int off = 0;
                 for (int g = 0; g < group_n; g++) {
                     int ic = group_counts[g];
-                    Expr **idxs = (Expr **)calloc((size_t)ic, sizeof(Expr *));
+                    Expr **idxs = expr_array_new((size_t)ic);
                     if (!idxs) {
                         expr_free(cur);
                         for (int t = off; t < total_index_items; t++) expr_free(all_idxs[t]);
-                        free(all_idxs);
+                        expr_array_free(all_idxs);
                         goto oom;
                     }
                     for (int t = 0; t < ic; t++) {
@@ -204,9 +204,9 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                     if (!ie) {
                         expr_free(cur);
                         for (int t = 0; t < ic; t++) expr_free(idxs[t]);
-                        free(idxs);
+                        expr_array_free(idxs);
                         for (int t = off + ic; t < total_index_items; t++) expr_free(all_idxs[t]);
-                        free(all_idxs);
+                        expr_array_free(all_idxs);
                         goto oom;
                     }
                     ie->index_base = cur;
@@ -217,7 +217,7 @@ Ir2AelStatus ir2ael_expr_handle_list_call_ops(Ir2AelState *s, size_t *idx, const
                     cur = ie;
                     off += ic;
                 }
-                free(all_idxs);
+                expr_array_free(all_idxs);
 
                 if (!stack_push(&st->stack, &st->stack_len, &st->stack_cap, cur)) {
                     expr_free(cur);
@@ -55,7 +55,7 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
                 e->op_line0 = inst->has_arg2 ? inst->arg2 : -1;
                 e->op_col0 = inst->has_arg3 ? inst->arg3 : -1;
                 if (e->lhs && e->lhs->kind == EXPR_VAR && e->lhs->text) {
-                    local_init_mark_assigned(&st->local_init, e->lhs->text);
+                    local_init_mark_assigned(&st->local_init, e->lhs->text, e->lhs->text_id);
                 }
 
                 /* for-header update: "for (...; ...; i++)" has no STMT_END after the update expression.
@@ -90,7 +90,7 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
             if (op_code == 47) {
                 int argc = inst->has_a4 ? inst->a4 : 2;
                 if (argc < 2) argc = 2;
-                Expr **args = (Expr **)calloc((size_t)argc, sizeof(Expr *));
+                Expr **args = expr_array_new((size_t)argc);
                 if (!args) goto oom;
                 for (int k = argc - 1; k >= 0; k--) {
                     Expr *arg = stack_pop(st->stack, &st->stack_len);
@@ -98,7 +98,7 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
                         arg = expr_new(EXPR_INT);
                         if (!arg) {
                             for (int t = k + 1; t < argc; t++) expr_free(args[t]);
-                            free(args);
+                            expr_array_free(args);
                             goto oom;
                         }
                         arg->int_value = 0;
@@ -111,7 +111,7 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
                     if (!e) {
                         expr_free(cur);
                         for (int t = k; t < argc; t++) expr_free(args[t]);
-                        free(args);
+                        expr_array_free(args);
                         goto oom;
                     }
                     e->op_code = 47;
@@ -121,7 +121,7 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
                     e->rhs = args[k];
                     cur = e;
                 }
-                free(args);
+                expr_array_free(args);
                 if (!stack_push(&st->stack, &st->stack_len, &st->stack_cap, cur)) {
                     expr_free(cur);
                     goto oom;
@@ -133,7 +133,7 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
             if (!op_str) {
                 int argc = inst->has_a4 ? inst->a4 : 0;
                 if (argc <= 0) argc = 1;
-                Expr **args = (Expr **)calloc((size_t)argc, sizeof(Expr *));
+                Expr **args = expr_array_new((size_t)argc);
                 if (!args) goto oom;
                 for (int k = argc - 1; k >= 0; k--) {
                     Expr *arg = stack_pop(st->stack, &st->stack_len);
@@ -141,7 +141,7 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
                         arg = expr_new(EXPR_INT);
                         if (!arg) {
                             for (int t = k + 1; t < argc; t++) expr_free(args[t]);
-                            free(args);
+                            expr_array_free(args);
                             goto oom;
                         }
                         arg->int_value = 0;
@@ -153,21 +153,21 @@ Ir2AelStatus ir2ael_expr_handle_misc_ops(Ir2AelState *s, size_t *idx, const IRIn
                 Expr *callee = expr_new(EXPR_VAR);
                 if (!callee) {
                     for (int t = 0; t < argc; t++) expr_free(args[t]);
-                    free(args);
+                    expr_array_free(args);
                     goto oom;
                 }
-                callee->text = _strdup(op_name);
+                callee->text = expr_strdup(op_name);
                 if (!callee->text) {
                     expr_free(callee);
                     for (int t = 0; t < argc; t++) expr_free(args[t]);
-                    free(args);
+                    expr_array_free(args);
                     goto oom;
                 }
                 Expr *ce = expr_new(EXPR_CALL);
                 if (!ce) {
                     expr_free(callee);
                     for (int t = 0; t < argc; t++) expr_free(args[t]);
-                    free(args);
+                    expr_array_free(args);
                     goto oom;
                 }
                 ce->lhs = callee;
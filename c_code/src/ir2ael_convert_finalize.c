@@ -51,7 +51,7 @@ Ir2AelStatus ir2ael_finalize(Ir2AelState *s) {
                 }
                 if (!ael_emit_at(s->out, s->out->line0, 0)) return IR2AEL_STATUS_FAIL_EMIT;
                 if (!ael_emit_text(s->out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-                anon_depth_pop_expected(&s->anon_depth_sp, s->anon_depth_stack, ctx->depth + 1, true);
+                anon_depth_pop_expected(&s->anon, ctx->depth + 1, true);
             }
             s->if_sp--;
         }
@@ -68,11 +68,11 @@ Ir2AelStatus ir2ael_finalize(Ir2AelState *s) {
                 }
                 if (!ael_emit_at(s->out, s->out->line0, close_col0)) return IR2AEL_STATUS_FAIL_EMIT;
                 if (!ael_emit_text(s->out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-                anon_depth_pop_expected(&s->anon_depth_sp, s->anon_depth_stack, ctx->depth + 1, true);
+                anon_depth_pop_expected(&s->anon, ctx->depth + 1, true);
             }
             s->if_sp--;
         }
-        if (!anon_close_scope_blocks_at_function_end(s->out, &s->anon_depth_sp, s->anon_depth_stack, 1, s->out->line0)) {
+        if (!anon_close_scope_blocks_at_function_end(s->out, &s->anon, 1, s->out->line0)) {
             return IR2AEL_STATUS_FAIL_EMIT;
         }
         if (!ael_emit_at(s->out, s->out->line0, 0)) return IR2AEL_STATUS_FAIL_EMIT;
@@ -80,7 +80,7 @@ Ir2AelStatus ir2ael_finalize(Ir2AelState *s) {
         s->in_function = false;
         s->function_brace_open = false;
         local_init_clear(&s->local_init);
-        s->anon_depth_sp = 0;
+        s->anon.sp = 0;
         s->if_sp = 0;
         s->loop_sp = 0;
         s->for_hdr_sp = 0;
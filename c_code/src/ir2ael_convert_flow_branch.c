@@ -72,7 +72,7 @@ static Ir2AelStatus handle_branch_true_while_header_terminator(Ir2AelState *st,
     lctx->header_col0 = lparen_col0;
     lctx->cond_rparen_col0 = rparen_col0;
     lctx->header_emitted = true;
-    (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, st->cur_depth + 1, true);
+    (void)anon_depth_push_marked(&st->anon, st->cur_depth + 1, true);
 
     stack_clear(st->stack, &st->stack_len);
     return IR2AEL_STATUS_HANDLED;
@@ -150,7 +150,7 @@ static Ir2AelStatus handle_branch_true_for_header_empty_init(Ir2AelState *st, si
     }
 
     int lparen_col0 = -1;
-    if (!find_for_header_lparen_col0(program, i, 4096, line0, incr_label, loop_label2, &lparen_col0)) {
+    if (!find_for_header_lparen_col0(program, i, IR2AEL_SCAN_FOR_LPAREN, line0, incr_label, loop_label2, &lparen_col0)) {
         lparen_col0 = semi2_col0 - 6;
         if (lparen_col0 < 0) lparen_col0 = 0;
     }
@@ -219,17 +219,16 @@ static Ir2AelStatus handle_branch_true_for_header_empty_init(Ir2AelState *st, si
     if (!ael_emit_at(out, line0, semi2_col0)) return IR2AEL_STATUS_FAIL_EMIT;
     if (!ael_emit_text(out, "; ")) return IR2AEL_STATUS_FAIL_EMIT;
 
-    if (st->for_hdr_sp < (int)(sizeof(st->for_hdr_stack) / sizeof(st->for_hdr_stack[0]))) {
+    if (ir2ael_for_hdr_stack_reserve(st)) {
         st->for_hdr_stack[st->for_hdr_sp].line0 = line0;
         st->for_hdr_stack[st->for_hdr_sp].cond_start_col0 = semi2_col0 + 2;
         st->for_hdr_stack[st->for_hdr_sp].stage = 2; /* next: update */
         st->for_hdr_sp++;
     } else {
-        if (err && err_cap) snprintf(err, err_cap, "for header stack overflow at IR index %zu", i);
-        return IR2AEL_STATUS_FAIL;
+        return IR2AEL_STATUS_OOM;
     }
 
-    if (st->loop_sp < (int)(sizeof(st->loop_stack) / sizeof(st->loop_stack[0]))) {
+    if (ir2ael_loop_stack_reserve(st)) {
         st->loop_stack[st->loop_sp].kind = 3; /* for */
         st->loop_stack[st->loop_sp].depth = st->cur_depth;
         st->loop_stack[st->loop_sp].start_label = -1;
@@ -241,6 +240,8 @@ static Ir2AelStatus handle_branch_true_for_header_empty_init(Ir2AelState *st, si
         st->loop_stack[st->loop_sp].header_emitted = true;
         st->loop_stack[st->loop_sp].body_has_brace = false;
         st->loop_sp++;
+    } else {
+        return IR2AEL_STATUS_OOM;
     }
 
     return IR2AEL_STATUS_HANDLED;
@@ -272,7 +273,7 @@ static Ir2AelStatus handle_branch_true_braced_else_transition(Ir2AelState *st, s
         if (ctx->brace_style) {
             if (!ael_emit_at(out, out->line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
             if (!ael_emit_text(out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-            anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+            anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
         }
         if (!ael_emit_at(out, out->line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
         if (!ael_emit_text(out, "else;\n")) return IR2AEL_STATUS_FAIL_EMIT;
@@ -286,7 +287,7 @@ static Ir2AelStatus handle_branch_true_braced_else_transition(Ir2AelState *st, s
     int found_if_line0 = -1;
     {
         bool saw_stmt = false;
-        for (size_t j = i + 2; j < program->count && j < i + 512; j++) {
+        for (size_t j = i + 2; j < program->count && j < i + IR2AEL_SCAN_STMT_BODY; j++) {
             const IRInst *mj = &program->insts[j];
             if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == ctx->end_label) break;
             if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
@@ -313,7 +314,7 @@ static Ir2AelStatus handle_branch_true_braced_else_transition(Ir2AelState *st, s
 
             if (!ael_emit_at(out, close_line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
             if (!ael_emit_text(out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-            anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+            anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
         }
 
         if (!ael_emit_at(out, found_if_line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
@@ -333,7 +334,7 @@ static Ir2AelStatus handle_branch_true_braced_else_transition(Ir2AelState *st, s
     bool else_body_empty = true;
     {
         bool saw_stmt = false;
-        for (size_t j = i + 2; j < program->count && j < i + 512; j++) {
+        for (size_t j = i + 2; j < program->count && j < i + IR2AEL_SCAN_STMT_BODY; j++) {
             const IRInst *mj = &program->insts[j];
             if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == ctx->end_label) break;
             if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
@@ -349,7 +350,7 @@ static Ir2AelStatus handle_branch_true_braced_else_transition(Ir2AelState *st, s
         if (ctx->brace_style) {
             if (!ael_emit_at(out, out->line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
             if (!ael_emit_text(out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-            anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+            anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
         }
         if (!ael_emit_at(out, out->line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
         if (!ael_emit_text(out, "else;\n")) return IR2AEL_STATUS_FAIL_EMIT;
@@ -374,7 +375,7 @@ static Ir2AelStatus handle_branch_true_braced_else_transition(Ir2AelState *st, s
     int indent_col0 = ctx->depth * 4;
     if (!ael_emit_at(out, out->line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
     if (!ael_emit_text(out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-    anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+    anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
 
     if (!ael_emit_at(out, out->line0, indent_col0)) return IR2AEL_STATUS_FAIL_EMIT;
     if (!else_has_block) {
@@ -392,7 +393,7 @@ static Ir2AelStatus handle_branch_true_braced_else_transition(Ir2AelState *st, s
     } else {
         if (!ael_emit_text(out, "else {\n")) return IR2AEL_STATUS_FAIL_EMIT;
     }
-    (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+    (void)anon_depth_push_marked(&st->anon, ctx->depth + 1, true);
     ctx->else_brace_style = true;
     ctx->stage = 2;
     *idx = i + 1; /* consume SET_LABEL else_label */
@@ -431,7 +432,7 @@ static Ir2AelStatus handle_branch_true_break_continue(Ir2AelState *st, size_t i,
             if (switch_is_epilogue_branch(program, i, &st->sw)) {
                 return IR2AEL_STATUS_HANDLED;
             }
-            if (!switch_emit_pending_case_before_stmt(out, &st->sw, stmt_line0, stmt_col0, &st->anon_depth_sp, st->anon_depth_stack)) return IR2AEL_STATUS_FAIL_EMIT;
+            if (!switch_emit_pending_case_before_stmt(out, &st->sw, stmt_line0, stmt_col0, &st->anon)) return IR2AEL_STATUS_FAIL_EMIT;
             if (!stmt_emit_at_or_current(out, &stmt_line0, &stmt_col0, st->cur_depth)) return IR2AEL_STATUS_FAIL_EMIT;
             if (!ael_emit_text(out, "break;\n")) return IR2AEL_STATUS_FAIL_EMIT;
             st->sw.last_break_line0 = stmt_line0;
@@ -549,7 +550,7 @@ static Ir2AelStatus handle_branch_true_while_header_negated(Ir2AelState *st, siz
     expr_free(cond);
     if (emit_status != IR2AEL_STATUS_HANDLED) return emit_status;
 
-    if (st->loop_sp < (int)(sizeof(st->loop_stack) / sizeof(st->loop_stack[0]))) {
+    if (ir2ael_loop_stack_reserve(st)) {
         st->loop_stack[st->loop_sp].kind = 1; /* while */
         st->loop_stack[st->loop_sp].depth = st->cur_depth;
         st->loop_stack[st->loop_sp].start_label = -1;
@@ -567,8 +568,10 @@ static Ir2AelStatus handle_branch_true_while_header_negated(Ir2AelState *st, siz
         st->loop_stack[st->loop_sp].end_label = inst->arg1;
         st->loop_stack[st->loop_sp].header_emitted = true;
         st->loop_sp++;
+    } else {
+        return IR2AEL_STATUS_OOM;
     }
-    (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, st->cur_depth + 1, true);
+    (void)anon_depth_push_marked(&st->anon, st->cur_depth + 1, true);
     return IR2AEL_STATUS_HANDLED;
 }
 
@@ -634,7 +637,7 @@ static Ir2AelStatus handle_branch_true_do_while_footer(Ir2AelState *st, size_t i
 
     {
         LoopCtx *lctx = &st->loop_stack[st->loop_sp - 1];
-        anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, lctx->depth + 1, true);
+        anon_depth_pop_expected(&st->anon, lctx->depth + 1, true);
     }
     st->loop_sp--;
     return IR2AEL_STATUS_HANDLED;
@@ -32,25 +32,25 @@ Ir2AelStatus ir2ael_flow_handle_end_loop(Ir2AelState *s, size_t *idx, const IRIn
                 if (is_this_for_end) {
                     if (lctx->body_has_brace) {
                         if (!ael_emit_text(out, "}\n")) goto fail_emit;
-                        anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, st->cur_depth + 1, true);
+                        anon_depth_pop_expected(&st->anon, st->cur_depth + 1, true);
                     }
                     st->loop_sp--;
                 }
             }
             if (st->sw.active) {
-                if (!switch_emit_pending_case_label_only(out, &st->sw, &st->anon_depth_sp, st->anon_depth_stack)) goto fail_emit;
+                if (!switch_emit_pending_case_label_only(out, &st->sw, &st->anon)) goto fail_emit;
                 int close_line0 = out->line0;
                 int min_close_line0 = (st->sw.last_break_line0 >= 0) ? (st->sw.last_break_line0 + 1) : (st->sw.line0 + 1);
                 if (close_line0 < min_close_line0) close_line0 = min_close_line0;
                 if (!st->sw.opened) {
                     if (!ael_emit_text(out, " {\n")) goto fail_emit;
                     st->sw.opened = true;
-                    (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, st->sw.depth + 1, true);
+                    (void)anon_depth_push_marked(&st->anon, st->sw.depth + 1, true);
                 }
                 if (close_line0 < out->line0) close_line0 = out->line0;
                 if (!ael_emit_at(out, close_line0, st->sw.col0)) goto fail_emit;
                 if (!ael_emit_text(out, "}\n")) goto fail_emit;
-                anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, st->sw.depth + 1, true);
+                anon_depth_pop_expected(&st->anon, st->sw.depth + 1, true);
                 st->sw.active = false;
             }
             continue;
@@ -43,10 +43,10 @@ Ir2AelStatus ir2ael_flow_handle_add_label(Ir2AelState *s, size_t *idx, const IRI
                         close_line0 = out->line0;
                         close_col0 = decl_indent_col0_from_depth(st->cur_depth);
                     }
-                    if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, close_line0)) goto fail_emit;
+                    if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, ctx->depth + 1, close_line0)) goto fail_emit;
                     if (!ael_emit_at(out, close_line0, close_col0)) goto fail_emit;
                     if (!ael_emit_text(out, "}\n")) goto fail_emit;
-                    anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+                    anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
                 }
 
                 int else_line0 = (brace_style || out->line0 <= close_line0) ? (close_line0 + 1) : out->line0;
@@ -67,7 +67,7 @@ Ir2AelStatus ir2ael_flow_handle_add_label(Ir2AelState *s, size_t *idx, const IRI
                        otherwise we can misclassify "else { stmt; if(...) ... }" and perturb label numbering. */
                     int found_if_line0 = -1;
                     bool saw_stmt = false;
-                    size_t scan_end = i + 256;
+                    size_t scan_end = i + IR2AEL_SCAN_ELSE_IF;
                     if (scan_end > program->count) scan_end = program->count;
                     for (size_t j = i + 4; j < scan_end; j++) {
                         const IRInst *mj = &program->insts[j];
@@ -90,7 +90,7 @@ Ir2AelStatus ir2ael_flow_handle_add_label(Ir2AelState *s, size_t *idx, const IRI
                         }
                     }
                 } else {
-                    for (size_t j = i + 4; j + 3 < program->count && j < i + 256; j++) {
+                    for (size_t j = i + 4; j + 3 < program->count && j < i + IR2AEL_SCAN_ELSE_IF; j++) {
                         const IRInst *a = &program->insts[j];
                         if (a->op == OP_OP && a->has_arg1 && a->arg1 == 59 && a->has_arg2) {
                             int found_if_line0 = -1;
@@ -138,7 +138,7 @@ Ir2AelStatus ir2ael_flow_handle_add_label(Ir2AelState *s, size_t *idx, const IRI
                 bool else_body_empty = false;
                 {
                     bool saw_stmt = false;
-                    for (size_t j = i + 4; j < program->count && j < i + 512; j++) {
+                    for (size_t j = i + 4; j < program->count && j < i + IR2AEL_SCAN_STMT_BODY; j++) {
                         const IRInst *mj = &program->insts[j];
                         if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == end_label) {
                             else_body_empty = !saw_stmt;
@@ -187,7 +187,7 @@ Ir2AelStatus ir2ael_flow_handle_add_label(Ir2AelState *s, size_t *idx, const IRI
                     } else {
                         if (!ael_emit_text(out, "else {\n")) goto fail_emit;
                     }
-                    (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+                    (void)anon_depth_push_marked(&st->anon, ctx->depth + 1, true);
                     ctx->else_brace_style = true;
                     ctx->end_label = end_label;
                     ctx->stage = 2;
@@ -242,11 +242,11 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                     is_while_end = true;
                 }
                 if (is_while_end) {
-                    if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, lctx->depth + 1, out->line0)) {
+                    if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, lctx->depth + 1, out->line0)) {
                         goto fail_emit;
                     }
                     if (!ael_emit_text(out, "}\n")) goto fail_emit;
-                    anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, lctx->depth + 1, true);
+                    anon_depth_pop_expected(&st->anon, lctx->depth + 1, true);
                     st->loop_sp--;
                     continue;
                 }
@@ -291,9 +291,9 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
 
                         /* Close braced then-body before emitting else. */
                         if (ctx->brace_style) {
-                            if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, out->line0)) goto fail_emit;
+                            if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, ctx->depth + 1, out->line0)) goto fail_emit;
                             if (!ael_emit_text(out, "}\n")) goto fail_emit;
-                            anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+                            anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
                         }
 
                         /* If the else-label is immediately followed by another label at the same-or-lower
@@ -320,7 +320,7 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                         }
 
                         int else_line_hint = out->line0;
-                        for (size_t j = i + 1; j < program->count && j < i + 512; j++) {
+                        for (size_t j = i + 1; j < program->count && j < i + IR2AEL_SCAN_STMT_BODY; j++) {
                             const IRInst *mj = &program->insts[j];
                             if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == ctx->end_label) break;
                             if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
@@ -373,7 +373,7 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                             } else {
                                 if (!ael_emit_text(out, "else {\n")) goto fail_emit;
                             }
-                            (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+                            (void)anon_depth_push_marked(&st->anon, ctx->depth + 1, true);
                             ctx->else_brace_style = true;
                         } else {
                             if (!ael_emit_text(out, "else\n")) goto fail_emit;
@@ -387,7 +387,7 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                         int else_line0 = -1;
                         int found_if_line0 = -1;
                         bool else_inline = false;
-                        for (size_t j = i + 1; j < program->count && j < i + 256; j++) {
+                        for (size_t j = i + 1; j < program->count && j < i + IR2AEL_SCAN_ELSE_IF; j++) {
                             const IRInst *mj = &program->insts[j];
                             if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == ctx->end_label) break;
                             if (mj->op == OP_OP && mj->has_arg1 && mj->has_arg2 &&
@@ -419,7 +419,7 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                         if (!ael_emit_at(out, else_line0, else_col0)) goto fail_emit;
                         bool else_has_block = false;
                         bool else_body_empty = true;
-                        for (size_t j = i + 1; j < program->count && j < i + 512; j++) {
+                        for (size_t j = i + 1; j < program->count && j < i + IR2AEL_SCAN_STMT_BODY; j++) {
                             const IRInst *mj = &program->insts[j];
                             if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == ctx->end_label) break;
                             if (mj->op == OP_OP && mj->has_arg1 &&
@@ -439,7 +439,7 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                             if (!ael_emit_text(out, "else\n")) goto fail_emit;
                             if (!ael_emit_at(out, else_line0 + 1, else_col0)) goto fail_emit;
                             if (!ael_emit_text(out, "{\n")) goto fail_emit;
-                            (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+                            (void)anon_depth_push_marked(&st->anon, ctx->depth + 1, true);
                             ctx->else_brace_style = true;
                             ctx->stage = 2;
                             continue;
@@ -465,7 +465,7 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                             int else_line0 = -1;
                             int found_if_line0 = -1;
                             bool else_inline = false;
-                            for (size_t j = i + 1; j < program->count && j < i + 256; j++) {
+                            for (size_t j = i + 1; j < program->count && j < i + IR2AEL_SCAN_ELSE_IF; j++) {
                                 const IRInst *mj = &program->insts[j];
                                 if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == inferred_end_label) break;
                                 if (mj->op == OP_OP && mj->has_arg1 && mj->has_arg2 &&
@@ -503,9 +503,9 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                     }
                     /* if without else: close then block */
                     if (ctx->brace_style) {
-                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, out->line0)) goto fail_emit;
+                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, ctx->depth + 1, out->line0)) goto fail_emit;
                         if (!ael_emit_text(out, "}\n")) goto fail_emit;
-                        anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+                        anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
                     }
                     st->if_sp--;
                     continue;
@@ -513,9 +513,9 @@ Ir2AelStatus ir2ael_flow_handle_set_label(Ir2AelState *s, size_t *idx, const IRI
                 if (ctx->stage == 2 && ctx->end_label >= 0 && inst->arg1 == ctx->end_label) {
                     /* end of else block */
                     if (ctx->else_brace_style) {
-                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, out->line0)) goto fail_emit;
+                        if (st->in_function && !anon_close_scopes_before_stmt(out, &st->anon, ctx->depth + 1, out->line0)) goto fail_emit;
                         if (!ael_emit_text(out, "}\n")) goto fail_emit;
-                        anon_depth_pop_expected(&st->anon_depth_sp, st->anon_depth_stack, ctx->depth + 1, true);
+                        anon_depth_pop_expected(&st->anon, ctx->depth + 1, true);
                     }
                     st->if_sp--;
                     continue;
@@ -80,7 +80,7 @@ Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *idx, const IR
                 st->sw.last_break_line0 = -1;
 
                 /* Learn the BRANCH_TABLE entry label (SET_LABEL just before OP_BRANCH_TABLE). */
-                for (size_t j = i; j < program->count && j < i + 256; j++) {
+                for (size_t j = i; j < program->count && j < i + IR2AEL_SCAN_ELSE_IF; j++) {
                     if (program->insts[j].op == OP_BRANCH_TABLE) {
                         if (j > 0 && program->insts[j - 1].op == OP_SET_LABEL && program->insts[j - 1].has_arg1) {
                             st->sw.table_label = program->insts[j - 1].arg1;
@@ -93,7 +93,7 @@ Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *idx, const IR
                 if (!out->strict_pos) {
                     if (!ael_emit_text(out, " {\n")) goto fail_emit;
                     st->sw.opened = true;
-                    (void)anon_depth_push_marked(&st->anon_depth_sp, st->anon_depth_stack, st->sw.depth + 1, true);
+                    (void)anon_depth_push_marked(&st->anon, st->sw.depth + 1, true);
                 }
 
                 continue;
@@ -114,7 +114,7 @@ Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *idx, const IR
                 if (skip_do_while) {
                     /* For/iter-style loop scaffold; do not misclassify as do-while. */
                 } else {
-                if (st->loop_sp < (int)(sizeof(st->loop_stack) / sizeof(st->loop_stack[0]))) {
+                if (ir2ael_loop_stack_reserve(st)) {
                     st->loop_stack[st->loop_sp].kind = 2; /* do-while */
                     st->loop_stack[st->loop_sp].depth = st->cur_depth;
                     st->loop_stack[st->loop_sp].start_label = program->insts[i + 1].arg1;
@@ -128,7 +128,7 @@ Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *idx, const IR
                     st->loop_stack[st->loop_sp].header_emitted = false;
 
                     /* Scan ahead for the trailing BRANCH_TRUE back to start_label to learn 'while' position. */
-                    for (size_t j = i + 1; j < program->count && j < i + 256; j++) {
+                    for (size_t j = i + 1; j < program->count && j < i + IR2AEL_SCAN_ELSE_IF; j++) {
                         const IRInst *mj = &program->insts[j];
                         if (mj->op == OP_BRANCH_TRUE && mj->has_arg1 &&
                             mj->arg1 == st->loop_stack[st->loop_sp].start_label &&
@@ -139,6 +139,8 @@ Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *idx, const IR
                         }
                     }
                     st->loop_sp++;
+                } else {
+                    RETURN_STATUS(IR2AEL_STATUS_OOM);
                 }
                 }
             }
@@ -148,7 +150,7 @@ Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *idx, const IR
                 program->insts[i + 1].op == OP_LOOP_AGAIN &&
                 program->insts[i + 2].op == OP_ADD_LABEL &&
                 program->insts[i + 3].op == OP_SET_LABEL && program->insts[i + 3].has_arg1) {
-                if (st->loop_sp < (int)(sizeof(st->loop_stack) / sizeof(st->loop_stack[0]))) {
+                if (ir2ael_loop_stack_reserve(st)) {
                     st->loop_stack[st->loop_sp].kind = 1; /* while */
                     st->loop_stack[st->loop_sp].depth = st->cur_depth;
                     st->loop_stack[st->loop_sp].start_label = program->insts[i + 3].arg1;
@@ -161,6 +163,8 @@ Ir2AelStatus ir2ael_flow_handle_begin_loop(Ir2AelState *s, size_t *idx, const IR
                     st->loop_stack[st->loop_sp].header_col0 = -1;
                     st->loop_stack[st->loop_sp].header_emitted = false;
                     st->loop_sp++;
+                } else {
+                    RETURN_STATUS(IR2AEL_STATUS_OOM);
                 }
                 continue;
             }
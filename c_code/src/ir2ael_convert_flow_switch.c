@@ -25,7 +25,7 @@ Ir2AelStatus ir2ael_flow_handle_switch_ops(Ir2AelState *s, size_t *idx, const IR
     if (inst->op == OP_ADD_CASE) {
         do {
                 if (st->sw.active && inst->has_arg1) {
-                    if (!switch_emit_pending_case_label_only(out, &st->sw, &st->anon_depth_sp, st->anon_depth_stack)) goto fail_emit;
+                    if (!switch_emit_pending_case_label_only(out, &st->sw, &st->anon)) goto fail_emit;
                     st->sw.pending_case_kind = 1;
                     st->sw.pending_case_value = inst->arg1;
                     st->sw.pending_case_emitted = false;
@@ -37,7 +37,7 @@ Ir2AelStatus ir2ael_flow_handle_switch_ops(Ir2AelState *s, size_t *idx, const IR
     if (inst->op == OP_SET_LOOP_DEFAULT) {
         do {
                 if (st->sw.active) {
-                    if (!switch_emit_pending_case_label_only(out, &st->sw, &st->anon_depth_sp, st->anon_depth_stack)) goto fail_emit;
+                    if (!switch_emit_pending_case_label_only(out, &st->sw, &st->anon)) goto fail_emit;
                     st->sw.pending_case_kind = 2;
                     st->sw.pending_case_emitted = false;
                 }
@@ -57,7 +57,7 @@ Ir2AelStatus ir2ael_handle_load_ops(Ir2AelState *s, const IRInst *inst) {
     if (inst->op == OP_LOAD_STR) {
         Expr *e = expr_new(EXPR_STR);
         if (!e) return IR2AEL_STATUS_OOM;
-        e->text = inst->str ? _strdup(inst->str) : _strdup("");
+        e->text = expr_text_ref(inst->str);
         if (!e->text) {
             expr_free(e);
             return IR2AEL_STATUS_OOM;
@@ -71,7 +71,8 @@ Ir2AelStatus ir2ael_handle_load_ops(Ir2AelState *s, const IRInst *inst) {
     if (inst->op == OP_LOAD_VAR) {
         Expr *e = expr_new(EXPR_VAR);
         if (!e) return IR2AEL_STATUS_OOM;
-        e->text = inst->str ? _strdup(inst->str) : _strdup("");
+        e->text = expr_text_ref(inst->str);
+        e->text_id = inst->str_id;
         if (!e->text) {
             expr_free(e);
             return IR2AEL_STATUS_OOM;
@@ -0,0 +1,257 @@
+/* ir2ael_convert_parallel.c - per-function conversion on worker threads */
+#include "ir2ael_internal.h"
+#include "ir_label_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define IR2AEL_MAX_THREADS 64
+
+typedef struct MemSink {
+    char *data;
+    size_t len;
+    size_t cap;
+} MemSink;
+
+typedef struct ParallelCtx {
+    const IRProgram *program;
+    const Ir2AelRegions *regions;
+    bool allow_scope_blocks;
+    Ir2AelFunctionJob *jobs;
+    size_t count;
+#if defined(_WIN32)
+    volatile LONG next;
+#else
+    volatile long next;
+#endif
+} ParallelCtx;
+
+static bool mem_sink(void *ctx, const char *data, size_t len) {
+    MemSink *m = (MemSink *)ctx;
+    if (len > m->cap - m->len) {
+        size_t ncap = m->cap ? m->cap : 4096;
+        while (ncap - m->len < len) ncap *= 2;
+        char *nd = (char *)realloc(m->data, ncap);
+        if (!nd) return false;
+        m->data = nd;
+        m->cap = ncap;
+    }
+    memcpy(m->data + m->len, data, len);
+    m->len += len;
+    return true;
+}
+
+/*
+ * Converts one function exactly as the main loop would after resetting its state at the BEGIN_FUNCT,
+ * with the output positioned at the defun line. Any failure just leaves the job unusable; the main
+ * loop then converts that function itself (and reports the error, if there is one).
+ */
+static void run_job(const ParallelCtx *ctx, Ir2AelFunctionJob *job) {
+    MemSink ms;
+    memset(&ms, 0, sizeof(ms));
+    AelEmitter out;
+    if (!ael_emit_init_sink(&out, mem_sink, &ms, true)) return;
+    out.allow_num_local_scope_blocks = ctx->allow_scope_blocks;
+    out.line0 = job->line0;
+
+    char err[256];
+    Ir2AelState st;
+    ir2ael_state_init_borrowed(&st, ctx->program, &out, err, sizeof(err), ctx->regions);
+
+    size_t i = job->begin;
+    bool ok = true;
+    for (; i < job->end; i++) {
+        if (ir2ael_convert_inst(&st, &i) < 0) {
+            ok = false;
+            break;
+        }
+    }
+    /* A handler that consumed past DEFINE_FUNCT, or a dangling expression, means the range was not self-contained. */
+    ok = ok && i == job->end && st.stack_len == 0 && ael_emit_flush(&out);
+
+    Ir2AelState *final_state = ok ? (Ir2AelState *)calloc(1, sizeof(*final_state)) : NULL;
+    if (final_state && !ir2ael_state_adopt(final_state, &st)) {
+        ir2ael_state_free_stacks(final_state);
+        free(final_state);
+        final_state = NULL;
+    }
+    if (final_state) {
+        job->final_state = final_state;
+        job->text = ms.data;
+        job->text_len = ms.len;
+        job->end_line0 = out.line0;
+        job->end_col0 = out.col0;
+        job->last_req_line0 = out.last_req_line0;
+        job->last_req_col0 = out.last_req_col0;
+        job->last_fail_reason = out.last_fail_reason;
+        job->ok = true;
+    } else {
+        free(ms.data);
+    }
+    ael_emit_free(&out);
+    ir2ael_state_free(&st);
+}
+
+static long next_job(ParallelCtx *ctx) {
+#if defined(_WIN32)
+    return (long)InterlockedIncrement(&ctx->next) - 1;
+#else
+    return __sync_fetch_and_add(&ctx->next, 1);
+#endif
+}
+
+static void drain_jobs(ParallelCtx *ctx) {
+    for (;;) {
+        long idx = next_job(ctx);
+        if (idx < 0 || (size_t)idx >= ctx->count) break;
+        run_job(ctx, &ctx->jobs[idx]);
+    }
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI job_worker(LPVOID arg) {
+    drain_jobs((ParallelCtx *)arg);
+    return 0;
+}
+#else
+static void *job_worker(void *arg) {
+    drain_jobs((ParallelCtx *)arg);
+    return NULL;
+}
+#endif
+
+static int cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/* Top-level functions whose BEGIN_FUNCT..DEFINE_FUNCT range contains no other function boundary. */
+static bool collect_jobs(Ir2AelParallel *par, const IRProgram *program, const Ir2AelRegions *tree) {
+    size_t n = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t k = 0; k < tree->region_count; k++) {
+            const Ir2AelRegion *r = &tree->regions[k];
+            if (r->kind != IR2AEL_REGION_FUNCTION || r->parent != -1) continue;
+            if (r->end <= r->begin + 1 || program->insts[r->end - 1].op != OP_DEFINE_FUNCT) continue;
+            if (ir_next_funct_boundary(program, r->begin + 1, r->end) != r->end - 1) continue;
+            if (pass == 1) {
+                Ir2AelFunctionJob *job = &par->jobs[par->count++];
+                memset(job, 0, sizeof(*job));
+                job->begin = r->begin;
+                job->end = r->end;
+                const IRInst *b = &program->insts[r->begin];
+                job->line0 = b->has_arg1 ? b->arg1 : 0;
+            } else {
+                n++;
+            }
+        }
+        if (pass == 0) {
+            if (n < 2) return false;
+            par->jobs = (Ir2AelFunctionJob *)malloc(n * sizeof(*par->jobs));
+            if (!par->jobs) return false;
+        }
+    }
+    return true;
+}
+
+bool ir2ael_parallel_prepare(Ir2AelParallel *par, const Ir2AelState *s, int threads) {
+    if (!par) return false;
+    memset(par, 0, sizeof(*par));
+    /* Non-strict output depends on where the previous item left the emitter, so it stays sequential. */
+    if (!s || !s->out || !s->out->strict_pos || !s->regions.valid || threads == 1) return false;
+    if (!collect_jobs(par, s->program, &s->regions)) {
+        ir2ael_parallel_free(par);
+        return false;
+    }
+
+    if (threads <= 0) threads = cpu_count();
+    if (threads > IR2AEL_MAX_THREADS) threads = IR2AEL_MAX_THREADS;
+    if ((size_t)threads > par->count) threads = (int)par->count;
+
+    ParallelCtx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.program = s->program;
+    ctx.regions = &s->regions;
+    ctx.allow_scope_blocks = s->out->allow_num_local_scope_blocks;
+    ctx.jobs = par->jobs;
+    ctx.count = par->count;
+
+    /* The calling thread is one of the workers. */
+    int started = 0;
+#if defined(_WIN32)
+    HANDLE handles[IR2AEL_MAX_THREADS];
+    for (int t = 1; t < threads; t++) {
+        handles[started] = CreateThread(NULL, 0, job_worker, &ctx, 0, NULL);
+        if (handles[started]) started++;
+    }
+    drain_jobs(&ctx);
+    if (started > 0) {
+        WaitForMultipleObjects((DWORD)started, handles, TRUE, INFINITE);
+        for (int t = 0; t < started; t++) CloseHandle(handles[t]);
+    }
+#else
+    pthread_t handles[IR2AEL_MAX_THREADS];
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&handles[started], NULL, job_worker, &ctx) == 0) started++;
+    }
+    drain_jobs(&ctx);
+    for (int t = 0; t < started; t++) pthread_join(handles[t], NULL);
+#endif
+    return true;
+}
+
+void ir2ael_parallel_free(Ir2AelParallel *par) {
+    if (!par) return;
+    for (size_t k = 0; k < par->count; k++) {
+        free(par->jobs[k].text);
+        ir2ael_state_free_stacks(par->jobs[k].final_state);
+        free(par->jobs[k].final_state);
+    }
+    free(par->jobs);
+    memset(par, 0, sizeof(*par));
+}
+
+Ir2AelStatus ir2ael_parallel_splice(Ir2AelState *s, const Ir2AelParallel *par, size_t *i) {
+    if (!s || !par || !i || par->count == 0) return IR2AEL_STATUS_NOT_HANDLED;
+
+    size_t lo = 0, hi = par->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (par->jobs[mid].begin < *i) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo >= par->count || par->jobs[lo].begin != *i || !par->jobs[lo].ok) return IR2AEL_STATUS_NOT_HANDLED;
+    const Ir2AelFunctionJob *job = &par->jobs[lo];
+
+    /*
+     * The job ran from a fresh state. Of what a quiescent state carries into the next function, only
+     * cur_depth is read before the function sets it itself, and only if BEGIN_FUNCT has no depth.
+     */
+    if (!s->program->insts[*i].has_depth && s->cur_depth != 0) return IR2AEL_STATUS_NOT_HANDLED;
+
+    /* The buffer was produced from (line0, 0); only usable if the emitter can get there. */
+    AelEmitter *out = s->out;
+    if (out->line0 > job->line0 || (out->line0 == job->line0 && out->col0 != 0)) return IR2AEL_STATUS_NOT_HANDLED;
+
+    if (!ael_emit_at(out, job->line0, 0)) return IR2AEL_STATUS_FAIL_EMIT;
+    if (!ael_emit_bytes(out, job->text, job->text_len)) return IR2AEL_STATUS_FAIL_EMIT;
+    out->last_req_line0 = job->last_req_line0;
+    out->last_req_col0 = job->last_req_col0;
+    out->last_fail_reason = job->last_fail_reason;
+
+    if (!ir2ael_state_adopt(s, job->final_state)) return IR2AEL_STATUS_OOM;
+    *i = job->end - 1;
+    return IR2AEL_STATUS_HANDLED;
+}
@@ -23,11 +23,11 @@ Ir2AelStatus ir2ael_handle_scope_ops(Ir2AelState *s, size_t *i, const IRInst *in
                 int indent_col0 = rcol0 - name_len - 4;
                 if (indent_col0 < 0) indent_col0 = 0;
 
-                if (!switch_emit_pending_case_before_stmt(s->out, &s->sw, stmt_line0, indent_col0, &s->anon_depth_sp, s->anon_depth_stack)) {
+                if (!switch_emit_pending_case_before_stmt(s->out, &s->sw, stmt_line0, indent_col0, &s->anon)) {
                     expr_free(lhs);
                     return IR2AEL_STATUS_FAIL_EMIT;
                 }
-                if (s->in_function && !anon_close_scopes_before_stmt(s->out, &s->anon_depth_sp, s->anon_depth_stack, s->cur_depth, stmt_line0)) {
+                if (s->in_function && !anon_close_scopes_before_stmt(s->out, &s->anon, s->cur_depth, stmt_line0)) {
                     expr_free(lhs);
                     return IR2AEL_STATUS_FAIL_EMIT;
                 }
@@ -58,7 +58,7 @@ Ir2AelStatus ir2ael_handle_scope_ops(Ir2AelState *s, size_t *i, const IRInst *in
             if (lctx->depth > 0 && inst->depth == lctx->depth + 1) {
                 int stmt_line0 = -1;
                 int stmt_col0 = 0;
-                for (size_t j = *i + 1; j < s->program->count && j < *i + 512; j++) {
+                for (size_t j = *i + 1; j < s->program->count && j < *i + IR2AEL_SCAN_STMT_BODY; j++) {
                     const IRInst *mj = &s->program->insts[j];
                     if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
                     if (mj->op == OP_END_LOOP) break;
@@ -88,13 +88,13 @@ Ir2AelStatus ir2ael_handle_scope_ops(Ir2AelState *s, size_t *i, const IRInst *in
                 }
 
                 lctx->header_emitted = true;
-                (void)anon_depth_push_marked(&s->anon_depth_sp, s->anon_depth_stack, lctx->depth + 1, true);
+                (void)anon_depth_push_marked(&s->anon, lctx->depth + 1, true);
             }
         }
 
         if (s->out->allow_num_local_scope_blocks && s->in_function && inst->has_depth && inst->depth > 1) {
             int target_depth = inst->depth;
-            int cur_abs_depth = anon_block_current_depth(s->anon_depth_stack, s->anon_depth_sp);
+            int cur_abs_depth = anon_block_current_depth(&s->anon);
             if (cur_abs_depth < 1) cur_abs_depth = 1;
             bool allow_open = (!s->out->strict_pos) ? true : num_local_should_open_scope_block(s->program, *i, target_depth);
             if (target_depth > cur_abs_depth && s->stack_len == 0 && allow_open) {
@@ -107,7 +107,7 @@ Ir2AelStatus ir2ael_handle_scope_ops(Ir2AelState *s, size_t *i, const IRInst *in
                     decl_group_clear(&s->pending_decls);
                 }
                 int brace_line0 = s->out->line0;
-                if (!anon_block_open_to(s->out, &s->anon_depth_sp, s->anon_depth_stack, target_depth, brace_line0)) {
+                if (!anon_block_open_to(s->out, &s->anon, target_depth, brace_line0)) {
                     return IR2AEL_STATUS_FAIL_EMIT;
                 }
             }
@@ -129,13 +129,13 @@ Ir2AelStatus ir2ael_handle_scope_ops(Ir2AelState *s, size_t *i, const IRInst *in
             if (!ael_emit_text(s->out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
             s->global_local_block_open = false;
         }
-        if (s->out->allow_num_local_scope_blocks && s->in_function && s->anon_depth_sp > 0) {
-            int v = s->anon_depth_stack[s->anon_depth_sp - 1];
+        if (s->out->allow_num_local_scope_blocks && s->in_function && s->anon.sp > 0) {
+            int v = s->anon.depths[s->anon.sp - 1];
             if (v > 0) {
                 int col0 = decl_indent_col0_from_depth(v - 1);
                 if (!ael_emit_at(s->out, s->out->line0, col0)) return IR2AEL_STATUS_FAIL_EMIT;
                 if (!ael_emit_text(s->out, "}\n")) return IR2AEL_STATUS_FAIL_EMIT;
-                s->anon_depth_sp--;
+                s->anon.sp--;
             }
         }
         return IR2AEL_STATUS_HANDLED;
@@ -3,15 +3,61 @@
 #include <stdlib.h>
 #include <string.h>
 
-void ir2ael_state_init(Ir2AelState *s, const IRProgram *program, AelEmitter *out, char *err, size_t err_cap) {
-    if (!s) return;
-    memset(s, 0, sizeof(*s));
-    s->program = program;
-    s->out = out;
-    s->err = err;
-    s->err_cap = err_cap;
+/* Returns `items` resized to at least `need` entries, or NULL on OOM (callers only ask when need > *cap). */
+static void *grow_items(void *items, int *cap, int need, size_t elem_size) {
+    int ncap = *cap ? *cap * 2 : 16;
+    while (ncap < need) ncap *= 2;
+    void *n = realloc(items, (size_t)ncap * elem_size);
+    if (!n) return NULL;
+    *cap = ncap;
+    return n;
+}
+
+bool ir2ael_if_stack_reserve(Ir2AelState *s) {
+    if (s->if_sp >= s->if_cap) {
+        IfCtx *n = (IfCtx *)grow_items(s->if_stack, &s->if_cap, s->if_sp + 1, sizeof(*n));
+        if (!n) return false;
+        s->if_stack = n;
+    }
+    memset(&s->if_stack[s->if_sp], 0, sizeof(s->if_stack[0]));
+    return true;
+}
+
+bool ir2ael_loop_stack_reserve(Ir2AelState *s) {
+    if (s->loop_sp >= s->loop_cap) {
+        LoopCtx *n = (LoopCtx *)grow_items(s->loop_stack, &s->loop_cap, s->loop_sp + 1, sizeof(*n));
+        if (!n) return false;
+        s->loop_stack = n;
+    }
+    memset(&s->loop_stack[s->loop_sp], 0, sizeof(s->loop_stack[0]));
+    return true;
+}
+
+bool ir2ael_for_hdr_stack_reserve(Ir2AelState *s) {
+    if (s->for_hdr_sp >= s->for_hdr_cap) {
+        ForHeaderCtx *n = (ForHeaderCtx *)grow_items(s->for_hdr_stack, &s->for_hdr_cap, s->for_hdr_sp + 1, sizeof(*n));
+        if (!n) return false;
+        s->for_hdr_stack = n;
+    }
+    memset(&s->for_hdr_stack[s->for_hdr_sp], 0, sizeof(s->for_hdr_stack[0]));
+    return true;
+}
+
+bool ir2ael_defun_param_push(Ir2AelState *s, const char *name) {
+    if (s->pending_defun_param_count >= s->pending_defun_param_cap) {
+        const char **n = (const char **)grow_items((void *)s->pending_defun_params, &s->pending_defun_param_cap,
+                                                   s->pending_defun_param_count + 1, sizeof(*n));
+        if (!n) return false;
+        s->pending_defun_params = n;
+    }
+    s->pending_defun_params[s->pending_defun_param_count++] = name;
+    return true;
+}
+
+/* Initial values of the per-statement/per-function fields (expects a zeroed state). */
+static void state_init_fields(Ir2AelState *s) {
     s->current_defun_line0 = -1;
-    s->pending_defun_name[0] = '\0';
+    s->pending_defun_name = "";
     s->pending_inline_else_line0 = -1;
     s->pending_inline_else_col0 = -1;
     s->sw.table_label = -1;
@@ -20,6 +66,122 @@ void ir2ael_state_init(Ir2AelState *s, const IRProgram *program, AelEmitter *out
     local_init_clear(&s->local_init);
 }
 
+void ir2ael_state_init(Ir2AelState *s, const IRProgram *program, AelEmitter *out, char *err, size_t err_cap) {
+    if (!s) return;
+    memset(s, 0, sizeof(*s));
+    s->program = program;
+    s->out = out;
+    s->err = err;
+    s->err_cap = err_cap;
+    state_init_fields(s);
+    expr_arena_init(&s->expr_arena);
+    s->prev_expr_arena = expr_arena_bind(&s->expr_arena);
+    (void)ir2ael_regions_build(&s->regions, program);
+    s->prev_regions = ir2ael_regions_bind(&s->regions);
+}
+
+void ir2ael_state_init_borrowed(Ir2AelState *s, const IRProgram *program, AelEmitter *out, char *err, size_t err_cap,
+                                const Ir2AelRegions *tree) {
+    if (!s) return;
+    memset(s, 0, sizeof(*s));
+    s->program = program;
+    s->out = out;
+    s->err = err;
+    s->err_cap = err_cap;
+    state_init_fields(s);
+    expr_arena_init(&s->expr_arena);
+    s->prev_expr_arena = expr_arena_bind(&s->expr_arena);
+    /* s->regions stays empty: the shared region tree is only bound, ir2ael_state_free() leaves it alone. */
+    s->prev_regions = ir2ael_regions_bind(tree);
+}
+
+bool ir2ael_state_is_quiescent(const Ir2AelState *s) {
+    if (!s) return false;
+    return !s->pending_defun && !s->in_function && !s->function_brace_open && !s->global_local_block_open &&
+           s->pending_decls.count == 0 && !s->decl_init_chain.active && s->stack_len == 0 &&
+           s->if_sp == 0 && !s->pending_inline_else_if && s->loop_sp == 0 && s->for_hdr_sp == 0 &&
+           !s->sw.active && s->anon.sp == 0;
+}
+
+bool ir2ael_state_adopt(Ir2AelState *s, const Ir2AelState *from) {
+    if (!s) return false;
+    Ir2AelState keep;
+    memcpy(&keep, s, sizeof(keep));
+
+    if (from) {
+        memcpy(s, from, sizeof(*s));
+    } else {
+        memset(s, 0, sizeof(*s));
+        state_init_fields(s);
+    }
+
+    s->program = keep.program;
+    s->out = keep.out;
+    s->err = keep.err;
+    s->err_cap = keep.err_cap;
+    s->stack = keep.stack;
+    s->stack_len = keep.stack_len;
+    s->stack_cap = keep.stack_cap;
+    s->expr_arena = keep.expr_arena;
+    s->prev_expr_arena = keep.prev_expr_arena;
+    s->regions = keep.regions;
+    s->prev_regions = keep.prev_regions;
+    s->local_init = keep.local_init;
+    s->if_stack = keep.if_stack;
+    s->if_cap = keep.if_cap;
+    s->loop_stack = keep.loop_stack;
+    s->loop_cap = keep.loop_cap;
+    s->for_hdr_stack = keep.for_hdr_stack;
+    s->for_hdr_cap = keep.for_hdr_cap;
+    s->pending_defun_params = keep.pending_defun_params;
+    s->pending_defun_param_cap = keep.pending_defun_param_cap;
+    s->anon.depths = keep.anon.depths;
+    s->anon.cap = keep.anon.cap;
+    if (!from) {
+        local_init_clear(&s->local_init);
+        return true;
+    }
+
+    /* Copy the live part of each stack into our own storage. */
+    if (from->if_sp > s->if_cap) {
+        IfCtx *n = (IfCtx *)grow_items(s->if_stack, &s->if_cap, from->if_sp, sizeof(*n));
+        if (!n) return false;
+        s->if_stack = n;
+    }
+    if (from->loop_sp > s->loop_cap) {
+        LoopCtx *n = (LoopCtx *)grow_items(s->loop_stack, &s->loop_cap, from->loop_sp, sizeof(*n));
+        if (!n) return false;
+        s->loop_stack = n;
+    }
+    if (from->for_hdr_sp > s->for_hdr_cap) {
+        ForHeaderCtx *n = (ForHeaderCtx *)grow_items(s->for_hdr_stack, &s->for_hdr_cap, from->for_hdr_sp, sizeof(*n));
+        if (!n) return false;
+        s->for_hdr_stack = n;
+    }
+    if (from->pending_defun_param_count > s->pending_defun_param_cap) {
+        const char **n = (const char **)grow_items((void *)s->pending_defun_params, &s->pending_defun_param_cap,
+                                                   from->pending_defun_param_count, sizeof(*n));
+        if (!n) return false;
+        s->pending_defun_params = n;
+    }
+    if (from->anon.sp > s->anon.cap) {
+        int *n = (int *)grow_items(s->anon.depths, &s->anon.cap, from->anon.sp, sizeof(*n));
+        if (!n) return false;
+        s->anon.depths = n;
+    }
+    if (from->if_sp > 0) memcpy(s->if_stack, from->if_stack, (size_t)from->if_sp * sizeof(*s->if_stack));
+    if (from->loop_sp > 0) memcpy(s->loop_stack, from->loop_stack, (size_t)from->loop_sp * sizeof(*s->loop_stack));
+    if (from->for_hdr_sp > 0) {
+        memcpy(s->for_hdr_stack, from->for_hdr_stack, (size_t)from->for_hdr_sp * sizeof(*s->for_hdr_stack));
+    }
+    if (from->pending_defun_param_count > 0) {
+        memcpy((void *)s->pending_defun_params, (const void *)from->pending_defun_params,
+               (size_t)from->pending_defun_param_count * sizeof(*s->pending_defun_params));
+    }
+    if (from->anon.sp > 0) memcpy(s->anon.depths, from->anon.depths, (size_t)from->anon.sp * sizeof(*s->anon.depths));
+    return local_init_copy(&s->local_init, &from->local_init);
+}
+
 void ir2ael_state_free(Ir2AelState *s) {
     if (!s) return;
     stack_clear(s->stack, &s->stack_len);
@@ -27,4 +189,29 @@ void ir2ael_state_free(Ir2AelState *s) {
     s->stack = NULL;
     s->stack_len = 0;
     s->stack_cap = 0;
+    expr_arena_bind(s->prev_expr_arena);
+    expr_arena_free(&s->expr_arena);
+    ir2ael_regions_bind(s->prev_regions);
+    ir2ael_regions_free(&s->regions);
+    ir2ael_state_free_stacks(s);
+}
+
+void ir2ael_state_free_stacks(Ir2AelState *s) {
+    if (!s) return;
+    free(s->if_stack);
+    free(s->loop_stack);
+    free(s->for_hdr_stack);
+    free((void *)s->pending_defun_params);
+    free(s->anon.depths);
+    s->if_stack = NULL;
+    s->loop_stack = NULL;
+    s->for_hdr_stack = NULL;
+    s->pending_defun_params = NULL;
+    s->anon.depths = NULL;
+    s->if_sp = s->if_cap = 0;
+    s->loop_sp = s->loop_cap = 0;
+    s->for_hdr_sp = s->for_hdr_cap = 0;
+    s->pending_defun_param_count = s->pending_defun_param_cap = 0;
+    s->anon.sp = s->anon.cap = 0;
+    local_init_free(&s->local_init);
 }
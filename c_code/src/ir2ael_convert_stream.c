@@ -0,0 +1,202 @@
+/* ir2ael_convert_stream.c - IR text -> AEL over a bounded sliding window */
+#include "ir2ael_convert.h"
+#include "ir2ael_internal.h"
+#include "ir_binary.h"
+#include "ir_label_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STREAM_CHUNK (256 * 1024)
+
+/*
+ * program.insts[0] is IR index `base` of the whole input. The text parser appends to `program` in
+ * place, and a cut swaps a smaller program into the same struct, so the parser, the state and the
+ * region tree can keep pointing at it.
+ */
+typedef struct StreamWindow {
+    Ir2AelReadFn read;
+    void *read_ctx;
+    IRProgram program;
+    IRTextStream text;
+    size_t base;
+    char *chunk;
+    bool started;
+    bool eof;
+    Ir2AelStreamStats stats;
+} StreamWindow;
+
+/* Reads until the window holds `target` instructions or the input ends. */
+static bool window_fill(StreamWindow *w, size_t target, char *err, size_t err_cap) {
+    while (!w->eof && w->program.count < target) {
+        size_t n = w->read(w->read_ctx, w->chunk, STREAM_CHUNK);
+        if (n == (size_t)-1) {
+            if (err && err_cap) snprintf(err, err_cap, "IR read failed");
+            return false;
+        }
+        if (n == 0) {
+            if (!ir_text_stream_finish(&w->text, err, err_cap)) return false;
+            w->eof = true;
+            break;
+        }
+        if (!w->started && ir_binary_detect(w->chunk, n)) {
+            if (err && err_cap) snprintf(err, err_cap, "binary IR cannot be streamed");
+            return false;
+        }
+        w->started = true;
+        if (!ir_text_stream_feed(&w->text, w->chunk, n, err, err_cap)) return false;
+    }
+    if (w->program.count > w->stats.peak_window) w->stats.peak_window = w->program.count;
+    w->stats.refills++;
+    return true;
+}
+
+/*
+ * First instruction that may not be converted yet: the last BEGIN_FUNCT after `from` with every scan
+ * from before it inside the window. Stopping at a top-level boundary also keeps the label searches
+ * that run to the end of the enclosing function inside the window. Returns `from` if there is none.
+ */
+static size_t window_safe_limit(const StreamWindow *w, size_t from) {
+    const IRProgram *p = &w->program;
+    if (w->eof) return p->count;
+    /* The last instruction may still get its DEPTH line from the next chunk. */
+    size_t complete = p->count > 0 ? p->count - 1 : 0;
+    if (complete <= IR2AEL_LOOKAHEAD_MAX) return from;
+    for (size_t k = complete - IR2AEL_LOOKAHEAD_MAX; k > from; k--) {
+        if (p->insts[k].op == OP_BEGIN_FUNCT) return k;
+    }
+    return from;
+}
+
+/* Releases insts[0, from): the rest moves to a fresh program with its strings re-interned. */
+static bool window_cut(StreamWindow *w, size_t from) {
+    IRProgram *old = &w->program;
+    size_t n = old->count - from;
+    IRProgram next;
+    ir_program_init(&next);
+    next.insts = (IRInst *)malloc((n ? n : 1) * sizeof(*next.insts));
+    if (!next.insts) return false;
+    next.cap = n ? n : 1;
+    for (size_t k = 0; k < n; k++) {
+        IRInst inst = old->insts[from + k];
+        if (inst.str_id != STR_INTERN_NONE) {
+            inst.str_id = str_intern(&next.strings, inst.str, old->strings.entries[inst.str_id].len);
+            if (inst.str_id == STR_INTERN_NONE) {
+                ir_program_free(&next);
+                return false;
+            }
+            inst.str = str_intern_get(&next.strings, inst.str_id);
+        }
+        next.insts[next.count++] = inst;
+    }
+    ir_program_free(old);
+    *old = next;
+    w->base += from;
+    w->stats.cuts++;
+    return true;
+}
+
+/* The index and the region tree cover the whole window, so both are rebuilt whenever it changes. */
+static void window_reindex(StreamWindow *w, Ir2AelState *st) {
+    (void)ir_label_index_build(&w->program);
+    ir2ael_regions_free(&st->regions);
+    (void)ir2ael_regions_build(&st->regions, &w->program);
+    (void)ir2ael_regions_bind(&st->regions);
+}
+
+bool ir2ael_convert_stream(Ir2AelReadFn read, void *read_ctx, AelEmitter *out, const Ir2AelStreamOptions *opts,
+                           Ir2AelStreamStats *stats, char *err, size_t err_cap) {
+    if (err && err_cap) err[0] = '\0';
+    if (stats) memset(stats, 0, sizeof(*stats));
+    if (!read || !out) return false;
+    size_t window = (opts && opts->window) ? opts->window : IR2AEL_STREAM_DEFAULT_WINDOW;
+
+    StreamWindow w;
+    memset(&w, 0, sizeof(w));
+    w.read = read;
+    w.read_ctx = read_ctx;
+    ir_program_init(&w.program);
+    ir_text_stream_init(&w.text, &w.program);
+    w.chunk = (char *)malloc(STREAM_CHUNK);
+    if (!w.chunk) {
+        if (err && err_cap) snprintf(err, err_cap, "out of memory");
+        ir_text_stream_free(&w.text);
+        ir_program_free(&w.program);
+        return false;
+    }
+    if (!window_fill(&w, window, err, err_cap)) {
+        free(w.chunk);
+        ir_text_stream_free(&w.text);
+        ir_program_free(&w.program);
+        return false;
+    }
+    (void)ir_label_index_build(&w.program);
+
+    Ir2AelState st;
+    ir2ael_state_init(&st, &w.program, out, err, err_cap);
+    Ir2AelStatus rc = IR2AEL_STATUS_NOT_HANDLED;
+    const IRInst *inst = NULL;
+    size_t i = 0;
+    bool read_ok = true;
+
+    for (;;) {
+        size_t limit = window_safe_limit(&w, i);
+        for (; i < limit; i++) {
+            inst = &w.program.insts[i];
+            rc = ir2ael_convert_inst(&st, &i);
+            if (rc < 0) goto fail_by_rc;
+        }
+        if (w.eof) break;
+
+        /* Nothing from before a quiescent top-level BEGIN_FUNCT is reachable any more (see ir2ael_internal.h). */
+        if (i > IR2AEL_LOOKBEHIND_MAX && i < w.program.count && w.program.insts[i].op == OP_BEGIN_FUNCT &&
+            ir2ael_state_is_quiescent(&st)) {
+            if (!window_cut(&w, i - IR2AEL_LOOKBEHIND_MAX)) {
+                rc = IR2AEL_STATUS_OOM;
+                goto fail_by_rc;
+            }
+            i = IR2AEL_LOOKBEHIND_MAX;
+            inst = NULL;
+        }
+        /* Without a cut the window doubles, so a long function costs O(n) reindexing overall. */
+        size_t grow = w.program.count > window ? w.program.count : window;
+        if (!window_fill(&w, w.program.count + grow, err, err_cap)) {
+            read_ok = false;
+            rc = IR2AEL_STATUS_FAIL;
+            goto fail_by_rc;
+        }
+        window_reindex(&w, &st);
+    }
+
+    rc = ir2ael_finalize(&st);
+    if (rc < 0) goto fail_by_rc;
+    ir2ael_state_free(&st);
+    w.stats.instructions = w.base + w.program.count;
+    if (stats) *stats = w.stats;
+    free(w.chunk);
+    ir_text_stream_free(&w.text);
+    ir_program_free(&w.program);
+    if (!ael_emit_flush(out)) {
+        if (err && err_cap) snprintf(err, err_cap, "emit failed while flushing output (io)");
+        return false;
+    }
+    return true;
+
+fail_by_rc:
+    if (read_ok) {
+        ir2ael_report_failure(rc, out, inst, i, err, err_cap);
+        /* Handler messages count from the start of the window. */
+        if (w.base > 0 && err && err_cap) {
+            size_t n = strlen(err);
+            if (n + 1 < err_cap) snprintf(err + n, err_cap - n, " (window starts at IR index %zu)", w.base);
+        }
+    }
+    ir2ael_state_free(&st);
+    w.stats.instructions = w.base + w.program.count;
+    if (stats) *stats = w.stats;
+    free(w.chunk);
+    ir_text_stream_free(&w.text);
+    ir_program_free(&w.program);
+    (void)ael_emit_flush(out); /* keep partial output for diagnostics */
+    return false;
+}
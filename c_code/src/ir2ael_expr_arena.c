@@ -0,0 +1,114 @@
+/* ir2ael_expr_arena.c - bump allocator for Expr trees */
+#include "ir2ael_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPR_ARENA_CHUNK_SIZE (64u * 1024u)
+#define EXPR_ARENA_ALIGN 16u
+
+struct ExprArenaChunk {
+    struct ExprArenaChunk *next;
+    size_t used;
+    size_t cap;
+    /* payload follows (header size is a multiple of EXPR_ARENA_ALIGN) */
+};
+
+#define EXPR_ARENA_HDR ((sizeof(ExprArenaChunk) + EXPR_ARENA_ALIGN - 1) & ~(size_t)(EXPR_ARENA_ALIGN - 1))
+
+/* Arena used by expr_new()/expr_array_new()/expr_strdup() on this thread (NULL: plain heap). */
+static IR2AEL_THREAD_LOCAL ExprArena *g_expr_arena = NULL;
+
+void expr_arena_init(ExprArena *a) {
+    if (!a) return;
+    memset(a, 0, sizeof(*a));
+}
+
+void expr_arena_reset(ExprArena *a) {
+    if (!a || !a->head) return;
+    /* O(1): rewind to the first chunk; later chunks are reused as allocation advances. */
+    a->cur = a->head;
+    a->cur->used = 0;
+}
+
+void expr_arena_free(ExprArena *a) {
+    if (!a) return;
+    ExprArenaChunk *c = a->head;
+    while (c) {
+        ExprArenaChunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    memset(a, 0, sizeof(*a));
+}
+
+ExprArena *expr_arena_bind(ExprArena *a) {
+    ExprArena *prev = g_expr_arena;
+    g_expr_arena = a;
+    return prev;
+}
+
+static void *arena_alloc(ExprArena *a, size_t n) {
+    n = (n + EXPR_ARENA_ALIGN - 1) & ~(size_t)(EXPR_ARENA_ALIGN - 1);
+    ExprArenaChunk *c = a->cur;
+    while (c && c->cap - c->used < n) {
+        c = c->next;
+        if (c) c->used = 0;
+    }
+    if (!c) {
+        size_t cap = (n > EXPR_ARENA_CHUNK_SIZE) ? n : EXPR_ARENA_CHUNK_SIZE;
+        c = (ExprArenaChunk *)malloc(EXPR_ARENA_HDR + cap);
+        if (!c) return NULL;
+        c->next = NULL;
+        c->used = 0;
+        c->cap = cap;
+        if (a->cur) {
+            /* Splice after the current chunk so chunks past it stay reusable. */
+            c->next = a->cur->next;
+            a->cur->next = c;
+        } else {
+            c->next = a->head;
+            a->head = c;
+        }
+    }
+    a->cur = c;
+    void *p = (char *)c + EXPR_ARENA_HDR + c->used;
+    c->used += n;
+    memset(p, 0, n);
+    return p;
+}
+
+bool expr_arena_active(void) {
+    return g_expr_arena != NULL;
+}
+
+void *expr_alloc_zeroed(size_t n) {
+    if (g_expr_arena) return arena_alloc(g_expr_arena, n);
+    return calloc(1, n);
+}
+
+Expr **expr_array_new(size_t n) {
+    if (n == 0) n = 1;
+    if (g_expr_arena) return (Expr **)arena_alloc(g_expr_arena, n * sizeof(Expr *));
+    return (Expr **)calloc(n, sizeof(Expr *));
+}
+
+void expr_array_free(Expr **arr) {
+    if (g_expr_arena) return; /* reclaimed by expr_arena_reset() */
+    free(arr);
+}
+
+char *expr_strdup(const char *s) {
+    if (!s) s = "";
+    size_t n = strlen(s) + 1;
+    char *d = g_expr_arena ? (char *)arena_alloc(g_expr_arena, n) : (char *)malloc(n);
+    if (!d) return NULL;
+    memcpy(d, s, n);
+    return d;
+}
+
+/* IR strings live in the program's interner for the whole conversion, so arena nodes can point at them. */
+const char *expr_text_ref(const char *s) {
+    if (!s) s = "";
+    if (g_expr_arena) return s;
+    return expr_strdup(s);
+}
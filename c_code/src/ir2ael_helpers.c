@@ -1,52 +1,114 @@
 /* ir2ael_helpers.c - helper routines for IR->AEL conversion */
 #include "ir2ael_internal.h"
+#include "ir2ael_prof.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <math.h>
 
 
 
 
 void local_init_clear(LocalInitTracker *t) {
     if (!t) return;
+    for (int i = 0; i < t->count; i++) {
+        if (t->entries[i].id != STR_INTERN_NONE) t->by_id[t->entries[i].id] = -1;
+    }
     t->count = 0;
+    t->no_id_count = 0;
 }
 
-int local_init_find(const LocalInitTracker *t, const char *name) {
-    if (!t || !name || !*name) return -1;
+void local_init_free(LocalInitTracker *t) {
+    if (!t) return;
+    free(t->entries);
+    free(t->by_id);
+    memset(t, 0, sizeof(*t));
+}
+
+static int local_init_find_by_name(const LocalInitTracker *t, const char *name, bool no_id_only) {
     for (int i = 0; i < t->count; i++) {
-        if (strcmp(t->entries[i].name, name) == 0) return i;
+        const LocalInitEntry *e = &t->entries[i];
+        if (no_id_only && e->id != STR_INTERN_NONE) continue;
+        if (e->name == name || strcmp(e->name, name) == 0) return i;
     }
     return -1;
 }
 
-void local_init_mark_decl(LocalInitTracker *t, const char *name) {
+int local_init_find(const LocalInitTracker *t, const char *name, uint32_t id) {
+    if (!t || !name || !*name) return -1;
+    if (id == STR_INTERN_NONE) return local_init_find_by_name(t, name, false);
+    if (id < t->id_cap && t->by_id[id] >= 0) return t->by_id[id];
+    return t->no_id_count > 0 ? local_init_find_by_name(t, name, true) : -1;
+}
+
+static bool local_init_grow_ids(LocalInitTracker *t, uint32_t id) {
+    uint32_t ncap = t->id_cap ? t->id_cap : 256;
+    while (ncap <= id) {
+        if (ncap > UINT32_MAX / 2) return false;
+        ncap *= 2;
+    }
+    int *nb = (int *)realloc(t->by_id, (size_t)ncap * sizeof(*nb));
+    if (!nb) return false;
+    for (uint32_t k = t->id_cap; k < ncap; k++) nb[k] = -1;
+    t->by_id = nb;
+    t->id_cap = ncap;
+    return true;
+}
+
+void local_init_mark_decl(LocalInitTracker *t, const char *name, uint32_t id) {
     if (!t || !name || !*name) return;
-    int idx = local_init_find(t, name);
+    int idx = local_init_find(t, name, id);
     if (idx >= 0) {
         t->entries[idx].ambiguous = true;
         return;
     }
-    if (t->count >= (int)(sizeof(t->entries) / sizeof(t->entries[0]))) return;
-    strncpy(t->entries[t->count].name, name, sizeof(t->entries[t->count].name) - 1);
-    t->entries[t->count].name[sizeof(t->entries[t->count].name) - 1] = '\0';
-    t->entries[t->count].assigned = false;
-    t->entries[t->count].ambiguous = false;
+
+    /* On OOM the name is simply not tracked. */
+    if (id != STR_INTERN_NONE && id >= t->id_cap && !local_init_grow_ids(t, id)) return;
+    if (t->count == t->cap) {
+        int ncap = t->cap ? t->cap * 2 : 32;
+        LocalInitEntry *ne = (LocalInitEntry *)realloc(t->entries, (size_t)ncap * sizeof(*ne));
+        if (!ne) return;
+        t->entries = ne;
+        t->cap = ncap;
+    }
+
+    LocalInitEntry *e = &t->entries[t->count];
+    e->name = name;
+    e->id = id;
+    e->assigned = false;
+    e->ambiguous = false;
+    if (id != STR_INTERN_NONE) t->by_id[id] = t->count;
+    else t->no_id_count++;
     t->count++;
 }
 
-void local_init_mark_assigned(LocalInitTracker *t, const char *name) {
+void local_init_mark_assigned(LocalInitTracker *t, const char *name, uint32_t id) {
     if (!t || !name || !*name) return;
-    int idx = local_init_find(t, name);
+    int idx = local_init_find(t, name, id);
     if (idx < 0) return;
     t->entries[idx].assigned = true;
 }
 
+bool local_init_copy(LocalInitTracker *dst, const LocalInitTracker *src) {
+    if (!dst || !src) return false;
+    local_init_clear(dst);
+    for (int i = 0; i < src->count; i++) {
+        const LocalInitEntry *e = &src->entries[i];
+        local_init_mark_decl(dst, e->name, e->id);
+        if (dst->count != i + 1) return false;
+        dst->entries[i].assigned = e->assigned;
+        dst->entries[i].ambiguous = e->ambiguous;
+    }
+    return true;
+}
+
 void local_init_track_decl_group(LocalInitTracker *t, const DeclGroup *g) {
     if (!t || !g || !g->is_local || !g->in_function) return;
     for (int i = 0; i < g->count; i++) {
-        local_init_mark_decl(t, g->names[i]);
+        local_init_mark_decl(t, g->names[i], g->ids[i]);
     }
 }
 
@@ -58,6 +120,12 @@ void decl_group_clear(DeclGroup *g) {
     g->depth = 0;
 }
 
+bool decl_group_name_is(const DeclGroup *g, int k, const IRInst *inst) {
+    if (!g || !inst || !inst->str || k < 0 || k >= g->count) return false;
+    if (inst->str_id != STR_INTERN_NONE && g->ids[k] != STR_INTERN_NONE) return inst->str_id == g->ids[k];
+    return strcmp(inst->str, g->names[k]) == 0;
+}
+
 bool decl_group_emit(AelEmitter *out, const DeclGroup *g, int line0, int col0) {
     if (!g || g->count <= 0) return true;
     if (out && !out->strict_pos) {
@@ -121,6 +189,7 @@ size_t ir_skip_locals_bookkeeping_back(const IRProgram *program, size_t idx) {
 
 void expr_free(Expr *e) {
     if (!e) return;
+    if (e->arena_owned) return; /* reclaimed by expr_arena_reset() */
     expr_free(e->lhs);
     expr_free(e->mid);
     expr_free(e->rhs);
@@ -137,13 +206,14 @@ void expr_free(Expr *e) {
         for (int i = 0; i < e->index_count; i++) expr_free(e->index_items[i]);
         free(e->index_items);
     }
-    free(e->text);
+    free((char *)e->text);
     free(e);
 }
 
 Expr *expr_new(ExprKind kind) {
-    Expr *e = (Expr *)calloc(1, sizeof(Expr));
+    Expr *e = (Expr *)expr_alloc_zeroed(sizeof(Expr));
     if (!e) return NULL;
+    e->arena_owned = expr_arena_active();
     e->kind = kind;
     e->op_line0 = -1;
     e->op_col0 = -1;
@@ -164,8 +234,10 @@ Expr *expr_clone(const Expr *e) {
     c->flags = e->flags;
     c->int_value = e->int_value;
     c->num_value = e->num_value;
+    c->text_id = e->text_id;
     if (e->text) {
-        c->text = _strdup(e->text);
+        /* Text is never modified after creation, so arena copies can share it. */
+        c->text = (c->arena_owned && e->arena_owned) ? e->text : expr_strdup(e->text);
         if (!c->text) {
             expr_free(c);
             return NULL;
@@ -201,7 +273,7 @@ Expr *expr_clone(const Expr *e) {
         }
     }
     if (e->items && e->item_count > 0) {
-        c->items = (Expr **)calloc((size_t)e->item_count, sizeof(Expr *));
+        c->items = expr_array_new((size_t)e->item_count);
         if (!c->items) {
             expr_free(c);
             return NULL;
@@ -216,7 +288,7 @@ Expr *expr_clone(const Expr *e) {
         }
     }
     if (e->call_args && e->call_arg_count > 0) {
-        c->call_args = (Expr **)calloc((size_t)e->call_arg_count, sizeof(Expr *));
+        c->call_args = expr_array_new((size_t)e->call_arg_count);
         if (!c->call_args) {
             expr_free(c);
             return NULL;
@@ -238,7 +310,7 @@ Expr *expr_clone(const Expr *e) {
         }
     }
     if (e->index_items && e->index_count > 0) {
-        c->index_items = (Expr **)calloc((size_t)e->index_count, sizeof(Expr *));
+        c->index_items = expr_array_new((size_t)e->index_count);
         if (!c->index_items) {
             expr_free(c);
             return NULL;
@@ -448,15 +520,16 @@ bool emit_escaped_string(AelEmitter *out, const char *raw) {
      * backslashes like "\View"), otherwise token columns shift and roundtrip fails.
      */
     const char *s = raw ? raw : "";
+    const char *run = s;
     for (const char *p = s; *p; p++) {
-        char c = *p;
-        if (c == '"' && (p == s || p[-1] != '\\')) {
+        if (*p == '"' && (p == s || p[-1] != '\\')) {
             /* Best-effort: if an unescaped quote appears, escape it so the file stays parseable. */
+            if (!ael_emit_bytes(out, run, (size_t)(p - run))) return false;
             if (!ael_emit_text(out, "\\\"")) return false;
-            continue;
+            run = p + 1;
         }
-        if (!ael_emit_char(out, c)) return false;
     }
+    if (!ael_emit_text(out, run)) return false;
     return ael_emit_char(out, '"');
 }
 
@@ -499,95 +572,117 @@ void normalize_sci_literal(char *s) {
     }
 }
 
-void format_real_token(double v, char *out, size_t out_cap) {
-    if (!out || out_cap == 0) return;
+/* Exponent as the real-literal rules want it ("e-5", "e20"), or as printf writes it ("e-05", "e+20"). */
+static size_t literal_put_exp(char *p, int x, bool normalized) {
+    size_t n = 0;
+    p[n++] = 'e';
+    if (x < 0) p[n++] = '-';
+    else if (!normalized) p[n++] = '+';
+    unsigned ax = (unsigned)(x < 0 ? -x : x);
+    char tmp[8];
+    int k = 0;
+    do {
+        tmp[k++] = (char)('0' + ax % 10);
+        ax /= 10;
+    } while (ax > 0);
+    if (!normalized && k < 2) tmp[k++] = '0';
+    while (k > 0) p[n++] = tmp[--k];
+    return n;
+}
+
+/* %g fixed notation of digits * 10^(x - n + 1): trailing fraction zeros and a bare '.' dropped. */
+static size_t literal_put_fixed(char *p, bool neg, const char *d, int n, int x) {
+    size_t len = 0;
+    if (neg) p[len++] = '-';
+    if (x < 0) {
+        p[len++] = '0';
+        p[len++] = '.';
+        for (int k = -1; k > x; k--) p[len++] = '0';
+        memcpy(p + len, d, (size_t)n);
+        return len + (size_t)n;
+    }
+    for (int k = 0; k <= x; k++) p[len++] = (k < n) ? d[k] : '0';
+    if (n > x + 1) {
+        p[len++] = '.';
+        memcpy(p + len, d + x + 1, (size_t)(n - x - 1));
+        len += (size_t)(n - x - 1);
+    }
+    return len;
+}
+
+/* Scientific notation with `frac` fraction digits (zero-padded past the significant ones). */
+static size_t literal_put_sci(char *p, bool neg, const char *d, int n, int x, int frac, bool normalized) {
+    size_t len = 0;
+    if (neg) p[len++] = '-';
+    p[len++] = d[0];
+    if (frac > 0) {
+        p[len++] = '.';
+        for (int k = 1; k <= frac; k++) p[len++] = (k < n) ? d[k] : '0';
+    }
+    return len + literal_put_exp(p + len, x, normalized);
+}
+
+/*
+ * Shortest literal for v among the strings "%.<p>g" / "%.<p>e" (p = 1..17) that read back as v, the
+ * earliest (lowest p, %g before %e) winning ties. Every such string carries the shortest round-trip
+ * digits, so only three spellings can win: %g at exactly n digits, %e at n digits (at least one
+ * fraction digit), and %g in fixed notation once the precision covers the integer part.
+ * `real` applies the real-literal rules: normalized exponent and ".0" on bare integers.
+ */
+static void format_shortest_literal(double v, char *out, size_t out_cap, bool real) {
+    char d[18];
+    int e10 = 0;
+    int n = shortest_decimal_digits(v, d, &e10);
+    if (n == 0) {
+        /* inf/nan: printf's spelling, which is also what the old precision search settled on. */
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.17g", v);
+        if (real && !strchr(buf, '.')) strncat(buf, ".0", sizeof(buf) - strlen(buf) - 1);
+        strncpy(out, buf, out_cap - 1);
+        out[out_cap - 1] = '\0';
+        return;
+    }
+    bool neg = signbit(v) != 0;
+    int x = e10 + n - 1; /* decimal exponent of the leading digit */
 
-    char best[128];
-    best[0] = '\0';
-    size_t best_len = (size_t)-1;
-
-    /* Try to find a short decimal/scientific literal that round-trips via strtod. */
-    for (int prec = 1; prec <= 17; prec++) {
-        char cand[128];
-        cand[0] = '\0';
-
-        /* %g */
-        snprintf(cand, sizeof(cand), "%.*g", prec, v);
-        normalize_sci_literal(cand);
-        if (!strchr(cand, '.') && !strchr(cand, 'e') && !strchr(cand, 'E')) {
-            strncat(cand, ".0", sizeof(cand) - strlen(cand) - 1);
-        }
-        if (strtod(cand, NULL) == v) {
-            size_t n = strlen(cand);
-            if (n < best_len) {
-                strncpy(best, cand, sizeof(best) - 1);
-                best[sizeof(best) - 1] = '\0';
-                best_len = n;
-            }
-        }
+    char cand[3][48];
+    size_t cand_len[3];
+    int g_at = (n == 1) ? 0 : 1;
+    int e_at = 1 - g_at;
 
-        /* %e */
-        snprintf(cand, sizeof(cand), "%.*e", prec, v);
-        normalize_sci_literal(cand);
-        if (!strchr(cand, '.') && !strchr(cand, 'e') && !strchr(cand, 'E')) {
-            strncat(cand, ".0", sizeof(cand) - strlen(cand) - 1);
-        }
-        if (strtod(cand, NULL) == v) {
-            size_t n = strlen(cand);
-            if (n < best_len) {
-                strncpy(best, cand, sizeof(best) - 1);
-                best[sizeof(best) - 1] = '\0';
-                best_len = n;
-            }
-        }
+    if (x >= -4 && x < n) cand_len[g_at] = literal_put_fixed(cand[g_at], neg, d, n, x);
+    else cand_len[g_at] = literal_put_sci(cand[g_at], neg, d, n, x, n - 1, real);
+    cand_len[e_at] = literal_put_sci(cand[e_at], neg, d, n, x, n > 1 ? n - 1 : 1, real);
+    int count = 2;
+    if (x >= n && x < 17) {
+        /* v is integral here, and printf prints its exact digits rather than the shortest ones padded. */
+        char exact[20];
+        int en = snprintf(exact, sizeof(exact), "%llu", (unsigned long long)fabs(v));
+        cand_len[count++] = literal_put_fixed(cand[2], neg, exact, en, en - 1);
     }
 
-    if (best[0] == '\0') {
-        snprintf(best, sizeof(best), "%.17g", v);
-        normalize_sci_literal(best);
-        if (!strchr(best, '.') && !strchr(best, 'e') && !strchr(best, 'E')) {
-            strncat(best, ".0", sizeof(best) - strlen(best) - 1);
+    int best = 0;
+    for (int c = 0; c < count; c++) {
+        if (real && !memchr(cand[c], '.', cand_len[c]) && !memchr(cand[c], 'e', cand_len[c])) {
+            cand[c][cand_len[c]++] = '.';
+            cand[c][cand_len[c]++] = '0';
         }
+        if (cand_len[c] < cand_len[best]) best = c;
     }
 
-    strncpy(out, best, out_cap - 1);
-    out[out_cap - 1] = '\0';
+    size_t len = cand_len[best] < out_cap - 1 ? cand_len[best] : out_cap - 1;
+    memcpy(out, cand[best], len);
+    out[len] = '\0';
 }
 
-void format_imag_token(double v, char *out, size_t out_cap) {
+void format_real_token(double v, char *out, size_t out_cap) {
     if (!out || out_cap == 0) return;
-    char best[128];
-    best[0] = '\0';
-    size_t best_len = (size_t)-1;
-    for (int prec = 1; prec <= 17; prec++) {
-        char cand[128];
-        cand[0] = '\0';
-
-        snprintf(cand, sizeof(cand), "%.*g", prec, v);
-        if (strtod(cand, NULL) == v) {
-            size_t n = strlen(cand);
-            if (n < best_len) {
-                strncpy(best, cand, sizeof(best) - 1);
-                best[sizeof(best) - 1] = '\0';
-                best_len = n;
-            }
-        }
+    format_shortest_literal(v, out, out_cap, true);
+}
 
-        snprintf(cand, sizeof(cand), "%.*e", prec, v);
-        if (strtod(cand, NULL) == v) {
-            size_t n = strlen(cand);
-            if (n < best_len) {
-                strncpy(best, cand, sizeof(best) - 1);
-                best[sizeof(best) - 1] = '\0';
-                best_len = n;
-            }
-        }
-    }
-    if (best[0] == '\0') {
-        snprintf(best, sizeof(best), "%.17g", v);
-    }
-    strncpy(out, best, out_cap - 1);
-    out[out_cap - 1] = '\0';
+void format_imag_token(double v, char *out, size_t out_cap) {
+    if (!out || out_cap == 0) return;
+    format_shortest_literal(v, out, out_cap, false);
 }
 
 int decl_indent_col0_from_depth(int depth) {
@@ -597,7 +692,7 @@ int decl_indent_col0_from_depth(int depth) {
 
 bool for_header_has_comma_op(const IRProgram *program, size_t i, int line0) {
     if (!program) return false;
-    size_t end = i + 96;
+    size_t end = i + IR2AEL_SCAN_INLINE_STMT;
     if (end > program->count) end = program->count;
     for (size_t j = i + 1; j < end; j++) {
         const IRInst *mj = &program->insts[j];
@@ -639,7 +734,7 @@ bool has_next_decl_init_on_same_line(const IRProgram *program, size_t cur_i, int
 
 bool else_body_has_brace_block(const IRProgram *program, size_t start, int end_label, int if_depth) {
     if (!program) return false;
-    const size_t max_scan = 16;
+    const size_t max_scan = IR2AEL_SCAN_ELSE_HEAD;
     for (size_t j = start; j < program->count && j < start + max_scan; j++) {
         const IRInst *mj = &program->insts[j];
         if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == end_label) return false;
@@ -666,17 +761,17 @@ bool stmt_emit_at_or_current(AelEmitter *out, int *line0, int *col0, int depth)
     return ael_emit_at(out, *line0, *col0);
 }
 
-int anon_block_current_depth(const int *stack, int sp) {
-    if (sp <= 0) return 1;
-    int v = stack[sp - 1];
+int anon_block_current_depth(const AnonDepthStack *anon) {
+    if (!anon || anon->sp <= 0) return 1;
+    int v = anon->depths[anon->sp - 1];
     return (v < 0) ? -v : v;
 }
 
-bool anon_block_open_to(AelEmitter *out, int *sp, int *stack, int target_depth, int brace_line0) {
-    if (!out || !sp || !stack) return false;
+bool anon_block_open_to(AelEmitter *out, AnonDepthStack *anon, int target_depth, int brace_line0) {
+    if (!out || !anon) return false;
     if (target_depth <= 1) return true;
 
-    int cur = anon_block_current_depth(stack, *sp);
+    int cur = anon_block_current_depth(anon);
     int line0 = brace_line0;
     while (cur < target_depth) {
         int new_depth = cur + 1;
@@ -684,20 +779,18 @@ bool anon_block_open_to(AelEmitter *out, int *sp, int *stack, int target_depth,
         if (line0 < 0) line0 = 0;
         if (!ael_emit_at(out, line0, col0)) return false;
         if (!ael_emit_text(out, "{\n")) return false;
-        if (*sp < 64) {
-            stack[(*sp)++] = new_depth;
-        }
+        (void)anon_depth_push_marked(anon, new_depth, false);
         cur = new_depth;
         line0++;
     }
     return true;
 }
 
-bool anon_block_close_to(AelEmitter *out, int *sp, int *stack, int target_depth, int anchor_line0) {
-    if (!out || !sp || !stack) return false;
+bool anon_block_close_to(AelEmitter *out, AnonDepthStack *anon, int target_depth, int anchor_line0) {
+    if (!out || !anon) return false;
     if (target_depth < 1) target_depth = 1;
 
-    int cur = anon_block_current_depth(stack, *sp);
+    int cur = anon_block_current_depth(anon);
     if (cur <= target_depth) return true;
 
     /* Emit multiple closing braces in increasing line order to avoid backward seeks. */
@@ -710,35 +803,41 @@ bool anon_block_close_to(AelEmitter *out, int *sp, int *stack, int target_depth,
         int line0 = first_line0 + k;
         if (!ael_emit_at(out, line0, col0)) return false;
         if (!ael_emit_text(out, "}\n")) return false;
-        if (*sp > 0) (*sp)--;
+        if (anon->sp > 0) anon->sp--;
     }
     return true;
 }
 
-bool anon_depth_push_marked(int *sp, int *stack, int depth, bool is_controlflow) {
-    if (!sp || !stack) return false;
-    if (*sp >= 64) return false;
+bool anon_depth_push_marked(AnonDepthStack *anon, int depth, bool is_controlflow) {
+    if (!anon) return false;
+    if (anon->sp >= anon->cap) {
+        int ncap = anon->cap ? anon->cap * 2 : 64;
+        int *nd = (int *)realloc(anon->depths, (size_t)ncap * sizeof(*nd));
+        if (!nd) return false;
+        anon->depths = nd;
+        anon->cap = ncap;
+    }
     int v = (depth < 0) ? -depth : depth;
-    stack[(*sp)++] = is_controlflow ? -v : v;
+    anon->depths[anon->sp++] = is_controlflow ? -v : v;
     return true;
 }
 
-void anon_depth_pop_expected(int *sp, const int *stack, int expected_depth, bool is_controlflow) {
-    if (!sp || !stack) return;
-    if (*sp <= 0) return;
+void anon_depth_pop_expected(AnonDepthStack *anon, int expected_depth, bool is_controlflow) {
+    if (!anon) return;
+    if (anon->sp <= 0) return;
     int want = (expected_depth < 0) ? -expected_depth : expected_depth;
     int expected = is_controlflow ? -want : want;
-    if (stack[*sp - 1] == expected) (*sp)--;
+    if (anon->depths[anon->sp - 1] == expected) anon->sp--;
 }
 
-bool anon_scope_close_to(AelEmitter *out, int *sp, int *stack, int target_depth, int anchor_line0) {
-    if (!out || !sp || !stack) return false;
+bool anon_scope_close_to(AelEmitter *out, AnonDepthStack *anon, int target_depth, int anchor_line0) {
+    if (!out || !anon) return false;
     if (target_depth < 1) target_depth = 1;
 
     /* Count how many positive (scope) braces are above target_depth. Stop at controlflow brace markers. */
     int n = 0;
-    for (int k = *sp - 1; k >= 0; k--) {
-        int v = stack[k];
+    for (int k = anon->sp - 1; k >= 0; k--) {
+        int v = anon->depths[k];
         if (v < 0) break;
         if (v <= target_depth) break;
         n++;
@@ -750,9 +849,9 @@ bool anon_scope_close_to(AelEmitter *out, int *sp, int *stack, int target_depth,
     if (first_line0 < 0) first_line0 = 0;
 
     for (int i = 0; i < n; i++) {
-        int idx = (*sp) - 1;
+        int idx = anon->sp - 1;
         if (idx < 0) break;
-        int depth_to_close = stack[idx];
+        int depth_to_close = anon->depths[idx];
         if (depth_to_close < 0) break;
         if (depth_to_close <= target_depth) break;
 
@@ -760,30 +859,30 @@ bool anon_scope_close_to(AelEmitter *out, int *sp, int *stack, int target_depth,
         int line0 = first_line0 + i;
         if (!ael_emit_at(out, line0, col0)) return false;
         if (!ael_emit_text(out, "}\n")) return false;
-        (*sp)--;
+        anon->sp--;
     }
     return true;
 }
 
-bool anon_close_scopes_before_stmt(AelEmitter *out, int *sp, int *stack, int target_depth, int stmt_line0) {
-    return anon_scope_close_to(out, sp, stack, target_depth, stmt_line0);
+bool anon_close_scopes_before_stmt(AelEmitter *out, AnonDepthStack *anon, int target_depth, int stmt_line0) {
+    return anon_scope_close_to(out, anon, target_depth, stmt_line0);
 }
 
 /* At function end, close any remaining scope-only blocks we opened for locals reconstruction.
    Ignore stale control-flow markers (negative depths) to avoid synthesizing stray '}' between functions. */
-bool anon_close_scope_blocks_at_function_end(AelEmitter *out, int *sp, int *stack, int target_depth, int anchor_line0) {
-    if (!out || !sp || !stack) return false;
+bool anon_close_scope_blocks_at_function_end(AelEmitter *out, AnonDepthStack *anon, int target_depth, int anchor_line0) {
+    if (!out || !anon) return false;
     if (target_depth < 1) target_depth = 1;
 
     int line0 = anchor_line0;
     if (line0 < out->line0) line0 = out->line0;
     if (line0 < 0) line0 = 0;
 
-    while (*sp > 0) {
-        int v = stack[*sp - 1];
+    while (anon->sp > 0) {
+        int v = anon->depths[anon->sp - 1];
         int depth = (v < 0) ? -v : v;
         if (depth <= target_depth) break;
-        (*sp)--;
+        anon->sp--;
         if (v < 0) continue; /* discard controlflow marker */
         int col0 = decl_indent_col0_from_depth(depth - 1);
         if (!ael_emit_at(out, line0, col0)) return false;
@@ -1309,6 +1408,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
     if (out_expr) *out_expr = NULL;
     if (!program || !out_expr) return false;
     if (start > end || end > program->count) return false;
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_PARSE_EXPR_RANGE, end - start);
 
     Expr **stk = NULL;
     size_t len = 0, cap = 0;
@@ -1365,7 +1465,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
         if (inst->op == OP_LOAD_STR) {
             Expr *e = expr_new(EXPR_STR);
             if (!e) goto oom;
-            e->text = inst->str ? _strdup(inst->str) : _strdup("");
+            e->text = expr_text_ref(inst->str);
             if (!e->text) goto oom;
             if (!stack_push(&stk, &len, &cap, e)) goto oom;
             continue;
@@ -1373,7 +1473,8 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
         if (inst->op == OP_LOAD_VAR) {
             Expr *e = expr_new(EXPR_VAR);
             if (!e) goto oom;
-            e->text = inst->str ? _strdup(inst->str) : _strdup("");
+            e->text = expr_text_ref(inst->str);
+            e->text_id = inst->str_id;
             if (!e->text) goto oom;
             if (!stack_push(&stk, &len, &cap, e)) goto oom;
             continue;
@@ -1413,12 +1514,12 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                 int false_label = program->insts[i + 4].arg1;
 
                 size_t idx_op60 = (size_t)-1;
-                for (size_t j = i + 6; j + 3 < end; j++) {
+                for (size_t lab = ir_next_set_label(program, false_label, i + 9, end); lab < end;
+                     lab = ir_next_set_label(program, false_label, lab + 1, end)) {
+                    size_t j = lab - 3;
                     if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 60 &&
                         ir_inst_is_load_trueish(&program->insts[j + 1]) &&
-                        program->insts[j + 2].op == OP_BRANCH_TRUE && program->insts[j + 2].has_arg1 &&
-                        program->insts[j + 3].op == OP_SET_LABEL && program->insts[j + 3].has_arg1 &&
-                        program->insts[j + 3].arg1 == false_label) {
+                        program->insts[j + 2].op == OP_BRANCH_TRUE && program->insts[j + 2].has_arg1) {
                         idx_op60 = j;
                         break;
                     }
@@ -1428,10 +1529,10 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                     int end_label = program->insts[idx_op60 + 2].arg1;
                     size_t else_start = idx_op60 + 4;
                     size_t idx_op65 = (size_t)-1;
-                    for (size_t j = else_start; j + 1 < end; j++) {
-                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 65 &&
-                            program->insts[j + 1].op == OP_SET_LABEL && program->insts[j + 1].has_arg1 &&
-                            program->insts[j + 1].arg1 == end_label) {
+                    for (size_t lab = ir_next_set_label(program, end_label, else_start + 1, end); lab < end;
+                         lab = ir_next_set_label(program, end_label, lab + 1, end)) {
+                        size_t j = lab - 1;
+                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == 65) {
                             idx_op65 = j;
                             break;
                         }
@@ -1509,9 +1610,10 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
 
                     size_t rhs_start = idx_bt + 3;
                     size_t rhs_marker = (size_t)-1;
-                    for (size_t j = rhs_start; j + 1 < end; j++) {
-                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == op_code &&
-                            program->insts[j + 1].op == OP_SET_LABEL && program->insts[j + 1].has_arg1 && program->insts[j + 1].arg1 == end_label) {
+                    for (size_t lab = ir_next_set_label(program, end_label, rhs_start + 1, end); lab < end;
+                         lab = ir_next_set_label(program, end_label, lab + 1, end)) {
+                        size_t j = lab - 1;
+                        if (program->insts[j].op == OP_OP && program->insts[j].has_arg1 && program->insts[j].arg1 == op_code) {
                             rhs_marker = j;
                             break;
                         }
@@ -1566,13 +1668,13 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                 if (n < 0) n = 0;
                 Expr **items = NULL;
                 if (n > 0) {
-                    items = (Expr **)calloc((size_t)n, sizeof(Expr *));
+                    items = expr_array_new((size_t)n);
                     if (!items) goto oom;
                     for (int k = n - 1; k >= 0; k--) {
                         items[k] = stack_pop(stk, &len);
                         if (!items[k]) {
                             for (int t = k; t < n; t++) expr_free(items[t]);
-                            free(items);
+                            expr_array_free(items);
                             goto bad;
                         }
                     }
@@ -1580,7 +1682,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                 Expr *e = expr_new(EXPR_LIST);
                 if (!e) {
                     for (int k = 0; k < n; k++) expr_free(items[k]);
-                    free(items);
+                    expr_array_free(items);
                     goto oom;
                 }
                 e->items = items;
@@ -1612,7 +1714,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
 
                     Expr **args = NULL;
                     if (argc > 0) {
-                        args = (Expr **)calloc((size_t)argc, sizeof(Expr *));
+                        args = expr_array_new((size_t)argc);
                         if (!args) {
                             expr_free(m);
                             goto oom;
@@ -1621,7 +1723,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                             args[k] = stack_pop(stk, &len);
                             if (!args[k]) {
                                 for (int t = k; t < argc; t++) expr_free(args[t]);
-                                free(args);
+                                expr_array_free(args);
                                 expr_free(m);
                                 goto bad;
                             }
@@ -1630,7 +1732,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                     Expr *callee = stack_pop(stk, &len);
                     if (!callee) {
                         for (int t = 0; t < argc; t++) expr_free(args ? args[t] : NULL);
-                        free(args);
+                        expr_array_free(args);
                         expr_free(m);
                         goto bad;
                     }
@@ -1638,7 +1740,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                     if (!ce) {
                         expr_free(callee);
                         for (int t = 0; t < argc; t++) expr_free(args ? args[t] : NULL);
-                        free(args);
+                        expr_array_free(args);
                         expr_free(m);
                         goto oom;
                     }
@@ -1678,31 +1780,31 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                 }
                 if (group_n <= 0 || total_index_items <= 0) goto bad;
 
-                Expr **all_idxs = (Expr **)calloc((size_t)total_index_items, sizeof(Expr *));
+                Expr **all_idxs = expr_array_new((size_t)total_index_items);
                 if (!all_idxs) goto oom;
                 for (int k = total_index_items - 1; k >= 0; k--) {
                     all_idxs[k] = stack_pop(stk, &len);
                     if (!all_idxs[k]) {
                         for (int t = k; t < total_index_items; t++) expr_free(all_idxs[t]);
-                        free(all_idxs);
+                        expr_array_free(all_idxs);
                         goto bad;
                     }
                 }
                 Expr *base = stack_pop(stk, &len);
                 if (!base) {
                     for (int t = 0; t < total_index_items; t++) expr_free(all_idxs[t]);
-                    free(all_idxs);
+                    expr_array_free(all_idxs);
                     goto bad;
                 }
                 Expr *cur = base;
                 int off = 0;
                 for (int g = 0; g < group_n; g++) {
                     int ic = group_counts[g];
-                    Expr **idxs = (Expr **)calloc((size_t)ic, sizeof(Expr *));
+                    Expr **idxs = expr_array_new((size_t)ic);
                     if (!idxs) {
                         expr_free(cur);
                         for (int t = off; t < total_index_items; t++) expr_free(all_idxs[t]);
-                        free(all_idxs);
+                        expr_array_free(all_idxs);
                         goto oom;
                     }
                     for (int t = 0; t < ic; t++) {
@@ -1713,9 +1815,9 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                     if (!ie) {
                         expr_free(cur);
                         for (int t = 0; t < ic; t++) expr_free(idxs[t]);
-                        free(idxs);
+                        expr_array_free(idxs);
                         for (int t = off + ic; t < total_index_items; t++) expr_free(all_idxs[t]);
-                        free(all_idxs);
+                        expr_array_free(all_idxs);
                         goto oom;
                     }
                     ie->index_base = cur;
@@ -1726,7 +1828,7 @@ bool parse_expr_range(const IRProgram *program, size_t start, size_t end, Expr *
                     cur = ie;
                     off += ic;
                 }
-                free(all_idxs);
+                expr_array_free(all_idxs);
                 if (!stack_push(&stk, &len, &cap, cur)) {
                     expr_free(cur);
                     goto oom;
@@ -1869,8 +1971,8 @@ oom:
 
 
 
-bool if_close_braced_else_on_depth_exit(AelEmitter *out, IfCtx *if_stack, int *if_sp, int cur_depth, int *anon_sp, int *anon_stack) {
-    if (!out || !if_stack || !if_sp) return false;
+bool if_close_braced_else_on_depth_exit(AelEmitter *out, IfCtx *if_stack, int *if_sp, int cur_depth, AnonDepthStack *anon) {
+    if (!out || !if_sp) return false;
     while (*if_sp > 0) {
         IfCtx *ctx = &if_stack[*if_sp - 1];
         if (!(ctx->stage == 2 && ctx->else_brace_style)) break;
@@ -1882,22 +1984,22 @@ bool if_close_braced_else_on_depth_exit(AelEmitter *out, IfCtx *if_stack, int *i
         }
         if (!ael_emit_at(out, out->line0, close_col0)) return false;
         if (!ael_emit_text(out, "}\n")) return false;
-        if (anon_sp && anon_stack) {
-            anon_depth_pop_expected(anon_sp, anon_stack, ctx->depth + 1, true);
+        if (anon) {
+            anon_depth_pop_expected(anon, ctx->depth + 1, true);
         }
         (*if_sp)--;
     }
     return true;
 }
 
-bool ensure_switch_opened(AelEmitter *out, SwitchCtx *sw, int first_case_line0, int *anon_sp, int *anon_stack) {
+bool ensure_switch_opened(AelEmitter *out, SwitchCtx *sw, int first_case_line0, AnonDepthStack *anon) {
     if (!out || !sw || !sw->active) return false;
     if (sw->opened) return true;
     if (!out->strict_pos) {
         if (!ael_emit_text(out, " {\n")) return false;
         sw->opened = true;
-        if (anon_sp && anon_stack) {
-            (void)anon_depth_push_marked(anon_sp, anon_stack, sw->depth + 1, true);
+        if (anon) {
+            (void)anon_depth_push_marked(anon, sw->depth + 1, true);
         }
         return true;
     }
@@ -1909,8 +2011,8 @@ bool ensure_switch_opened(AelEmitter *out, SwitchCtx *sw, int first_case_line0,
         if (!ael_emit_text(out, "{\n")) return false;
     }
     sw->opened = true;
-    if (anon_sp && anon_stack) {
-        (void)anon_depth_push_marked(anon_sp, anon_stack, sw->depth + 1, true);
+    if (anon) {
+        (void)anon_depth_push_marked(anon, sw->depth + 1, true);
     }
     return true;
 }
@@ -1946,16 +2048,15 @@ bool op0_is_short_circuit_marker(const IRProgram *program, size_t idx, size_t en
     return (n->op == OP_OP && n->has_arg1 && (n->arg1 == 62 || n->arg1 == 63));
 }
 
-bool begin_loop_has_for_scaffold(const IRProgram *program, size_t begin_i, int start_label) {
-    if (!program) return false;
-    size_t end = begin_i + 64;
+size_t ir_next_for_scaffold_branch(const IRProgram *program, size_t begin_i, size_t from) {
+    if (!program) return SIZE_MAX;
+    size_t end = begin_i + IR2AEL_SCAN_FOR_SCAFFOLD;
     if (end > program->count) end = program->count;
-    for (size_t j = begin_i + 1; j + 6 < end; j++) {
+    for (size_t j = from; j + 6 < end; j++) {
         const IRInst *a = &program->insts[j];
         if (a->op == OP_BEGIN_FUNCT || a->op == OP_DEFINE_FUNCT || a->op == OP_END_LOOP) break;
         if (a->op == OP_NUM_LOCAL || a->op == OP_DROP_LOCAL) continue;
         if (a->op != OP_BRANCH_TRUE || !a->has_arg1) continue;
-        if (start_label >= 0 && a->arg1 == start_label) continue;
 
         /* Require the header-style ADD_LABEL immediately before the branch. */
         size_t prev = ir_skip_locals_bookkeeping_back(program, j);
@@ -1972,12 +2073,30 @@ bool begin_loop_has_for_scaffold(const IRProgram *program, size_t begin_i, int s
         if (k >= end || program->insts[k].op != OP_BRANCH_TRUE || !program->insts[k].has_arg1) continue;
         k = ir_skip_locals_bookkeeping(program, k + 1);
         if (k >= end || program->insts[k].op != OP_LOOP_AGAIN) continue;
+        return j;
+    }
+    return SIZE_MAX;
+}
+
+bool begin_loop_has_for_scaffold(const IRProgram *program, size_t begin_i, int start_label) {
+    if (!program) return false;
+    const Ir2AelRegions *tree = ir2ael_regions_for(program);
+    if (tree) {
+        const Ir2AelRegion *r = ir2ael_regions_at(tree, begin_i, IR2AEL_REGION_LOOP);
+        if (r) {
+            if (r->branch_i == SIZE_MAX) return false;
+            return start_label < 0 || r->label != start_label || r->alt_label;
+        }
+    }
+    for (size_t j = ir_next_for_scaffold_branch(program, begin_i, begin_i + 1); j != SIZE_MAX;
+         j = ir_next_for_scaffold_branch(program, begin_i, j + 1)) {
+        if (start_label >= 0 && program->insts[j].arg1 == start_label) continue;
         return true;
     }
     return false;
 }
 
-bool switch_emit_pending_case_before_stmt(AelEmitter *out, SwitchCtx *sw, int stmt_line0, int stmt_col0, int *anon_sp, int *anon_stack) {
+bool switch_emit_pending_case_before_stmt(AelEmitter *out, SwitchCtx *sw, int stmt_line0, int stmt_col0, AnonDepthStack *anon) {
     if (!out || !sw || !sw->active) return true;
     if (sw->pending_case_emitted || sw->pending_case_kind == 0) return true;
 
@@ -1993,7 +2112,7 @@ bool switch_emit_pending_case_before_stmt(AelEmitter *out, SwitchCtx *sw, int st
     } else {
         if (case_line0 < sw->line0 + 1) case_line0 = sw->line0 + 1;
     }
-    if (!ensure_switch_opened(out, sw, case_line0, anon_sp, anon_stack)) return false;
+    if (!ensure_switch_opened(out, sw, case_line0, anon)) return false;
     if (case_line0 < out->line0) case_line0 = out->line0;
     if (!ael_emit_at(out, case_line0, case_col0)) return false;
 
@@ -2010,13 +2129,13 @@ bool switch_emit_pending_case_before_stmt(AelEmitter *out, SwitchCtx *sw, int st
     return true;
 }
 
-bool switch_emit_pending_case_label_only(AelEmitter *out, SwitchCtx *sw, int *anon_sp, int *anon_stack) {
+bool switch_emit_pending_case_label_only(AelEmitter *out, SwitchCtx *sw, AnonDepthStack *anon) {
     if (!out || !sw || !sw->active) return true;
     if (sw->pending_case_emitted || sw->pending_case_kind == 0) return true;
 
     int stmt_line0 = out->line0 + 1;
     int stmt_col0 = out->strict_pos ? (sw->col0 + 4) : 0;
-    return switch_emit_pending_case_before_stmt(out, sw, stmt_line0, stmt_col0, anon_sp, anon_stack);
+    return switch_emit_pending_case_before_stmt(out, sw, stmt_line0, stmt_col0, anon);
 }
 
 bool switch_is_epilogue_branch(const IRProgram *program, size_t branch_i, const SwitchCtx *sw) {
@@ -2040,179 +2159,55 @@ bool switch_is_epilogue_branch(const IRProgram *program, size_t branch_i, const
     if (bt->op != OP_BRANCH_TABLE) return false;
     if (sw->table_label >= 0 && set->arg1 != sw->table_label) return false;
 
-    for (size_t k = j + 3; k + 2 < program->count && k < j + 12; k++) {
-        if (program->insts[k].op == OP_LOOP_EXIT &&
-            program->insts[k + 1].op == OP_SET_LABEL && program->insts[k + 1].has_arg1 &&
-            program->insts[k + 1].arg1 == sw->end_label &&
-            program->insts[k + 2].op == OP_END_LOOP) {
+    size_t tail_end = j + IR2AEL_SCAN_SWITCH_TAIL;
+    if (tail_end > program->count - 1) tail_end = program->count - 1;
+    for (size_t lab = ir_next_set_label(program, sw->end_label, j + 4, tail_end); lab < tail_end;
+         lab = ir_next_set_label(program, sw->end_label, lab + 1, tail_end)) {
+        if (program->insts[lab - 1].op == OP_LOOP_EXIT && program->insts[lab + 1].op == OP_END_LOOP) {
             return true;
         }
     }
     return false;
 }
 
-bool scan_for_if_header_line(const IRProgram *program, size_t start, size_t max_scan, int line0) {
-    if (!program) return false;
-    size_t end = start + max_scan;
+/* Matches an if-header template at i; returns the header's BRANCH_TRUE position, or `end` (clamped) if none. */
+size_t ir_if_header_scan(const IRProgram *program, size_t i, size_t end) {
+    if (!program) return end;
     if (end > program->count) end = program->count;
-    for (size_t j = start; j + 3 < end; j++) {
-        const IRInst *a = &program->insts[j];
-        const IRInst *b = &program->insts[j + 1];
-        const IRInst *c = &program->insts[j + 2];
-        const IRInst *d = &program->insts[j + 3];
-        if (a->op == OP_OP && a->has_arg1 && a->arg1 == 59 && a->has_arg2 && a->arg2 == line0 &&
-            b->op == OP_ADD_LABEL &&
-            c->op == OP_OP && c->has_arg1 && c->arg1 == 3 &&
-            d->op == OP_BRANCH_TRUE && d->has_arg1) {
-            return true;
-        }
-    }
-    return false;
-}
-
-bool scan_for_if_header_any(const IRProgram *program, size_t start, size_t max_scan, int *out_line0) {
-    if (out_line0) *out_line0 = -1;
-    if (!program) return false;
-    size_t end = start + max_scan;
-    if (end > program->count) end = program->count;
-    for (size_t j = start; j + 3 < end; j++) {
-        const IRInst *a = &program->insts[j];
-        if (!(a->op == OP_OP && a->has_arg1 && a->arg1 == 59)) continue;
+    if (i >= end) return end;
+    size_t found = end;
+    size_t k = i;
+    const IRInst *a = &program->insts[i];
+    if (!(a->op == OP_OP && a->has_arg1 && a->arg1 == 59)) goto done;
 
-        size_t k = j + 1;
-        for (; k < end; k++) {
-            const IRInst *mj = &program->insts[k];
-            if (mj->op == OP_NUM_LOCAL || mj->op == OP_DROP_LOCAL) continue;
-            if (mj->op == OP_OP && mj->has_arg1 && (mj->arg1 == 60 || mj->arg1 == 61)) continue;
-            break;
-        }
-        if (k >= end || program->insts[k].op != OP_ADD_LABEL) continue;
-        k++;
+    k = ir_skip_scope_bookkeeping_end(program, i + 1, end);
+    if (k >= end || program->insts[k].op != OP_ADD_LABEL) goto done;
+    k = ir_skip_scope_bookkeeping_end(program, k + 1, end);
+    if (k >= end) goto done;
 
-        for (; k < end; k++) {
-            const IRInst *mj = &program->insts[k];
-            if (mj->op == OP_NUM_LOCAL || mj->op == OP_DROP_LOCAL) continue;
-            if (mj->op == OP_OP && mj->has_arg1 && (mj->arg1 == 60 || mj->arg1 == 61)) continue;
-            break;
-        }
-        if (k >= end) continue;
-
-        /* Accept both plain and short-circuit if-header tails:
-           - OP=3; BRANCH_TRUE
-           - OP=62/63; OP=36; [OP=3]; BRANCH_TRUE */
-        if (program->insts[k].op == OP_OP && program->insts[k].has_arg1 &&
-            (program->insts[k].arg1 == 62 || program->insts[k].arg1 == 63)) {
-            int marker = program->insts[k].arg1;
-            k++;
-            k = ir_skip_scope_bookkeeping_end(program, k, end);
-            if (k >= end || !(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 36)) continue;
-            k++;
-            k = ir_skip_scope_bookkeeping_end(program, k, end);
-            if (marker == 62) {
-                if (k >= end || !(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) continue;
-                k++;
-                k = ir_skip_scope_bookkeeping_end(program, k, end);
-            }
-            if (k >= end || !(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) continue;
-        } else {
-            if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) continue;
-            k++;
-
-            for (; k < end; k++) {
-                const IRInst *mj = &program->insts[k];
-                if (mj->op == OP_NUM_LOCAL || mj->op == OP_DROP_LOCAL) continue;
-                if (mj->op == OP_OP && mj->has_arg1 && (mj->arg1 == 60 || mj->arg1 == 61)) continue;
-                break;
-            }
-            if (k >= end || !(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) continue;
+    if (program->insts[k].op == OP_OP && program->insts[k].has_arg1 &&
+        (program->insts[k].arg1 == 62 || program->insts[k].arg1 == 63)) {
+        int marker = program->insts[k].arg1;
+        k = ir_skip_scope_bookkeeping_end(program, k + 1, end);
+        if (k >= end || !(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 36)) goto done;
+        k = ir_skip_scope_bookkeeping_end(program, k + 1, end);
+        if (k >= end) goto done;
+        if (marker == 62) {
+            if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) goto done;
+            k = ir_skip_scope_bookkeeping_end(program, k + 1, end);
+            if (k >= end) goto done;
         }
-
-        if (out_line0 && a->has_arg2) *out_line0 = a->arg2;
-        return true;
+        if (!(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) goto done;
+    } else {
+        if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) goto done;
+        k = ir_skip_scope_bookkeeping_end(program, k + 1, end);
+        if (k >= end || !(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) goto done;
     }
-    return false;
-}
-
-bool scan_for_if_header_until_label(const IRProgram *program, size_t start, size_t max_scan, int stop_label, int expected_depth, int *out_line0) {
-    if (out_line0) *out_line0 = -1;
-    if (!program) return false;
-    size_t end = start + max_scan;
-    if (end > program->count) end = program->count;
-    for (size_t j = start; j + 3 < end; j++) {
-        const IRInst *a = &program->insts[j];
-        if (stop_label >= 0 && a->op == OP_SET_LABEL && a->has_arg1 && a->arg1 == stop_label) break;
-        if (a->op == OP_BEGIN_FUNCT || a->op == OP_DEFINE_FUNCT) break;
-        if (!(a->op == OP_OP && a->has_arg1 && a->arg1 == 59)) continue;
-        if (!(expected_depth < 0 || !a->has_depth || a->depth == expected_depth)) continue;
-
-        size_t k = j + 1;
-        for (; k < end; k++) {
-            const IRInst *mj = &program->insts[k];
-            if (stop_label >= 0 && mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == stop_label) break;
-            if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
-            if (mj->op == OP_NUM_LOCAL || mj->op == OP_DROP_LOCAL) continue;
-            if (mj->op == OP_OP && mj->has_arg1 && (mj->arg1 == 60 || mj->arg1 == 61)) continue;
-            break;
-        }
-        if (k >= end) continue;
-        if (stop_label >= 0 && program->insts[k].op == OP_SET_LABEL && program->insts[k].has_arg1 && program->insts[k].arg1 == stop_label) break;
-        if (program->insts[k].op != OP_ADD_LABEL) continue;
-        k++;
-
-        for (; k < end; k++) {
-            const IRInst *mj = &program->insts[k];
-            if (stop_label >= 0 && mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == stop_label) break;
-            if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
-            if (mj->op == OP_NUM_LOCAL || mj->op == OP_DROP_LOCAL) continue;
-            if (mj->op == OP_OP && mj->has_arg1 && (mj->arg1 == 60 || mj->arg1 == 61)) continue;
-            break;
-        }
-        if (k >= end) continue;
-        if (stop_label >= 0 && program->insts[k].op == OP_SET_LABEL && program->insts[k].has_arg1 && program->insts[k].arg1 == stop_label) break;
-        if (k >= end) continue;
-
-        /* Accept plain or short-circuit if-header tails. */
-        if (program->insts[k].op == OP_OP && program->insts[k].has_arg1 &&
-            (program->insts[k].arg1 == 62 || program->insts[k].arg1 == 63)) {
-            int marker = program->insts[k].arg1;
-            k++;
-            k = ir_skip_scope_bookkeeping_end(program, k, end);
-            if (k >= end) continue;
-            if (stop_label >= 0 && program->insts[k].op == OP_SET_LABEL && program->insts[k].has_arg1 && program->insts[k].arg1 == stop_label) break;
-            if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 36)) continue;
-            k++;
-            k = ir_skip_scope_bookkeeping_end(program, k, end);
-            if (k >= end) continue;
-            if (stop_label >= 0 && program->insts[k].op == OP_SET_LABEL && program->insts[k].has_arg1 && program->insts[k].arg1 == stop_label) break;
-            if (marker == 62) {
-                if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) continue;
-                k++;
-                k = ir_skip_scope_bookkeeping_end(program, k, end);
-                if (k >= end) continue;
-                if (stop_label >= 0 && program->insts[k].op == OP_SET_LABEL && program->insts[k].has_arg1 && program->insts[k].arg1 == stop_label) break;
-            }
-            if (!(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) continue;
-        } else {
-            if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) continue;
-            k++;
-
-            for (; k < end; k++) {
-                const IRInst *mj = &program->insts[k];
-                if (stop_label >= 0 && mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == stop_label) break;
-                if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
-                if (mj->op == OP_NUM_LOCAL || mj->op == OP_DROP_LOCAL) continue;
-                if (mj->op == OP_OP && mj->has_arg1 && (mj->arg1 == 60 || mj->arg1 == 61)) continue;
-                break;
-            }
-            if (k >= end) continue;
-            if (stop_label >= 0 && program->insts[k].op == OP_SET_LABEL && program->insts[k].has_arg1 && program->insts[k].arg1 == stop_label) break;
-            if (!(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) continue;
-        }
+    found = k;
 
-        if (out_line0 && a->has_arg2) *out_line0 = a->arg2;
-        return true;
-    }
-    return false;
+done:
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_IF_HEADER_SCAN, (k < end ? k + 1 : end) - i);
+    return found;
 }
 
 bool ir_if_header_at(const IRProgram *program, size_t i, size_t end, int expected_depth, int *out_line0) {
@@ -2224,34 +2219,13 @@ bool ir_if_header_at(const IRProgram *program, size_t i, size_t end, int expecte
     if (!(a->op == OP_OP && a->has_arg1 && a->arg1 == 59)) return false;
     if (!(expected_depth < 0 || !a->has_depth || a->depth == expected_depth)) return false;
 
-    size_t k = i + 1;
-    k = ir_skip_scope_bookkeeping_end(program, k, end);
-    if (k >= end || program->insts[k].op != OP_ADD_LABEL) return false;
-    k++;
-    k = ir_skip_scope_bookkeeping_end(program, k, end);
-    if (k >= end) return false;
-
-    if (program->insts[k].op == OP_OP && program->insts[k].has_arg1 &&
-        (program->insts[k].arg1 == 62 || program->insts[k].arg1 == 63)) {
-        int marker = program->insts[k].arg1;
-        k++;
-        k = ir_skip_scope_bookkeeping_end(program, k, end);
-        if (k >= end || !(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 36)) return false;
-        k++;
-        k = ir_skip_scope_bookkeeping_end(program, k, end);
-        if (k >= end) return false;
-        if (marker == 62) {
-            if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) return false;
-            k++;
-            k = ir_skip_scope_bookkeeping_end(program, k, end);
-            if (k >= end) return false;
-        }
-        if (!(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) return false;
-    } else {
-        if (!(program->insts[k].op == OP_OP && program->insts[k].has_arg1 && program->insts[k].arg1 == 3)) return false;
-        k++;
-        k = ir_skip_scope_bookkeeping_end(program, k, end);
-        if (k >= end || !(program->insts[k].op == OP_BRANCH_TRUE && program->insts[k].has_arg1)) return false;
+    /* A header is valid for `end` iff it is valid for the whole program and its BRANCH_TRUE lies before `end`. */
+    const Ir2AelRegions *tree = ir2ael_regions_for(program);
+    if (tree) {
+        const Ir2AelRegion *r = ir2ael_regions_at(tree, i, IR2AEL_REGION_IF);
+        if (!r || r->branch_i >= end) return false;
+    } else if (ir_if_header_scan(program, i, end) >= end) {
+        return false;
     }
 
     if (out_line0 && a->has_arg2) *out_line0 = a->arg2;
@@ -2262,18 +2236,19 @@ bool ir_else_if_chain_at(const IRProgram *program, size_t i, size_t end, int exp
     if (!ir_if_header_at(program, i, end, expected_depth, out_line0)) return false;
     if (!program || outer_end_label < 0) return false;
     if (end > program->count) end = program->count;
-    size_t scan_end = end;
-    for (size_t j = i; j + 2 < scan_end; j++) {
-        const IRInst *mj = &program->insts[j];
-        if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
-        if (mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == outer_end_label) break;
-        if (mj->op == OP_LOAD_TRUE &&
-            program->insts[j + 1].op == OP_BRANCH_TRUE && program->insts[j + 1].has_arg1 &&
-            program->insts[j + 1].arg1 == outer_end_label &&
-            program->insts[j + 2].op == OP_SET_LABEL) {
+    if (end < i + 3) return false;
+    /* Look for LOAD_TRUE, BRANCH_TRUE outer_end, SET_LABEL before the outer end label / function boundary. */
+    size_t limit = ir_next_funct_boundary(program, i, end - 2);
+    limit = ir_next_set_label(program, outer_end_label, i, limit);
+    if (limit == end - 2) limit = end - 1;
+    for (size_t b = ir_next_branch_true(program, outer_end_label, i + 1, limit); b < limit;
+         b = ir_next_branch_true(program, outer_end_label, b + 1, limit)) {
+        if (program->insts[b - 1].op == OP_LOAD_TRUE && program->insts[b + 1].op == OP_SET_LABEL) {
+            IR2AEL_PROF_SCAN(IR2AEL_PROF_S_ELSE_IF_CHAIN, b + 2 - i);
             return true;
         }
     }
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_ELSE_IF_CHAIN, limit - i);
     return false;
 }
 
@@ -2281,7 +2256,8 @@ bool num_local_should_open_scope_block(const IRProgram *program, size_t i, int t
     if (!program) return false;
     if (target_depth <= 1) return false;
 
-    for (size_t j = i + 1; j < program->count && j < i + 256; j++) {
+    size_t j = i + 1;
+    for (; j < program->count && j < i + IR2AEL_SCAN_ELSE_IF; j++) {
         const IRInst *mj = &program->insts[j];
         if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
 
@@ -2290,6 +2266,7 @@ bool num_local_should_open_scope_block(const IRProgram *program, size_t i, int t
 
         /* Evidence of a real source block-scope: locals declared at the new depth. */
         if (mj->op == OP_ADD_LOCAL && mj->has_depth && mj->depth == target_depth) {
+            IR2AEL_PROF_SCAN(IR2AEL_PROF_S_NUM_LOCAL_SCOPE_BLOCK, j - i);
             return true;
         }
 
@@ -2298,10 +2275,12 @@ bool num_local_should_open_scope_block(const IRProgram *program, size_t i, int t
         if (mj->op == OP_OP && mj->has_arg1 && mj->has_arg2 &&
             (mj->arg1 == 16 || mj->arg1 == 20 || mj->arg1 == 48 || mj->arg1 == 59)) {
             if (!mj->has_depth || mj->depth <= target_depth) {
+                IR2AEL_PROF_SCAN(IR2AEL_PROF_S_NUM_LOCAL_SCOPE_BLOCK, j - i);
                 return false;
             }
         }
     }
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_NUM_LOCAL_SCOPE_BLOCK, j - i);
     return false;
 }
 
@@ -2318,7 +2297,7 @@ bool scan_for_assignment_to_var(const IRProgram *program, size_t start, size_t m
         if (strict_depth && a->has_depth && a->depth != depth) continue;
 
         bool saw_assign = false;
-        for (size_t j = i + 1; j < end && j < i + 48; j++) {
+        for (size_t j = i + 1; j < end && j < i + IR2AEL_SCAN_ASSIGN_STORE; j++) {
             const IRInst *b = &program->insts[j];
             if (b->op == OP_BEGIN_FUNCT || b->op == OP_DEFINE_FUNCT) break;
             if (strict_depth && b->has_depth && b->depth < depth) break;
@@ -2352,12 +2331,12 @@ bool find_for_header_lparen_col0(const IRProgram *program, size_t start, size_t
     if (!program) return false;
     size_t end = start + max_scan;
     if (end > program->count) end = program->count;
-    for (size_t j = start; j < program->count && j < end; j++) {
+    end = ir_next_funct_boundary(program, start, end);
+    if (loop_end_label >= 0) end = ir_next_set_label(program, loop_end_label, start, end);
+    for (size_t j = ir_next_branch_true(program, incr_label, start, end); j < end;
+         j = ir_next_branch_true(program, incr_label, j + 1, end)) {
         const IRInst *mj = &program->insts[j];
-        if (mj->op == OP_BEGIN_FUNCT || mj->op == OP_DEFINE_FUNCT) break;
-        if (loop_end_label >= 0 && mj->op == OP_SET_LABEL && mj->has_arg1 && mj->arg1 == loop_end_label) break;
-        if (mj->op == OP_BRANCH_TRUE && mj->has_arg1 && mj->arg1 == incr_label &&
-            mj->has_arg2 && mj->has_arg3 && mj->arg2 == line0) {
+        if (mj->has_arg2 && mj->has_arg3 && mj->arg2 == line0) {
             if (out_col0) *out_col0 = mj->arg3;
             return true;
         }
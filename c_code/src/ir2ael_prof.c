@@ -0,0 +1,126 @@
+/* ir2ael_prof.c - per-handler and lookahead counters (IR2AEL_PROFILE builds only) */
+#include "ir2ael_prof.h"
+
+#if IR2AEL_PROF_ENABLED
+
+#include "ir2ael_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <windows.h>
+#define PROF_ADD(p, v) _InterlockedExchangeAdd64((volatile __int64 *)(p), (__int64)(v))
+#define PROF_ONCE(flag) (_InterlockedExchange((volatile long *)(flag), 1) == 0)
+#else
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <time.h>
+#define PROF_ADD(p, v) __atomic_fetch_add((p), (long long)(v), __ATOMIC_RELAXED)
+#define PROF_ONCE(flag) (__atomic_exchange_n((flag), 1, __ATOMIC_ACQ_REL) == 0)
+#endif
+
+typedef struct HandlerCounters {
+    long long calls;
+    long long hits;
+    long long cycles;
+} HandlerCounters;
+
+typedef struct ScanCounters {
+    long long calls;
+    long long scanned;
+} ScanCounters;
+
+static const char *const k_handler_names[IR2AEL_PROF_H_COUNT] = {
+    "ir2ael_handle_function_ops",
+    "ir2ael_handle_decl_ops",
+    "ir2ael_handle_scope_ops",
+    "ir2ael_handle_load_ops",
+    "ir2ael_handle_expr_ops",
+    "ir2ael_flow_handle_switch_ops",
+    "ir2ael_flow_handle_begin_loop",
+    "ir2ael_flow_handle_end_loop",
+    "ir2ael_flow_handle_loop_ctrl",
+    "ir2ael_flow_handle_add_label",
+    "ir2ael_flow_handle_set_label",
+    "ir2ael_flow_handle_branch_true",
+    "ir2ael_flow_handle_load_true",
+};
+
+static const char *const k_scan_names[IR2AEL_PROF_S_COUNT] = {
+    "ir_if_header_scan",
+    "ir_else_if_chain_at",
+    "ir_next_* (label index)",
+    "ir_next_* (linear)",
+    "parse_expr_range",
+    "num_local_should_open_scope_block",
+};
+
+static HandlerCounters g_handlers[IR2AEL_PROF_H_COUNT];
+static ScanCounters g_scans[IR2AEL_PROF_S_COUNT];
+static long g_report_registered = 0;
+
+static void prof_report(void) {
+    FILE *fp = stderr;
+    fprintf(fp, "[ir2ael-prof] %-34s %12s %12s %16s %12s\n", "handler", "calls", "hits", "cycles", "cycles/call");
+    for (int h = 0; h < IR2AEL_PROF_H_COUNT; h++) {
+        const HandlerCounters *c = &g_handlers[h];
+        if (!c->calls) continue;
+        fprintf(fp, "[ir2ael-prof] %-34s %12lld %12lld %16lld %12.1f\n", k_handler_names[h], c->calls, c->hits,
+                c->cycles, (double)c->cycles / (double)c->calls);
+    }
+    fprintf(fp, "[ir2ael-prof] %-34s %12s %12s %16s\n", "lookahead", "calls", "scanned", "scanned/call");
+    for (int k = 0; k < IR2AEL_PROF_S_COUNT; k++) {
+        const ScanCounters *c = &g_scans[k];
+        if (!c->calls) continue;
+        fprintf(fp, "[ir2ael-prof] %-34s %12lld %12lld %16.1f\n", k_scan_names[k], c->calls, c->scanned,
+                (double)c->scanned / (double)c->calls);
+    }
+}
+
+static void prof_register(void) {
+    if (!g_report_registered && PROF_ONCE(&g_report_registered)) atexit(prof_report);
+}
+
+/* TSC where available (x86/x64), otherwise a monotonic clock in nanoseconds. */
+uint64_t ir2ael_prof_now(void) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(_MSC_VER)
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return (uint64_t)t.QuadPart;
+#elif defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void ir2ael_prof_handler(Ir2AelProfHandler h, int status, uint64_t cycles) {
+    if ((int)h < 0 || h >= IR2AEL_PROF_H_COUNT) return;
+    prof_register();
+    HandlerCounters *c = &g_handlers[h];
+    PROF_ADD(&c->calls, 1);
+    if (status == IR2AEL_STATUS_HANDLED) PROF_ADD(&c->hits, 1);
+    PROF_ADD(&c->cycles, cycles);
+}
+
+void ir2ael_prof_scan(Ir2AelProfScan helper, size_t scanned) {
+    if ((int)helper < 0 || helper >= IR2AEL_PROF_S_COUNT) return;
+    prof_register();
+    ScanCounters *c = &g_scans[helper];
+    PROF_ADD(&c->calls, 1);
+    PROF_ADD(&c->scanned, scanned);
+}
+
+#else
+
+/* ISO C wants at least one declaration per translation unit. */
+typedef int ir2ael_prof_disabled;
+
+#endif
@@ -0,0 +1,157 @@
+/* ir2ael_regions.c - structured regions recovered once from an IRProgram */
+#include "ir2ael_internal.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Region tree consulted by the flow helpers on this thread (NULL: they pattern-match the instruction stream). */
+static IR2AEL_THREAD_LOCAL const Ir2AelRegions *g_regions = NULL;
+
+static bool push_region(Ir2AelRegions *tree, size_t *cap, const Ir2AelRegion *r) {
+    if (tree->region_count == *cap) {
+        size_t ncap = *cap ? *cap * 2 : 64;
+        Ir2AelRegion *nr = (Ir2AelRegion *)realloc(tree->regions, ncap * sizeof(*nr));
+        if (!nr) return false;
+        tree->regions = nr;
+        *cap = ncap;
+    }
+    tree->regions[tree->region_count++] = *r;
+    return true;
+}
+
+/* Pops open regions until one of `kind` has been closed at `end` (no-op if none of that kind is open). */
+static void close_regions(Ir2AelRegions *tree, long *open, size_t *open_sp, Ir2AelRegionKind kind, size_t end) {
+    size_t k = *open_sp;
+    while (k > 0 && tree->regions[open[k - 1]].kind != kind) k--;
+    if (k == 0) return;
+    while (*open_sp >= k) {
+        Ir2AelRegion *r = &tree->regions[open[--(*open_sp)]];
+        if (r->end == SIZE_MAX || r->end > end) r->end = end;
+    }
+}
+
+static bool build_regions(Ir2AelRegions *tree) {
+    const IRProgram *p = tree->program;
+    size_t cap = 0;
+    size_t open_cap = 64;
+    size_t open_sp = 0;
+    long *open = (long *)malloc(open_cap * sizeof(*open));
+    if (!open) return false;
+
+    size_t scope_end = ir_next_funct_boundary(p, 0, p->count);
+    for (size_t i = 0; i < p->count; i++) {
+        const IRInst *inst = &p->insts[i];
+        if (i >= scope_end || inst->op == OP_BEGIN_FUNCT || inst->op == OP_DEFINE_FUNCT) {
+            scope_end = ir_next_funct_boundary(p, i + 1, p->count);
+        }
+
+        /* If regions end at their false label; drop them once we are past it. */
+        while (open_sp > 0 && tree->regions[open[open_sp - 1]].end <= i) open_sp--;
+
+        if (inst->op == OP_DEFINE_FUNCT) {
+            close_regions(tree, open, &open_sp, IR2AEL_REGION_FUNCTION, i + 1);
+            continue;
+        }
+        if (inst->op == OP_END_LOOP) {
+            close_regions(tree, open, &open_sp, IR2AEL_REGION_LOOP, i + 1);
+            continue;
+        }
+
+        Ir2AelRegion r;
+        memset(&r, 0, sizeof(r));
+        r.begin = i;
+        r.end = SIZE_MAX;
+        r.parent = open_sp > 0 ? open[open_sp - 1] : -1;
+        r.branch_i = SIZE_MAX;
+        r.label = -1;
+
+        if (inst->op == OP_BEGIN_FUNCT) {
+            r.kind = IR2AEL_REGION_FUNCTION;
+        } else if (inst->op == OP_BEGIN_LOOP) {
+            r.kind = IR2AEL_REGION_LOOP;
+            size_t j = ir_next_for_scaffold_branch(p, i, i + 1);
+            if (j != SIZE_MAX) {
+                r.branch_i = j;
+                r.label = p->insts[j].arg1;
+                for (j = ir_next_for_scaffold_branch(p, i, j + 1); j != SIZE_MAX && !r.alt_label;
+                     j = ir_next_for_scaffold_branch(p, i, j + 1)) {
+                    if (p->insts[j].arg1 != r.label) r.alt_label = true;
+                }
+            }
+        } else if (inst->op == OP_OP && inst->has_arg1 && inst->arg1 == 59) {
+            size_t b = ir_if_header_scan(p, i, p->count);
+            if (b >= p->count) continue;
+            r.kind = IR2AEL_REGION_IF;
+            r.branch_i = b;
+            r.label = p->insts[b].arg1;
+            size_t set = ir_next_set_label(p, r.label, b + 1, scope_end);
+            r.end = (set < scope_end) ? set + 1 : b + 1;
+        } else {
+            continue;
+        }
+
+        if (!push_region(tree, &cap, &r)) {
+            free(open);
+            return false;
+        }
+        if (open_sp == open_cap) {
+            long *no = (long *)realloc(open, open_cap * 2 * sizeof(*open));
+            if (!no) {
+                free(open);
+                return false;
+            }
+            open = no;
+            open_cap *= 2;
+        }
+        open[open_sp++] = (long)(tree->region_count - 1);
+    }
+
+    for (size_t k = 0; k < tree->region_count; k++) {
+        if (tree->regions[k].end == SIZE_MAX) tree->regions[k].end = p->count;
+    }
+    free(open);
+    return true;
+}
+
+bool ir2ael_regions_build(Ir2AelRegions *tree, const IRProgram *program) {
+    if (!tree) return false;
+    memset(tree, 0, sizeof(*tree));
+    if (!program) return false;
+    tree->program = program;
+    if (!build_regions(tree)) {
+        ir2ael_regions_free(tree);
+        return false;
+    }
+    tree->valid = true;
+    return true;
+}
+
+void ir2ael_regions_free(Ir2AelRegions *tree) {
+    if (!tree) return;
+    free(tree->regions);
+    memset(tree, 0, sizeof(*tree));
+}
+
+const Ir2AelRegions *ir2ael_regions_bind(const Ir2AelRegions *tree) {
+    const Ir2AelRegions *prev = g_regions;
+    g_regions = (tree && tree->valid) ? tree : NULL;
+    return prev;
+}
+
+const Ir2AelRegions *ir2ael_regions_for(const IRProgram *program) {
+    return (g_regions && g_regions->program == program) ? g_regions : NULL;
+}
+
+const Ir2AelRegion *ir2ael_regions_at(const Ir2AelRegions *tree, size_t begin, Ir2AelRegionKind kind) {
+    if (!tree) return NULL;
+    size_t lo = 0, hi = tree->region_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tree->regions[mid].begin < begin) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < tree->region_count && tree->regions[lo].begin == begin && tree->regions[lo].kind == kind) {
+        return &tree->regions[lo];
+    }
+    return NULL;
+}
@@ -0,0 +1,176 @@
+#include "ir_binary.h"
+#include "ir_label_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool ir_binary_detect(const void *data, size_t len) {
+    return data && len >= sizeof(IrbHeader) && memcmp(data, IRB_MAGIC, 8) == 0;
+}
+
+bool ir_binary_load_buffer(const void *data, size_t len, IRProgram *out_program, char *err, size_t err_cap) {
+    if (!data || !out_program) return false;
+    if (err && err_cap) err[0] = '\0';
+
+    if (!ir_binary_detect(data, len)) {
+        if (err && err_cap) snprintf(err, err_cap, "not a binary IR image");
+        return false;
+    }
+    IrbHeader hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.version != IRB_VERSION || hdr.record_size != sizeof(IrbRecord)) {
+        if (err && err_cap) snprintf(err, err_cap, "unsupported binary IR version %u", (unsigned)hdr.version);
+        return false;
+    }
+    size_t recs_bytes = (size_t)hdr.inst_count * sizeof(IrbRecord);
+    if (hdr.inst_count > (len - sizeof(IrbHeader)) / sizeof(IrbRecord) ||
+        hdr.strtab_size > len - sizeof(IrbHeader) - recs_bytes) {
+        if (err && err_cap) snprintf(err, err_cap, "truncated binary IR image");
+        return false;
+    }
+    const unsigned char *base = (const unsigned char *)data;
+    const unsigned char *recs = base + sizeof(IrbHeader);
+    const char *strtab = (const char *)(recs + recs_bytes);
+
+    IRProgram tmp;
+    ir_program_init(&tmp);
+    if (hdr.inst_count > 0) {
+        tmp.insts = (IRInst *)malloc((size_t)hdr.inst_count * sizeof(IRInst));
+        if (!tmp.insts) goto oom;
+        tmp.cap = hdr.inst_count;
+    }
+
+    for (uint32_t k = 0; k < hdr.inst_count; k++) {
+        IrbRecord r;
+        memcpy(&r, recs + (size_t)k * sizeof(IrbRecord), sizeof(r));
+        IRInst *inst = &tmp.insts[k];
+        memset(inst, 0, sizeof(*inst));
+        inst->index = r.index;
+        inst->op = r.op;
+        inst->has_depth = (r.flags & IRB_F_DEPTH) != 0;
+        inst->depth = r.depth;
+        inst->has_arg1 = (r.flags & IRB_F_ARG1) != 0;
+        inst->has_arg2 = (r.flags & IRB_F_ARG2) != 0;
+        inst->has_arg3 = (r.flags & IRB_F_ARG3) != 0;
+        inst->has_a4 = (r.flags & IRB_F_A4) != 0;
+        inst->arg1 = r.arg1;
+        inst->arg2 = r.arg2;
+        inst->arg3 = r.arg3;
+        inst->a4 = r.a4;
+        inst->has_num_val = (r.flags & IRB_F_NUM_VAL) != 0;
+        inst->num_val = r.num_val;
+        if (r.str_off != IRB_NO_STR) {
+            if (r.str_off >= hdr.strtab_size || r.str_len >= hdr.strtab_size - r.str_off ||
+                strtab[r.str_off + r.str_len] != '\0') {
+                tmp.count = k;
+                ir_program_free(&tmp);
+                if (err && err_cap) snprintf(err, err_cap, "bad string reference at IR index %u", (unsigned)k);
+                return false;
+            }
+            inst->str_id = str_intern(&tmp.strings, strtab + r.str_off, r.str_len);
+            if (inst->str_id == STR_INTERN_NONE) {
+                tmp.count = k;
+                goto oom;
+            }
+            inst->str = str_intern_get(&tmp.strings, inst->str_id);
+        }
+        tmp.count = k + 1;
+    }
+
+    (void)ir_label_index_build(&tmp);
+    *out_program = tmp;
+    return true;
+
+oom:
+    ir_program_free(&tmp);
+    if (err && err_cap) snprintf(err, err_cap, "out of memory");
+    return false;
+}
+
+bool ir_binary_write_file(const IRProgram *program, const char *path, char *err, size_t err_cap) {
+    if (!program || !path) return false;
+    if (err && err_cap) err[0] = '\0';
+
+    /* Interned strings are written once; records with the same str_id share an offset. */
+    size_t strtab_size = 0;
+    uint32_t id_count = program->strings.count;
+    for (uint32_t id = 1; id < id_count; id++) {
+        strtab_size += program->strings.entries[id].len + 1;
+    }
+    for (size_t k = 0; k < program->count; k++) {
+        const IRInst *inst = &program->insts[k];
+        if (inst->str && inst->str_id == STR_INTERN_NONE) strtab_size += strlen(inst->str) + 1;
+    }
+    if (program->count > 0xFFFFFFFFu || strtab_size >= IRB_NO_STR) {
+        if (err && err_cap) snprintf(err, err_cap, "program too large for binary IR");
+        return false;
+    }
+
+    IrbRecord *recs = (IrbRecord *)calloc(program->count ? program->count : 1, sizeof(IrbRecord));
+    char *strtab = (char *)malloc(strtab_size ? strtab_size : 1);
+    uint32_t *id_off = (uint32_t *)malloc((id_count ? id_count : 1) * sizeof(uint32_t));
+    if (!recs || !strtab || !id_off) {
+        free(recs);
+        free(strtab);
+        free(id_off);
+        if (err && err_cap) snprintf(err, err_cap, "out of memory");
+        return false;
+    }
+
+    size_t str_pos = 0;
+    for (uint32_t id = 1; id < id_count; id++) {
+        const StrInternEntry *e = &program->strings.entries[id];
+        memcpy(strtab + str_pos, e->str, e->len + 1);
+        id_off[id] = (uint32_t)str_pos;
+        str_pos += e->len + 1;
+    }
+    for (size_t k = 0; k < program->count; k++) {
+        const IRInst *inst = &program->insts[k];
+        IrbRecord *r = &recs[k];
+        r->index = inst->index;
+        r->op = inst->op;
+        r->depth = inst->depth;
+        r->arg1 = inst->arg1;
+        r->arg2 = inst->arg2;
+        r->arg3 = inst->arg3;
+        r->a4 = inst->a4;
+        r->flags = (inst->has_depth ? IRB_F_DEPTH : 0) | (inst->has_arg1 ? IRB_F_ARG1 : 0) |
+                   (inst->has_arg2 ? IRB_F_ARG2 : 0) | (inst->has_arg3 ? IRB_F_ARG3 : 0) |
+                   (inst->has_a4 ? IRB_F_A4 : 0) | (inst->has_num_val ? IRB_F_NUM_VAL : 0);
+        r->num_val = inst->num_val;
+        r->str_off = IRB_NO_STR;
+        if (inst->str_id != STR_INTERN_NONE && inst->str_id < id_count) {
+            r->str_off = id_off[inst->str_id];
+            r->str_len = (uint32_t)program->strings.entries[inst->str_id].len;
+        } else if (inst->str) {
+            size_t n = strlen(inst->str);
+            memcpy(strtab + str_pos, inst->str, n + 1);
+            r->str_off = (uint32_t)str_pos;
+            r->str_len = (uint32_t)n;
+            str_pos += n + 1;
+        }
+    }
+
+    IrbHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, IRB_MAGIC, 8);
+    hdr.version = IRB_VERSION;
+    hdr.record_size = (uint32_t)sizeof(IrbRecord);
+    hdr.inst_count = (uint32_t)program->count;
+    hdr.strtab_size = (uint32_t)strtab_size;
+
+    bool ok = false;
+    FILE *fp = fopen(path, "wb");
+    if (fp) {
+        ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+             fwrite(recs, sizeof(IrbRecord), program->count, fp) == program->count &&
+             fwrite(strtab, 1, strtab_size, fp) == strtab_size;
+        if (fclose(fp) != 0) ok = false;
+    }
+    free(recs);
+    free(strtab);
+    free(id_off);
+    if (!ok && err && err_cap) snprintf(err, err_cap, "cannot write: %s", path);
+    return ok;
+}
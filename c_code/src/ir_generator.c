@@ -10,66 +10,75 @@
 #include "ael_debug.h"
 #include "ir_generator.h"
 #include "opcode_metadata.h"
+#include "str_intern.h"
 
 /* Treat IR generator printf/fflush(stdout) as debug-only output. */
 #define printf AEL_DEBUG_PRINTF
 #define fflush(x) AEL_DEBUG_FLUSH()
 
-/* Global state */
-int AcompDepth = 0;
-int AcompInteract = 1;  // Always use IR generation mode
-int AerrFlag = 0;
-static int local_var_count = 0;  // Track number of local variables
-static int label_counter = 0;     // Label counter (reset per function)
-
-/* IR Instruction linked list */
-typedef struct IRInst {
-    struct IRInst *next;
+/* IR instructions, stored contiguously in emission order (AelIrGen::insts) */
+struct IRGenInst {
     int opcode;
     union {
         int64_t int_val;
         double real_val;
-        char *str_val;
+        const char *str_val;  /* interned in AelIrGen::strings */
     };
     int arg1, arg2, arg3, arg4;  /* Changed from int16_t to int to support larger values */
     int depth;  // Store depth per instruction
     int line, column;
-} IRInst;
+};
 
-static IRInst *g_ir_head = NULL;
-static IRInst *g_ir_tail = NULL;
-static int g_ir_count = 0;
+/* Generator state of the compiler bound to this thread */
+static AelIrGen *ir_gen(void) {
+    return &ael_compiler_current()->ir;
+}
 
-/* Helper: Create IR instruction */
-static IRInst *create_ir_inst(int opcode) {
-    IRInst *inst = (IRInst *)calloc(1, sizeof(IRInst));
-    if (!inst) {
-        fprintf(stderr, "Error: Out of memory\n");
-        exit(1);
+/*
+ * Helper: Create IR instruction
+ * The returned pointer is only valid until the next create_ir_inst() call (the array may move).
+ * On OOM the generator is marked failed (AelIrGen::oom, reported by ael_compiler_parse) and a
+ * scratch record is returned, so the acomp_* callers need no checks of their own.
+ */
+static IRGenInst *create_ir_inst(int opcode) {
+    static AEL_THREAD_LOCAL IRGenInst scratch;
+    AelIrGen *gen = ir_gen();
+    IRGenInst *inst = &scratch;
+    if (gen->count == gen->cap && !gen->oom) {
+        int ncap = gen->cap ? gen->cap * 2 : 4096;
+        IRGenInst *ni = (IRGenInst *)realloc(gen->insts, (size_t)ncap * sizeof(IRGenInst));
+        if (ni) {
+            gen->insts = ni;
+            gen->cap = ncap;
+        } else {
+            gen->oom = true;
+        }
     }
+    if (!gen->oom) inst = &gen->insts[gen->count++];
+    memset(inst, 0, sizeof(*inst));
     inst->opcode = opcode;
     inst->depth = AcompDepth;  // Capture current depth
 
-    // Add to linked list
-    if (g_ir_tail) {
-        g_ir_tail->next = inst;
-        g_ir_tail = inst;
-    } else {
-        g_ir_head = inst;
-        g_ir_tail = inst;
-    }
-    g_ir_count++;
-
     return inst;
 }
 
+/* Helper: Intern an instruction string (NULL stays NULL; "" on OOM, see create_ir_inst) */
+static const char *ir_str(const char *s) {
+    AelIrGen *gen = ir_gen();
+    if (!s) return NULL;
+    uint32_t id = str_intern(&gen->strings, s, strlen(s));
+    if (id == STR_INTERN_NONE) {
+        gen->oom = true;
+        return "";
+    }
+    return str_intern_get(&gen->strings, id);
+}
+
 /* Initialize IR generation system */
 void ir_init(void)
 {
     /* Reset IR instruction list */
-    g_ir_head = NULL;
-    g_ir_tail = NULL;
-    g_ir_count = 0;
+    ir_free_all();
 
     /* Set IR generation mode */
     AcompInteract = 1;  // 1 = IR mode, 0 = ATF mode
@@ -79,13 +88,13 @@ void ir_init(void)
 
     printf("[ir_init] IR generation system initialized\n");
     printf("  AcompInteract = %d (IR mode)\n", AcompInteract);
-    printf("  Instruction count = %d\n", g_ir_count);
+    printf("  Instruction count = %d\n", ir_get_count());
 }
 
 /* Get current instruction count */
 int ir_get_count(void)
 {
-    return g_ir_count;
+    return ir_gen()->count;
 }
 
 /* Helper: Get opcode name with function name */
@@ -121,6 +130,97 @@ static const char *get_opcode_name(int opcode) {
     }
 }
 
+/*
+ * IR text writer: output is formatted into a fixed buffer with hand-rolled integer formatting and
+ * handed to the sink in large chunks. Every helper produces exactly what the printf format noted
+ * next to it would, so logs stay byte-identical to the fprintf version.
+ */
+#define IR_WRITER_CAP (64 * 1024)
+
+typedef struct IRWriter {
+    AelIrWriteFn sink;
+    void *sink_ctx;
+    bool ok;                      /* false once the sink has failed; later output is dropped */
+    size_t len;
+    char buf[IR_WRITER_CAP];
+} IRWriter;
+
+static void w_flush(IRWriter *w) {
+    if (w->len && w->ok) w->ok = w->sink(w->sink_ctx, w->buf, w->len);
+    w->len = 0;
+}
+
+static void w_bytes(IRWriter *w, const char *s, size_t n) {
+    if (n > IR_WRITER_CAP - w->len) {
+        w_flush(w);
+        if (n > IR_WRITER_CAP) {
+            if (w->ok) w->ok = w->sink(w->sink_ctx, s, n);
+            return;
+        }
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+#define W_LIT(w, lit) w_bytes((w), (lit), sizeof(lit) - 1)
+
+static void w_str(IRWriter *w, const char *s) {
+    w_bytes(w, s, strlen(s));
+}
+
+/* "%*d": decimal, right-aligned in `width` columns */
+static void w_int(IRWriter *w, int v, int width) {
+    char tmp[16];
+    char *p = tmp + sizeof(tmp);
+    unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+    do {
+        *--p = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (v < 0) *--p = '-';
+    int n = (int)(tmp + sizeof(tmp) - p);
+    char pad[16];
+    if (width > n) {
+        memset(pad, ' ', (size_t)(width - n));
+        w_bytes(w, pad, (size_t)(width - n));
+    }
+    w_bytes(w, p, (size_t)n);
+}
+
+/* "%04X" */
+static void w_hex4(IRWriter *w, unsigned int v) {
+    static const char hex[] = "0123456789ABCDEF";
+    char tmp[16];
+    char *p = tmp + sizeof(tmp);
+    do {
+        *--p = hex[v & 0xF];
+        v >>= 4;
+    } while (v);
+    while (tmp + sizeof(tmp) - p < 4) *--p = '0';
+    w_bytes(w, p, (size_t)(tmp + sizeof(tmp) - p));
+}
+
+/* Floating-point fields keep snprintf: "%.17e" needs its exact decimal rounding. */
+static void w_double(IRWriter *w, const char *fmt, double v) {
+    char tmp[512];
+    int n = snprintf(tmp, sizeof(tmp), fmt, v);
+    if (n > 0) w_bytes(w, tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+}
+
+/* "  arg1=%5d  arg2=%5d  arg3=%5d" */
+static void w_args3(IRWriter *w, const IRGenInst *inst) {
+    W_LIT(w, "  arg1=");
+    w_int(w, inst->arg1, 5);
+    W_LIT(w, "  arg2=");
+    w_int(w, inst->arg2, 5);
+    W_LIT(w, "  arg3=");
+    w_int(w, inst->arg3, 5);
+}
+
+static bool file_sink(void *ctx, const char *data, size_t len) {
+    return fwrite(data, 1, len, (FILE *)ctx) == len;
+}
+
 /* Output IR to file */
 void ir_output_to_file(const char *filename) {
     FILE *fp = fopen(filename, "w");
@@ -128,32 +228,44 @@ void ir_output_to_file(const char *filename) {
         fprintf(stderr, "Error: Cannot open output file: %s\n", filename);
         return;
     }
+    if (!ir_output_to_sink(file_sink, fp)) {
+        fprintf(stderr, "Error: Failed writing IR to %s\n", filename);
+    }
+    fclose(fp);
+}
 
-    fprintf(fp, "# AEL IR Log\n");
-    fprintf(fp, "# Generated by ael2ir compiler\n");
-    fprintf(fp, "#\n\n");
-
-    IRInst *inst = g_ir_head;
-    int addr = 0;
-
-    while (inst) {
-        fprintf(fp, "[%04X] OP=%3d", addr, inst->opcode);
+/* Output IR in the ael2ir text format through `sink`; false on OOM or if the sink failed */
+bool ir_output_to_sink(AelIrWriteFn sink, void *sink_ctx) {
+    AelIrGen *gen = ir_gen();
+    if (gen->oom) return false;  /* never hand out IR with dropped instructions */
+    IRWriter *w = (IRWriter *)malloc(sizeof(IRWriter));
+    if (!w) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return false;
+    }
+    w->sink = sink;
+    w->sink_ctx = sink_ctx;
+    w->ok = true;
+    w->len = 0;
+
+    W_LIT(w, "# AEL IR Log\n");
+    W_LIT(w, "# Generated by ael2ir compiler\n");
+    W_LIT(w, "#\n\n");
+
+    for (int addr = 0; addr < gen->count; addr++) {
+        const IRGenInst *inst = &gen->insts[addr];
+        /* "[%04X] OP=%3d" */
+        W_LIT(w, "[");
+        w_hex4(w, (unsigned int)addr);
+        W_LIT(w, "] OP=");
+        w_int(w, inst->opcode, 3);
 
         // Display arguments based on opcode type
         switch (inst->opcode) {
             case 3:  // LOAD_INT
-                fprintf(fp, "  arg1=%5d  arg2=%5d  arg3=%5d",
-                        inst->arg1, inst->arg2, inst->arg3);
-                break;
-
             case 8:  // LOAD_REAL
-                fprintf(fp, "  arg1=%5d  arg2=%5d  arg3=%5d",
-                        inst->arg1, inst->arg2, inst->arg3);
-                break;
-
             case 9:  // LOAD_IMAG
-                fprintf(fp, "  arg1=%5d  arg2=%5d  arg3=%5d",
-                        inst->arg1, inst->arg2, inst->arg3);
+                w_args3(w, inst);
                 break;
 
             case 4:   // LOAD_STRING
@@ -162,20 +274,28 @@ void ir_output_to_file(const char *filename) {
             case 44:  // ADD_GLOBAL
             case 45:  // ADD_ARG
                 if (inst->str_val) {
-                    fprintf(fp, "  str=\"%s\"", inst->str_val);
+                    W_LIT(w, "  str=\"");
+                    w_str(w, inst->str_val);
+                    W_LIT(w, "\"");
                 }
                 break;
 
             case 32:  // BEGIN_FUNCT
                 if (inst->str_val) {
-                    fprintf(fp, "  str=\"%s\"", inst->str_val);
+                    W_LIT(w, "  str=\"");
+                    w_str(w, inst->str_val);
+                    W_LIT(w, "\"");
                 }
-                fprintf(fp, " arg1=%5d arg2=%5d", inst->arg1, inst->arg2);
+                W_LIT(w, " arg1=");
+                w_int(w, inst->arg1, 5);
+                W_LIT(w, " arg2=");
+                w_int(w, inst->arg2, 5);
                 break;
 
             case 48:  // OP
-                fprintf(fp, "  arg1=%5d  arg2=%5d  arg3=%5d  a4=%d",
-                        inst->arg1, inst->arg2, inst->arg3, inst->arg4);
+                w_args3(w, inst);
+                W_LIT(w, "  a4=");
+                w_int(w, inst->arg4, 0);
                 break;
 
             case 52:  // NUM_LOCAL
@@ -184,16 +304,15 @@ void ir_output_to_file(const char *filename) {
             case 34:  // BRANCH_TRUE
             case 42:  // SET_LABEL
             case 43:  // ADD_LABEL
-                fprintf(fp, "  arg1=%5d  arg2=%5d  arg3=%5d",
-                        inst->arg1, inst->arg2, inst->arg3);
+                w_args3(w, inst);
                 break;
 
             default:
                 // For other opcodes, always display args
-                fprintf(fp, "  arg1=%5d  arg2=%5d  arg3=%5d",
-                        inst->arg1, inst->arg2, inst->arg3);
+                w_args3(w, inst);
                 if (inst->arg4 != 0) {
-                    fprintf(fp, "  a4=%d", inst->arg4);
+                    W_LIT(w, "  a4=");
+                    w_int(w, inst->arg4, 0);
                 }
                 break;
         }
@@ -201,79 +320,96 @@ void ir_output_to_file(const char *filename) {
         // Add opcode name comment
         // Special handling for opcodes with extra info
         if (inst->opcode == 48) {  // OP
-            fprintf(fp, "  # OP=%d (acomp_op)", inst->arg1);
+            W_LIT(w, "  # OP=");
+            w_int(w, inst->arg1, 0);
+            W_LIT(w, " (acomp_op)");
         } else if (inst->opcode == 55) {  // DROP_LOCAL
-            fprintf(fp, "  # DROP_LOCAL count=%d (acomp_drop_local)", inst->arg1);
+            W_LIT(w, "  # DROP_LOCAL count=");
+            w_int(w, inst->arg1, 0);
+            W_LIT(w, " (acomp_drop_local)");
         } else if (inst->opcode == 5) {  // LOAD_BOOL
-            fprintf(fp, "  # LOAD_BOOL val=%s (acomp_bool)", inst->arg1 ? "true" : "false");
+            if (inst->arg1) W_LIT(w, "  # LOAD_BOOL val=true (acomp_bool)");
+            else W_LIT(w, "  # LOAD_BOOL val=false (acomp_bool)");
         } else if (inst->opcode == 8) {  // LOAD_REAL
-            fprintf(fp, "  # LOAD_REAL val=%.17e (acomp_real)", inst->real_val);
+            w_double(w, "  # LOAD_REAL val=%.17e (acomp_real)", inst->real_val);
         } else if (inst->opcode == 9) {  // LOAD_IMAG
-            fprintf(fp, "  # LOAD_IMAG val=%fi (acomp_imag)", inst->real_val);
+            w_double(w, "  # LOAD_IMAG val=%fi (acomp_imag)", inst->real_val);
         } else if (inst->opcode == 44 && inst->str_val) {  // ADD_GLOBAL
-            fprintf(fp, "  # ADD_GLOBAL name=%s (acomp_add_global)", inst->str_val);
+            W_LIT(w, "  # ADD_GLOBAL name=");
+            w_str(w, inst->str_val);
+            W_LIT(w, " (acomp_add_global)");
         } else if (inst->opcode == 20 && inst->str_val) {  // ADD_LOCAL
-            fprintf(fp, "  # ADD_LOCAL (acomp_add_local)");
+            W_LIT(w, "  # ADD_LOCAL (acomp_add_local)");
         } else if (inst->opcode == 32 && inst->str_val) {  // BEGIN_FUNCT
-            fprintf(fp, "  # BEGIN_FUNCT name=%s (acomp_begin_funct)", inst->str_val);
+            W_LIT(w, "  # BEGIN_FUNCT name=");
+            w_str(w, inst->str_val);
+            W_LIT(w, " (acomp_begin_funct)");
         } else if (inst->opcode == 45 && inst->str_val) {  // ADD_ARG
-            fprintf(fp, "  # ADD_ARG name=%s (acomp_add_arg)", inst->str_val);
+            W_LIT(w, "  # ADD_ARG name=");
+            w_str(w, inst->str_val);
+            W_LIT(w, " (acomp_add_arg)");
         } else if (inst->opcode == 34) {  // BRANCH_TRUE
-            fprintf(fp, "  # BRANCH_TRUE label=%d (acomp_branch_true)", inst->arg1);
+            W_LIT(w, "  # BRANCH_TRUE label=");
+            w_int(w, inst->arg1, 0);
+            W_LIT(w, " (acomp_branch_true)");
         } else if (inst->opcode == 42) {  // SET_LABEL
-            fprintf(fp, "  # SET_LABEL label_id=%d (acomp_set_label)", inst->arg1);
+            W_LIT(w, "  # SET_LABEL label_id=");
+            w_int(w, inst->arg1, 0);
+            W_LIT(w, " (acomp_set_label)");
         } else if (inst->opcode == 43) {  // ADD_LABEL
-            fprintf(fp, "  # ADD_LABEL (acomp_add_label)");
+            W_LIT(w, "  # ADD_LABEL (acomp_add_label)");
         } else if (inst->opcode == 40) {  // ADD_CASE
-            fprintf(fp, "  # ADD_CASE case_value=%d (acomp_add_case)", inst->arg1);
+            W_LIT(w, "  # ADD_CASE case_value=");
+            w_int(w, inst->arg1, 0);
+            W_LIT(w, " (acomp_add_case)");
         } else if (inst->opcode == 41) {  // BRANCH_TABLE
-            fprintf(fp, "  # BRANCH_TABLE line=%d col=%d (acomp_branch_table)", inst->arg1, inst->arg2);
+            W_LIT(w, "  # BRANCH_TABLE line=");
+            w_int(w, inst->arg1, 0);
+            W_LIT(w, " col=");
+            w_int(w, inst->arg2, 0);
+            W_LIT(w, " (acomp_branch_table)");
         } else if (inst->opcode == 53) {  // SET_LOOP_DEFAULT
-            fprintf(fp, "  # SET_LOOP_DEFAULT (acomp_set_loop_default)");
+            W_LIT(w, "  # SET_LOOP_DEFAULT (acomp_set_loop_default)");
         } else {
-            fprintf(fp, "  # %s", get_opcode_name(inst->opcode));
+            W_LIT(w, "  # ");
+            w_str(w, get_opcode_name(inst->opcode));
         }
 
-        fprintf(fp, "\n");
+        W_LIT(w, "\n");
 
         // Only output DEPTH comment for non-OP=48 instructions
         if (inst->opcode != 48) {
-            fprintf(fp, "    # DEPTH=%d\n", inst->depth);
+            W_LIT(w, "    # DEPTH=");
+            w_int(w, inst->depth, 0);
+            W_LIT(w, "\n");
         }
-
-        inst = inst->next;
-        addr++;
     }
 
-    fprintf(fp, "\n# End of IR log (Total: %d instructions)\n", g_ir_count);
-    fclose(fp);
+    W_LIT(w, "\n# End of IR log (Total: ");
+    w_int(w, gen->count, 0);
+    W_LIT(w, " instructions)\n");
+    w_flush(w);
+    bool ok = w->ok;
+    free(w);
+    return ok;
 }
 
 /* Free all IR instructions */
 void ir_free_all() {
-    IRInst *inst = g_ir_head;
-    while (inst) {
-        IRInst *next = inst->next;
-        // Only free str_val for opcodes that use strings
-        // Opcodes with strings: 4(LOAD_STRING), 16(LOAD_VAR), 20(ADD_LOCAL),
-        // 32(BEGIN_FUNCT), 44(ADD_GLOBAL), 45(ADD_ARG)
-        if (inst->opcode == 4 || inst->opcode == 16 || inst->opcode == 20 ||
-            inst->opcode == 32 || inst->opcode == 44 || inst->opcode == 45) {
-            if (inst->str_val) free(inst->str_val);
-        }
-        free(inst);
-        inst = next;
-    }
-    g_ir_head = NULL;
-    g_ir_tail = NULL;
-    g_ir_count = 0;
+    AelIrGen *gen = ir_gen();
+    free(gen->insts);
+    gen->insts = NULL;
+    gen->count = 0;
+    gen->cap = 0;
+    gen->oom = false;
+    str_intern_free(&gen->strings);
 }
 
 /* ========== IR Generation Functions ========== */
 
 /* OP=3: Load integer constant */
 bool acomp_integer(int value) {
-    IRInst *inst = create_ir_inst(3);
+    IRGenInst *inst = create_ir_inst(3);
     inst->arg1 = value;
     inst->arg2 = 0;
     inst->arg3 = 0;
@@ -282,7 +418,7 @@ bool acomp_integer(int value) {
 
 /* OP=8: Load real constant */
 bool acomp_real(double value) {
-    IRInst *inst = create_ir_inst(8);
+    IRGenInst *inst = create_ir_inst(8);
     inst->real_val = value;
     inst->arg1 = 0;
     inst->arg2 = 0;
@@ -292,7 +428,7 @@ bool acomp_real(double value) {
 
 /* OP=9: Load imaginary constant */
 bool acomp_imag(double value) {
-    IRInst *inst = create_ir_inst(9);
+    IRGenInst *inst = create_ir_inst(9);
     inst->real_val = value;
     inst->arg1 = 0;
     inst->arg2 = 0;
@@ -302,8 +438,8 @@ bool acomp_imag(double value) {
 
 /* OP=4: Load string constant */
 bool acomp_string(const char *str) {
-    IRInst *inst = create_ir_inst(4);
-    inst->str_val = strdup(str);
+    IRGenInst *inst = create_ir_inst(4);
+    inst->str_val = ir_str(str);
     return true;
 }
 
@@ -315,7 +451,7 @@ bool acomp_null() {
 
 /* OP=5: Load BOOL (generic boolean) */
 bool acomp_bool(bool value) {
-    IRInst *inst = create_ir_inst(5);
+    IRGenInst *inst = create_ir_inst(5);
     inst->arg1 = value ? 1 : 0;
     inst->arg2 = 0;
     inst->arg3 = 0;
@@ -324,7 +460,7 @@ bool acomp_bool(bool value) {
 
 /* OP=7: Load TRUE */
 bool acomp_true() {
-    IRInst *inst = create_ir_inst(7);
+    IRGenInst *inst = create_ir_inst(7);
     inst->arg1 = 1;
     inst->arg2 = 0;
     inst->arg3 = 0;
@@ -340,18 +476,19 @@ bool acomp_false() {
 bool acomp_add_global(void *vocab_ptr, const char *name) {
     printf("[IR] acomp_add_global(\"%s\") called\n", name ? name : "(null)");
     fflush(stdout);
-    IRInst *inst = create_ir_inst(44);
-    inst->str_val = strdup(name);
+    IRGenInst *inst = create_ir_inst(44);
+    inst->str_val = ir_str(name);
     return true;
 }
 
 /* OP=20: Add local variable */
 bool acomp_add_local(const char *name) {
+    AelIrGen *gen = ir_gen();
     printf("[IR] acomp_add_local(\"%s\") called\n", name ? name : "(null)");
     fflush(stdout);
-    local_var_count++;  // Increment local variable counter
-    IRInst *inst = create_ir_inst(20);
-    inst->str_val = strdup(name);
+    gen->local_var_count++;  // Increment local variable counter
+    IRGenInst *inst = create_ir_inst(20);
+    inst->str_val = ir_str(name);
     return true;
 }
 
@@ -359,8 +496,8 @@ bool acomp_add_local(const char *name) {
 bool acomp_word_ref(void *vocab_ptr, const char *name) {
     printf("[IR] acomp_word_ref(\"%s\") called\n", name ? name : "(null)");
     fflush(stdout);
-    IRInst *inst = create_ir_inst(16);
-    inst->str_val = strdup(name);
+    IRGenInst *inst = create_ir_inst(16);
+    inst->str_val = ir_str(name);
     return true;
 }
 
@@ -369,7 +506,7 @@ bool acomp_op(int16_t opcode, int16_t arg2, int16_t arg3, int arg4) {
     /* arg2 = line number, arg3 = column number (from lexer position tracking) */
     /* These are now passed directly from parser, no metadata lookup needed */
 
-    IRInst *inst = create_ir_inst(48);
+    IRGenInst *inst = create_ir_inst(48);
     inst->arg1 = opcode;
     inst->arg2 = arg2;
     inst->arg3 = arg3;
@@ -379,21 +516,23 @@ bool acomp_op(int16_t opcode, int16_t arg2, int16_t arg3, int arg4) {
 
 /* OP=52: Number of local variables */
 int acomp_num_local() {
-    printf("[IR] acomp_num_local() called, returning %d\n", local_var_count);
+    AelIrGen *gen = ir_gen();
+    printf("[IR] acomp_num_local() called, returning %d\n", gen->local_var_count);
     fflush(stdout);
-    IRInst *inst = create_ir_inst(52);
+    IRGenInst *inst = create_ir_inst(52);
     inst->arg1 = 0;  // Always 0 according to baseline IR
     inst->arg2 = 0;
     inst->arg3 = 0;
-    return local_var_count;
+    return gen->local_var_count;
 }
 
 /* OP=55: Drop local variables */
 void acomp_drop_local(int count) {
+    AelIrGen *gen = ir_gen();
     printf("[IR] acomp_drop_local(%d) called\n", count);
     fflush(stdout);
-    local_var_count = count;  // Reset local variable count
-    IRInst *inst = create_ir_inst(55);
+    gen->local_var_count = count;  // Reset local variable count
+    IRGenInst *inst = create_ir_inst(55);
     inst->arg1 = count;
     inst->arg2 = 0;
     inst->arg3 = 0;
@@ -401,19 +540,21 @@ void acomp_drop_local(int count) {
 
 /* Get current local variable count (excludes parameters) */
 int ir_get_local_count(void) {
-    return local_var_count;
+    AelIrGen *gen = ir_gen();
+    return gen->local_var_count;
 }
 
 /* OP=32: Begin function definition */
 bool acomp_begin_funct(void *vocab_ptr, const char *name, int arg_count, int16_t func_word_id, int source_line) {
+    AelIrGen *gen = ir_gen();
     printf("[IR] acomp_begin_funct(\"%s\") called, source_line=%d\n", name ? name : "(null)", source_line);
     fflush(stdout);
 
     /* Reset label counter for this function */
-    label_counter = 0;
+    gen->label_counter = 0;
 
-    IRInst *inst = create_ir_inst(32);
-    inst->str_val = strdup(name);
+    IRGenInst *inst = create_ir_inst(32);
+    inst->str_val = ir_str(name);
     inst->arg1 = source_line;  /* arg1 = source line number of defun (0-based) */
     inst->arg2 = func_word_id;
     printf("[IR] acomp_begin_funct: arg1=%d (source_line)\n", inst->arg1);
@@ -423,40 +564,42 @@ bool acomp_begin_funct(void *vocab_ptr, const char *name, int arg_count, int16_t
 
 /* OP=33: Define function */
 bool acomp_define_funct(int local_count, int16_t func_word_id) {
-    IRInst *inst = create_ir_inst(33);
+    AelIrGen *gen = ir_gen();
+    IRGenInst *inst = create_ir_inst(33);
     inst->arg1 = local_count;
     inst->arg2 = func_word_id;
 
     /* Reset label counter when exiting function (returning to global scope) */
-    label_counter = 0;
+    gen->label_counter = 0;
 
     return true;
 }
 
 /* OP=45: Add function argument */
 bool acomp_add_arg(const char *name) {
-    IRInst *inst = create_ir_inst(45);
-    inst->str_val = strdup(name);
+    IRGenInst *inst = create_ir_inst(45);
+    inst->str_val = ir_str(name);
     return true;
 }
 
 /* OP=43: Add label */
 int acomp_add_label() {
-    IRInst *inst = create_ir_inst(43);
+    AelIrGen *gen = ir_gen();
+    IRGenInst *inst = create_ir_inst(43);
     inst->arg1 = 0;  // arg1 always 0 for ADD_LABEL
-    return label_counter++;
+    return gen->label_counter++;
 }
 
 /* OP=42: Set label */
 bool acomp_set_label(int label_id) {
-    IRInst *inst = create_ir_inst(42);
+    IRGenInst *inst = create_ir_inst(42);
     inst->arg1 = label_id;
     return true;
 }
 
 /* OP=34: Branch if true */
 bool acomp_branch_true(int label_id, int16_t line, int16_t col) {
-    IRInst *inst = create_ir_inst(34);
+    IRGenInst *inst = create_ir_inst(34);
     inst->arg1 = label_id;
     inst->arg2 = line;
     inst->arg3 = col;
@@ -477,32 +620,32 @@ bool acomp_end_loop() {
 
 /* OP=38: Loop again (continue) */
 int acomp_loop_again() {
-    IRInst *inst = create_ir_inst(38);
+    IRGenInst *inst = create_ir_inst(38);
     return 0;  // Return label ID
 }
 
 /* OP=39: Loop exit (break) */
 int acomp_loop_exit() {
-    IRInst *inst = create_ir_inst(39);
+    IRGenInst *inst = create_ir_inst(39);
     return 0;  // Return label ID
 }
 
 /* OP=40: Add case for switch statement */
 bool acomp_add_case(int case_value) {
-    IRInst *inst = create_ir_inst(40);
+    IRGenInst *inst = create_ir_inst(40);
     inst->arg1 = case_value;
     return true;
 }
 
 /* OP=53: Set loop default (for switch statement default case) */
 bool acomp_set_loop_default(void) {
-    IRInst *inst = create_ir_inst(53);
+    IRGenInst *inst = create_ir_inst(53);
     return true;
 }
 
 /* OP=41: Branch table (for switch statement) */
 bool acomp_branch_table(int16_t line, int16_t col) {
-    IRInst *inst = create_ir_inst(41);
+    IRGenInst *inst = create_ir_inst(41);
     inst->arg1 = line;
     inst->arg2 = col;
     inst->arg3 = 0;
@@ -0,0 +1,189 @@
+/* ir_label_index.c - label / marker position index for loaded IR programs */
+#include "ir_label_index.h"
+#include "ir_opcodes.h"
+#include "ir2ael_prof.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int index_entry_cmp(const void *a, const void *b) {
+    const IRIndexEntry *x = (const IRIndexEntry *)a;
+    const IRIndexEntry *y = (const IRIndexEntry *)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    if (x->pos != y->pos) return x->pos < y->pos ? -1 : 1;
+    return 0;
+}
+
+static bool inst_is_set_label(const IRInst *n) { return n->op == OP_SET_LABEL && n->has_arg1; }
+static bool inst_is_branch_true(const IRInst *n) { return n->op == OP_BRANCH_TRUE && n->has_arg1; }
+static bool inst_is_marker(const IRInst *n) { return n->op == OP_OP && n->has_arg1; }
+static bool inst_is_funct_bound(const IRInst *n) { return n->op == OP_BEGIN_FUNCT || n->op == OP_DEFINE_FUNCT; }
+
+bool ir_label_index_build(IRProgram *program) {
+    if (!program) return false;
+    if (program->label_index) {
+        ir_label_index_free(program->label_index);
+        free(program->label_index);
+        program->label_index = NULL;
+    }
+
+    size_t n_set = 0, n_bt = 0, n_marker = 0, n_funct = 0;
+    for (size_t i = 0; i < program->count; i++) {
+        const IRInst *n = &program->insts[i];
+        if (inst_is_set_label(n)) n_set++;
+        else if (inst_is_branch_true(n)) n_bt++;
+        else if (inst_is_marker(n)) n_marker++;
+        else if (inst_is_funct_bound(n)) n_funct++;
+    }
+
+    IRLabelIndex *ix = (IRLabelIndex *)calloc(1, sizeof(*ix));
+    if (!ix) return false;
+    size_t n_entries = n_set + n_bt + n_marker;
+    IRIndexEntry *entries = n_entries ? (IRIndexEntry *)malloc(n_entries * sizeof(*entries)) : NULL;
+    size_t *bounds = n_funct ? (size_t *)malloc(n_funct * sizeof(*bounds)) : NULL;
+    if ((n_entries && !entries) || (n_funct && !bounds)) {
+        free(entries);
+        free(bounds);
+        free(ix);
+        return false;
+    }
+    if (entries) {
+        ix->set_label = entries;
+        ix->branch_true = entries + n_set;
+        ix->marker = entries + n_set + n_bt;
+    }
+    ix->funct_bound = bounds;
+
+    for (size_t i = 0; i < program->count; i++) {
+        const IRInst *n = &program->insts[i];
+        if (inst_is_set_label(n)) {
+            ix->set_label[ix->set_label_count].key = n->arg1;
+            ix->set_label[ix->set_label_count++].pos = i;
+        } else if (inst_is_branch_true(n)) {
+            ix->branch_true[ix->branch_true_count].key = n->arg1;
+            ix->branch_true[ix->branch_true_count++].pos = i;
+        } else if (inst_is_marker(n)) {
+            ix->marker[ix->marker_count].key = n->arg1;
+            ix->marker[ix->marker_count++].pos = i;
+        } else if (inst_is_funct_bound(n)) {
+            ix->funct_bound[ix->funct_bound_count++] = i;
+        }
+    }
+
+    if (ix->set_label_count > 1) qsort(ix->set_label, ix->set_label_count, sizeof(IRIndexEntry), index_entry_cmp);
+    if (ix->branch_true_count > 1) qsort(ix->branch_true, ix->branch_true_count, sizeof(IRIndexEntry), index_entry_cmp);
+    if (ix->marker_count > 1) qsort(ix->marker, ix->marker_count, sizeof(IRIndexEntry), index_entry_cmp);
+
+    program->label_index = ix;
+    return true;
+}
+
+void ir_label_index_free(IRLabelIndex *index) {
+    if (!index) return;
+    /* set_label owns the shared entry block; branch_true/marker point into it. */
+    free(index->set_label);
+    free(index->funct_bound);
+    memset(index, 0, sizeof(*index));
+}
+
+/* First entry with (key, pos) >= (key, from); returns `end` if it is past the window. */
+static size_t index_next(const IRIndexEntry *v, size_t n, int key, size_t from, size_t end) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (v[mid].key < key || (v[mid].key == key && v[mid].pos < from)) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < n && v[lo].key == key && v[lo].pos < end) return v[lo].pos;
+    return end;
+}
+
+static size_t clamp_end(const IRProgram *program, size_t end) {
+    return end > program->count ? program->count : end;
+}
+
+size_t ir_next_set_label(const IRProgram *program, int label, size_t from, size_t end) {
+    if (!program) return end;
+    size_t lim = clamp_end(program, end);
+    if (from >= lim) return end;
+    const IRLabelIndex *ix = program->label_index;
+    if (ix) {
+        size_t p = index_next(ix->set_label, ix->set_label_count, label, from, lim);
+        IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_INDEX, p - from);
+        return p < lim ? p : end;
+    }
+    for (size_t j = from; j < lim; j++) {
+        if (inst_is_set_label(&program->insts[j]) && program->insts[j].arg1 == label) {
+            IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, j + 1 - from);
+            return j;
+        }
+    }
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, lim - from);
+    return end;
+}
+
+size_t ir_next_branch_true(const IRProgram *program, int label, size_t from, size_t end) {
+    if (!program) return end;
+    size_t lim = clamp_end(program, end);
+    if (from >= lim) return end;
+    const IRLabelIndex *ix = program->label_index;
+    if (ix) {
+        size_t p = index_next(ix->branch_true, ix->branch_true_count, label, from, lim);
+        IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_INDEX, p - from);
+        return p < lim ? p : end;
+    }
+    for (size_t j = from; j < lim; j++) {
+        if (inst_is_branch_true(&program->insts[j]) && program->insts[j].arg1 == label) {
+            IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, j + 1 - from);
+            return j;
+        }
+    }
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, lim - from);
+    return end;
+}
+
+size_t ir_next_marker(const IRProgram *program, int sub_op, size_t from, size_t end) {
+    if (!program) return end;
+    size_t lim = clamp_end(program, end);
+    if (from >= lim) return end;
+    const IRLabelIndex *ix = program->label_index;
+    if (ix) {
+        size_t p = index_next(ix->marker, ix->marker_count, sub_op, from, lim);
+        IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_INDEX, p - from);
+        return p < lim ? p : end;
+    }
+    for (size_t j = from; j < lim; j++) {
+        if (inst_is_marker(&program->insts[j]) && program->insts[j].arg1 == sub_op) {
+            IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, j + 1 - from);
+            return j;
+        }
+    }
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, lim - from);
+    return end;
+}
+
+size_t ir_next_funct_boundary(const IRProgram *program, size_t from, size_t end) {
+    if (!program) return end;
+    size_t lim = clamp_end(program, end);
+    if (from >= lim) return end;
+    const IRLabelIndex *ix = program->label_index;
+    if (ix) {
+        size_t lo = 0, hi = ix->funct_bound_count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (ix->funct_bound[mid] < from) lo = mid + 1;
+            else hi = mid;
+        }
+        size_t p = lo < ix->funct_bound_count && ix->funct_bound[lo] < lim ? ix->funct_bound[lo] : lim;
+        IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_INDEX, p - from);
+        return p < lim ? p : end;
+    }
+    for (size_t j = from; j < lim; j++) {
+        if (inst_is_funct_bound(&program->insts[j])) {
+            IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, j + 1 - from);
+            return j;
+        }
+    }
+    IR2AEL_PROF_SCAN(IR2AEL_PROF_S_LABEL_LINEAR, lim - from);
+    return end;
+}
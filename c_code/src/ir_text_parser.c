@@ -1,27 +1,36 @@
 #include "ir_text_parser.h"
+#include "ir_binary.h"
+#include "ir_label_index.h"
 
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static void ir_inst_free(IRInst *inst) {
-    if (!inst) return;
-    free(inst->str);
-    memset(inst, 0, sizeof(*inst));
-    inst->index = -1;
-}
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 bool ir_program_init(IRProgram *p) {
     if (!p) return false;
     memset(p, 0, sizeof(*p));
+    str_intern_init(&p->strings);
     return true;
 }
 
 void ir_program_free(IRProgram *p) {
     if (!p) return;
-    for (size_t i = 0; i < p->count; i++) ir_inst_free(&p->insts[i]);
+    str_intern_free(&p->strings);
     free(p->insts);
+    if (p->label_index) {
+        ir_label_index_free(p->label_index);
+        free(p->label_index);
+    }
     memset(p, 0, sizeof(*p));
 }
 
@@ -40,29 +49,45 @@ static bool ensure_cap(IRProgram *p, size_t want) {
     return true;
 }
 
-static const char *skip_ws(const char *s) {
-    while (*s && isspace((unsigned char)*s)) s++;
+/*
+ * The parser works in place on [s, e) ranges of the source buffer (usually a mapped
+ * file), so no line is copied and there is no line length limit.
+ */
+static const char *skip_ws(const char *s, const char *e) {
+    while (s < e && isspace((unsigned char)*s)) s++;
     return s;
 }
 
-static void rstrip(char *s) {
-    size_t n = strlen(s);
-    while (n > 0 && (s[n - 1] == '\r' || s[n - 1] == '\n' || isspace((unsigned char)s[n - 1]))) {
-        s[n - 1] = '\0';
-        n--;
+static const char *rstrip_end(const char *s, const char *e) {
+    while (e > s && isspace((unsigned char)e[-1])) e--;
+    return e;
+}
+
+static bool starts_with(const char *s, const char *e, const char *lit, size_t lit_len) {
+    return (size_t)(e - s) >= lit_len && memcmp(s, lit, lit_len) == 0;
+}
+
+/* Bounded strstr: memchr for the first byte, then compare the rest. */
+static const char *find_lit(const char *s, const char *e, const char *lit, size_t lit_len) {
+    while ((size_t)(e - s) >= lit_len) {
+        const char *p = (const char *)memchr(s, lit[0], (size_t)(e - s) - lit_len + 1);
+        if (!p) return NULL;
+        if (memcmp(p, lit, lit_len) == 0) return p;
+        s = p + 1;
     }
+    return NULL;
 }
 
-static bool parse_int_at(const char **ps, int *out_val) {
-    const char *s = skip_ws(*ps);
+static bool parse_int_at(const char **ps, const char *e, int *out_val) {
+    const char *s = skip_ws(*ps, e);
     bool neg = false;
-    if (*s == '-') {
+    if (s < e && *s == '-') {
         neg = true;
         s++;
     }
-    if (!isdigit((unsigned char)*s)) return false;
+    if (s >= e || !isdigit((unsigned char)*s)) return false;
     long v = 0;
-    while (isdigit((unsigned char)*s)) {
+    while (s < e && isdigit((unsigned char)*s)) {
         v = v * 10 + (*s - '0');
         s++;
     }
@@ -72,24 +97,29 @@ static bool parse_int_at(const char **ps, int *out_val) {
     return true;
 }
 
-static bool parse_double_at(const char **ps, double *out_val) {
-    const char *s = skip_ws(*ps);
+static bool parse_double_at(const char **ps, const char *e, double *out_val) {
+    const char *s = skip_ws(*ps, e);
+    /* strtod needs a terminator; numbers are short, so stage at most one token. */
+    char num[64];
+    size_t n = 0;
+    while (s + n < e && n < sizeof(num) - 1 && !isspace((unsigned char)s[n])) {
+        num[n] = s[n];
+        n++;
+    }
+    num[n] = '\0';
     char *end = NULL;
-    double v = strtod(s, &end);
-    if (end == s) return false;
+    double v = strtod(num, &end);
+    if (end == num) return false;
     *out_val = v;
-    *ps = end;
+    *ps = s + (end - num);
     return true;
 }
 
-static bool parse_quoted_string(const char **ps, char **out) {
-    const char *s = skip_ws(*ps);
-    if (*s != '"') return false;
+/* *oom is set if the string could not be interned (the return is false then too). */
+static bool parse_quoted_string(const char **ps, const char *e, StrInterner *strings, uint32_t *out, bool *oom) {
+    const char *s = skip_ws(*ps, e);
+    if (s >= e || *s != '"') return false;
     s++;
-    size_t cap = 64;
-    size_t len = 0;
-    char *buf = (char *)malloc(cap);
-    if (!buf) return false;
 
     /*
      * Hooked/baseline IR logs typically print string payloads without C-style unescaping.
@@ -98,138 +128,107 @@ static bool parse_quoted_string(const char **ps, char **out) {
      * IMPORTANT: we preserve bytes as-is (including backslashes), so IR->AEL can re-emit
      * literals that keep sequences like \" and \\ intact.
      */
+    const char *body = s;
     int backslash_run = 0;
-    while (*s) {
+    while (s < e) {
         char c = *s;
-        if (c == '"') {
-            if ((backslash_run % 2) == 0) break; /* terminator */
-            /* escaped quote: keep it */
-            if (len + 1 >= cap) {
-                cap *= 2;
-                char *nb = (char *)realloc(buf, cap);
-                if (!nb) {
-                    free(buf);
-                    return false;
-                }
-                buf = nb;
-            }
-            buf[len++] = '"';
-            s++;
-            backslash_run = 0;
-            continue;
-        }
-        s++;
+        if (c == '"' && (backslash_run % 2) == 0) break; /* terminator */
         if (c == '\\') backslash_run++;
         else backslash_run = 0;
-        if (len + 1 >= cap) {
-            cap *= 2;
-            char *nb = (char *)realloc(buf, cap);
-            if (!nb) {
-                free(buf);
-                return false;
-            }
-            buf = nb;
-        }
-        buf[len++] = c;
+        s++;
     }
-    if (*s != '"') {
-        free(buf);
+    if (s >= e) return false;
+
+    uint32_t id = str_intern(strings, body, (size_t)(s - body));
+    if (id == STR_INTERN_NONE) {
+        *oom = true;
         return false;
     }
     s++; /* closing quote */
-    buf[len] = '\0';
-    *out = buf;
+    *out = id;
     *ps = s;
     return true;
 }
 
-static bool parse_key_int(const char *key, const char **ps, bool *has, int *val) {
-    const char *s = skip_ws(*ps);
+static const char *match_key(const char *key, const char *s, const char *e) {
+    s = skip_ws(s, e);
     size_t klen = strlen(key);
-    if (strncmp(s, key, klen) != 0) return false;
-    s += klen;
-    s = skip_ws(s);
-    if (*s != '=') return false;
-    s++;
-    if (!parse_int_at(&s, val)) return false;
+    if (!starts_with(s, e, key, klen)) return NULL;
+    s = skip_ws(s + klen, e);
+    if (s >= e || *s != '=') return NULL;
+    return s + 1;
+}
+
+static bool parse_key_int(const char *key, const char **ps, const char *e, bool *has, int *val) {
+    const char *s = match_key(key, *ps, e);
+    if (!s) return false;
+    if (!parse_int_at(&s, e, val)) return false;
     *has = true;
     *ps = s;
     return true;
 }
 
-static bool parse_key_double(const char *key, const char **ps, bool *has, double *val) {
-    const char *s = skip_ws(*ps);
-    size_t klen = strlen(key);
-    if (strncmp(s, key, klen) != 0) return false;
-    s += klen;
-    s = skip_ws(s);
-    if (*s != '=') return false;
-    s++;
-    if (!parse_double_at(&s, val)) return false;
+static bool parse_key_double(const char *key, const char **ps, const char *e, bool *has, double *val) {
+    const char *s = match_key(key, *ps, e);
+    if (!s) return false;
+    if (!parse_double_at(&s, e, val)) return false;
     *has = true;
     *ps = s;
     return true;
 }
 
-static bool parse_key_str(const char *key, const char **ps, char **out) {
-    const char *s = skip_ws(*ps);
-    size_t klen = strlen(key);
-    if (strncmp(s, key, klen) != 0) return false;
-    s += klen;
-    s = skip_ws(s);
-    if (*s != '=') return false;
-    s++;
-    s = skip_ws(s);
-    if (!parse_quoted_string(&s, out)) return false;
+static bool parse_key_str(const char *key, const char **ps, const char *e, StrInterner *strings, uint32_t *out,
+                          bool *oom) {
+    const char *s = match_key(key, *ps, e);
+    if (!s) return false;
+    if (!parse_quoted_string(&s, e, strings, out, oom)) return false;
     *ps = s;
     return true;
 }
 
-static bool parse_ir_line(const char *line_in, IRInst *out_inst) {
-    char line[2048];
-    strncpy(line, line_in, sizeof(line) - 1);
-    line[sizeof(line) - 1] = '\0';
-
-    rstrip(line);
-    const char *s = skip_ws(line);
+static bool parse_ir_line(const char *line, const char *line_end, StrInterner *strings, IRInst *out_inst, bool *oom) {
+    const char *e = rstrip_end(line, line_end);
+    const char *s = skip_ws(line, e);
 
-    if (*s == '\0') return false;
+    if (s >= e) return false;
     if (*s == '#') return false;
     if (*s == '[') {
         /* [000A] ... */
-        s++;
-        while (*s && *s != ']') s++;
-        if (*s == ']') s++;
+        const char *rb = (const char *)memchr(s, ']', (size_t)(e - s));
+        s = rb ? rb + 1 : e;
     }
-    s = skip_ws(s);
-    if (strncmp(s, "OP", 2) != 0) return false;
+    s = skip_ws(s, e);
+    if (!starts_with(s, e, "OP", 2)) return false;
     bool has_op = false;
-    if (!parse_key_int("OP", &s, &has_op, &out_inst->op)) return false;
+    if (!parse_key_int("OP", &s, e, &has_op, &out_inst->op)) return false;
     if (!has_op) return false;
 
     out_inst->index = -1;
     out_inst->has_arg1 = out_inst->has_arg2 = out_inst->has_arg3 = out_inst->has_a4 = false;
     out_inst->arg1 = out_inst->arg2 = out_inst->arg3 = out_inst->a4 = 0;
     out_inst->str = NULL;
+    out_inst->str_id = STR_INTERN_NONE;
     out_inst->has_num_val = false;
     out_inst->num_val = 0.0;
 
-    while (*s) {
-        s = skip_ws(s);
-        if (*s == '\0') break;
+    while (s < e) {
+        s = skip_ws(s, e);
+        if (s >= e) break;
         if (*s == '#') break;
 
-        if (parse_key_int("arg1", &s, &out_inst->has_arg1, &out_inst->arg1)) continue;
-        if (parse_key_int("arg2", &s, &out_inst->has_arg2, &out_inst->arg2)) continue;
-        if (parse_key_int("arg3", &s, &out_inst->has_arg3, &out_inst->arg3)) continue;
-        if (parse_key_int("a4", &s, &out_inst->has_a4, &out_inst->a4)) continue;
-        if (!out_inst->str && parse_key_str("str", &s, &out_inst->str)) continue;
-        if (!out_inst->has_num_val && parse_key_double("real", &s, &out_inst->has_num_val, &out_inst->num_val)) continue;
-        if (!out_inst->has_num_val && parse_key_double("imag", &s, &out_inst->has_num_val, &out_inst->num_val)) continue;
+        if (parse_key_int("arg1", &s, e, &out_inst->has_arg1, &out_inst->arg1)) continue;
+        if (parse_key_int("arg2", &s, e, &out_inst->has_arg2, &out_inst->arg2)) continue;
+        if (parse_key_int("arg3", &s, e, &out_inst->has_arg3, &out_inst->arg3)) continue;
+        if (parse_key_int("a4", &s, e, &out_inst->has_a4, &out_inst->a4)) continue;
+        if (out_inst->str_id == STR_INTERN_NONE && parse_key_str("str", &s, e, strings, &out_inst->str_id, oom)) continue;
+        if (*oom) return false;
+        if (!out_inst->has_num_val && parse_key_double("real", &s, e, &out_inst->has_num_val, &out_inst->num_val)) continue;
+        if (!out_inst->has_num_val && parse_key_double("imag", &s, e, &out_inst->has_num_val, &out_inst->num_val)) continue;
 
         /* Skip unknown token */
-        while (*s && !isspace((unsigned char)*s)) s++;
+        while (s < e && !isspace((unsigned char)*s)) s++;
     }
+    out_inst->str = str_intern_get(strings, out_inst->str_id);
 
     /*
      * Some hooked IR logs appear to store line numbers as a signed 16-bit value (wrap at 65536),
@@ -243,12 +242,12 @@ static bool parse_ir_line(const char *line_in, IRInst *out_inst) {
     /* Parse numeric payload from inline comments for LOAD_REAL / LOAD_IMAG. */
     if (out_inst->op == 8 || out_inst->op == 9) {
         const char *tag = (out_inst->op == 8) ? "LOAD_REAL val=" : "LOAD_IMAG val=";
-        const char *p = strstr(line_in, tag);
+        const char *p = find_lit(line, line_end, tag, 14);
         if (p) {
-            p += strlen(tag);
-            char *end = NULL;
-            double v = strtod(p, &end);
-            if (end != p) {
+            p += 14;
+            double v = 0.0;
+            const char *t = p;
+            if (parse_double_at(&t, line_end, &v)) {
                 out_inst->has_num_val = true;
                 out_inst->num_val = v;
             }
@@ -257,79 +256,241 @@ static bool parse_ir_line(const char *line_in, IRInst *out_inst) {
     return true;
 }
 
-bool ir_parse_file(const char *path, IRProgram *out_program, char *err, size_t err_cap) {
-    if (!path || !out_program) return false;
-    if (err && err_cap) err[0] = '\0';
-
-    FILE *fp = fopen(path, "rb");
-    if (!fp) {
-        if (err && err_cap) snprintf(err, err_cap, "cannot open: %s", path);
-        return false;
+/*
+ * Parses one line into p. A DEPTH line updates *current_depth and, since hooked IR logs print it on
+ * the indented line *after* the instruction it describes, the last instruction. Returns false only on OOM.
+ */
+static bool parse_one_line(IRProgram *p, int *current_depth, const char *line, const char *line_end) {
+    const char *s = skip_ws(line, line_end);
+    if (s >= line_end) return true;
+    if (starts_with(s, line_end, "//", 2)) return true;
+    {
+        const char *dp = find_lit(s, line_end, "DEPTH=", 6);
+        if (dp) {
+            dp += 6;
+            int d = 0;
+            const char *t = dp;
+            if (parse_int_at(&t, line_end, &d)) {
+                *current_depth = d;
+                if (p->count > 0) {
+                    p->insts[p->count - 1].has_depth = true;
+                    p->insts[p->count - 1].depth = d;
+                }
+            }
+            return true;
+        }
     }
 
+    if (*s == '#' || starts_with(s, line_end, "/*", 2)) return true;
+
+    IRInst inst;
+    memset(&inst, 0, sizeof(inst));
+    inst.index = -1;
+    bool oom = false;
+    if (!parse_ir_line(s, line_end, &p->strings, &inst, &oom)) return !oom;
+    inst.has_depth = true;
+    inst.depth = *current_depth;
+    if (!ensure_cap(p, p->count + 1)) return false;
+    p->insts[p->count++] = inst;
+    return true;
+}
+
+bool ir_parse_buffer(const char *data, size_t len, IRProgram *out_program, char *err, size_t err_cap) {
+    if (!data || !out_program) return false;
+    if (err && err_cap) err[0] = '\0';
+
     IRProgram tmp;
     ir_program_init(&tmp);
 
     int current_depth = 0;
-    long last_inst_index = -1;
-    char line[2048];
-    while (fgets(line, sizeof(line), fp)) {
-        const char *s = skip_ws(line);
-        if (*s == '\0') continue;
-        if (*s == '\r' || *s == '\n') continue;
-        if (*s == '/' && s[1] == '/') continue;
-        {
-            const char *dp = strstr(s, "DEPTH=");
-            if (dp) {
-                dp += 6;
-                int d = 0;
-                const char *t = dp;
-                if (parse_int_at(&t, &d)) {
-                    current_depth = d;
-                    /* Hooked IR logs print DEPTH on the indented line *after* the instruction it describes. */
-                    if (last_inst_index >= 0 && (size_t)last_inst_index < tmp.count) {
-                        tmp.insts[(size_t)last_inst_index].has_depth = true;
-                        tmp.insts[(size_t)last_inst_index].depth = d;
-                    }
-                }
-                continue;
-            }
-        }
-
-        if (*s == '#' || (s[0] == '/' && s[1] == '*')) continue;
-        {
-            /* (legacy) treat indented # lines as comments */
-            if (s[0] == '#' || (s[0] == ' ' && s[1] == '#')) continue;
-        }
-
-        IRInst inst;
-        memset(&inst, 0, sizeof(inst));
-        inst.index = -1;
-        if (!parse_ir_line(s, &inst)) continue;
-        inst.has_depth = true;
-        inst.depth = current_depth;
-        if (!ensure_cap(&tmp, tmp.count + 1)) {
-            ir_inst_free(&inst);
-            fclose(fp);
+    const char *pos = data;
+    const char *end = data + len;
+    while (pos < end) {
+        const char *nl = (const char *)memchr(pos, '\n', (size_t)(end - pos));
+        const char *line_end = nl ? nl + 1 : end;
+        if (!parse_one_line(&tmp, &current_depth, pos, line_end)) {
             ir_program_free(&tmp);
             if (err && err_cap) snprintf(err, err_cap, "out of memory");
             return false;
         }
-        tmp.insts[tmp.count++] = inst;
-        last_inst_index = (long)tmp.count - 1;
+        pos = line_end;
     }
 
-    fclose(fp);
+    /* The index only speeds up the converter's matchers; without it they fall back to scanning. */
+    (void)ir_label_index_build(&tmp);
     *out_program = tmp;
     return true;
 }
 
+void ir_text_stream_init(IRTextStream *ts, IRProgram *program) {
+    if (!ts) return;
+    memset(ts, 0, sizeof(*ts));
+    ts->program = program;
+}
+
+void ir_text_stream_free(IRTextStream *ts) {
+    if (!ts) return;
+    free(ts->partial);
+    memset(ts, 0, sizeof(*ts));
+}
+
+static bool stream_hold(IRTextStream *ts, const char *data, size_t len) {
+    if (len > ts->partial_cap - ts->partial_len) {
+        size_t ncap = ts->partial_cap ? ts->partial_cap : 256;
+        while (ncap - ts->partial_len < len) ncap *= 2;
+        char *n = (char *)realloc(ts->partial, ncap);
+        if (!n) return false;
+        ts->partial = n;
+        ts->partial_cap = ncap;
+    }
+    memcpy(ts->partial + ts->partial_len, data, len);
+    ts->partial_len += len;
+    return true;
+}
+
+bool ir_text_stream_feed(IRTextStream *ts, const char *data, size_t len, char *err, size_t err_cap) {
+    if (!ts || !ts->program || (!data && len)) return false;
+    const char *pos = data;
+    const char *end = data + len;
+
+    /* Complete the line left over from the previous chunk first. */
+    if (ts->partial_len > 0) {
+        const char *nl = (const char *)memchr(pos, '\n', len);
+        if (!nl) {
+            if (!stream_hold(ts, pos, len)) goto oom;
+            return true;
+        }
+        if (!stream_hold(ts, pos, (size_t)(nl + 1 - pos))) goto oom;
+        pos = nl + 1;
+        bool ok = parse_one_line(ts->program, &ts->current_depth, ts->partial, ts->partial + ts->partial_len);
+        ts->partial_len = 0;
+        if (!ok) goto oom;
+    }
+
+    while (pos < end) {
+        const char *nl = (const char *)memchr(pos, '\n', (size_t)(end - pos));
+        if (!nl) {
+            if (!stream_hold(ts, pos, (size_t)(end - pos))) goto oom;
+            break;
+        }
+        if (!parse_one_line(ts->program, &ts->current_depth, pos, nl + 1)) goto oom;
+        pos = nl + 1;
+    }
+    return true;
+
+oom:
+    if (err && err_cap) snprintf(err, err_cap, "out of memory");
+    return false;
+}
+
+bool ir_text_stream_finish(IRTextStream *ts, char *err, size_t err_cap) {
+    if (!ts || !ts->program) return false;
+    if (ts->partial_len == 0) return true;
+    bool ok = parse_one_line(ts->program, &ts->current_depth, ts->partial, ts->partial + ts->partial_len);
+    ts->partial_len = 0;
+    if (!ok && err && err_cap) snprintf(err, err_cap, "out of memory");
+    return ok;
+}
+
+bool ir_file_view_open(const char *path, IRFileView *view, char *err, size_t err_cap) {
+    if (!path || !view) return false;
+    memset(view, 0, sizeof(*view));
+    view->data = "";
+
+#if defined(_WIN32)
+    /* Sharing does not extend to deletion while the view below is mapped (DeleteFile fails with access
+       denied), so callers remove temp IR files only after ir_file_view_close(). */
+    HANDLE fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fh == INVALID_HANDLE_VALUE) {
+        if (err && err_cap) snprintf(err, err_cap, "cannot open: %s", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fh, &size)) {
+        CloseHandle(fh);
+        if (err && err_cap) snprintf(err, err_cap, "cannot stat: %s", path);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(fh); /* empty file: nothing to map */
+        return true;
+    }
+    HANDLE mh = CreateFileMappingA(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void *base = mh ? MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!base) {
+        if (mh) CloseHandle(mh);
+        CloseHandle(fh);
+        if (err && err_cap) snprintf(err, err_cap, "cannot map: %s", path);
+        return false;
+    }
+    view->data = (const char *)base;
+    view->len = (size_t)size.QuadPart;
+    view->file_handle = fh;
+    view->map_handle = mh;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (err && err_cap) snprintf(err, err_cap, "cannot open: %s", path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        if (err && err_cap) snprintf(err, err_cap, "cannot stat: %s", path);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        if (err && err_cap) snprintf(err, err_cap, "cannot map: %s", path);
+        return false;
+    }
+    view->data = (const char *)base;
+    view->len = (size_t)st.st_size;
+    view->map_handle = base;
+#endif
+    return true;
+}
+
+void ir_file_view_close(IRFileView *view) {
+    if (!view) return;
+#if defined(_WIN32)
+    if (view->map_handle) {
+        UnmapViewOfFile(view->data);
+        CloseHandle((HANDLE)view->map_handle);
+    }
+    if (view->file_handle) CloseHandle((HANDLE)view->file_handle);
+#else
+    if (view->map_handle) munmap(view->map_handle, view->len);
+#endif
+    memset(view, 0, sizeof(*view));
+}
+
+bool ir_parse_file(const char *path, IRProgram *out_program, char *err, size_t err_cap) {
+    if (!path || !out_program) return false;
+    if (err && err_cap) err[0] = '\0';
+
+    IRFileView view;
+    if (!ir_file_view_open(path, &view, err, err_cap)) return false;
+    bool ok = ir_binary_detect(view.data, view.len) ?
+              ir_binary_load_buffer(view.data, view.len, out_program, err, err_cap) :
+              ir_parse_buffer(view.data, view.len, out_program, err, err_cap);
+    ir_file_view_close(&view);
+    return ok;
+}
+
 static void trim_in_place(char *s) {
     if (!s) return;
     char *p = s;
     while (*p && isspace((unsigned char)*p)) p++;
     if (p != s) memmove(s, p, strlen(p) + 1);
-    rstrip(s);
+    size_t n = strlen(s);
+    while (n > 0 && isspace((unsigned char)s[n - 1])) s[--n] = '\0';
 }
 
 bool ir_extract_source_ael_path(const char *ir_path, char *out_path, size_t out_cap) {
@@ -0,0 +1,136 @@
+/* str_intern.c - string interner (stable storage + open-addressing id table) */
+#include "str_intern.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define STR_INTERN_CHUNK_SIZE (16u * 1024u)
+
+struct StrInternChunk {
+    StrInternChunk *next;
+    size_t used;
+    size_t cap;
+    /* string bytes follow */
+};
+
+static uint32_t intern_hash(const char *s, size_t len) {
+    uint32_t h = 2166136261u; /* FNV-1a */
+    for (size_t k = 0; k < len; k++) {
+        h ^= (unsigned char)s[k];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void str_intern_init(StrInterner *in) {
+    if (!in) return;
+    memset(in, 0, sizeof(*in));
+    in->count = 1;
+}
+
+void str_intern_free(StrInterner *in) {
+    if (!in) return;
+    StrInternChunk *c = in->chunks;
+    while (c) {
+        StrInternChunk *next = c->next;
+        free(c);
+        c = next;
+    }
+    free(in->entries);
+    free(in->slots);
+    memset(in, 0, sizeof(*in));
+    in->count = 1;
+}
+
+static char *intern_store(StrInterner *in, const char *s, size_t len) {
+    size_t n = len + 1;
+    StrInternChunk *c = in->chunks;
+    if (!c || n > c->cap - c->used) {
+        size_t cap = n > STR_INTERN_CHUNK_SIZE ? n : STR_INTERN_CHUNK_SIZE;
+        StrInternChunk *nc = (StrInternChunk *)malloc(sizeof(StrInternChunk) + cap);
+        if (!nc) return NULL;
+        nc->used = 0;
+        nc->cap = cap;
+        /* A one-off oversized chunk goes behind the current one so its free space stays in use. */
+        if (c && cap > STR_INTERN_CHUNK_SIZE) {
+            nc->next = c->next;
+            c->next = nc;
+        } else {
+            nc->next = c;
+            in->chunks = nc;
+        }
+        c = nc;
+    }
+    char *d = (char *)(c + 1) + c->used;
+    c->used += n;
+    memcpy(d, s, len);
+    d[len] = '\0';
+    return d;
+}
+
+static uint32_t intern_probe(const StrInterner *in, const char *s, size_t len, uint32_t h, uint32_t *slot) {
+    uint32_t mask = in->slot_cap - 1;
+    for (uint32_t k = h & mask;; k = (k + 1) & mask) {
+        uint32_t id = in->slots[k];
+        if (id != STR_INTERN_NONE) {
+            const StrInternEntry *e = &in->entries[id];
+            if (e->hash != h || e->len != len || memcmp(e->str, s, len) != 0) continue;
+        }
+        if (slot) *slot = k;
+        return id;
+    }
+}
+
+/* Keeps the table at most half full. */
+static bool intern_grow(StrInterner *in) {
+    uint32_t ncap = in->slot_cap ? in->slot_cap * 2 : 256;
+    uint32_t *ns = (uint32_t *)calloc(ncap, sizeof(*ns));
+    if (!ns) return false;
+    uint32_t mask = ncap - 1;
+    for (uint32_t id = 1; id < in->count; id++) {
+        uint32_t k = in->entries[id].hash & mask;
+        while (ns[k] != STR_INTERN_NONE) k = (k + 1) & mask;
+        ns[k] = id;
+    }
+    free(in->slots);
+    in->slots = ns;
+    in->slot_cap = ncap;
+    return true;
+}
+
+uint32_t str_intern(StrInterner *in, const char *s, size_t len) {
+    if (!in || !s) return STR_INTERN_NONE;
+    if (in->count == 0) in->count = 1;
+    if ((in->count + 1) * 2 > in->slot_cap && !intern_grow(in)) return STR_INTERN_NONE;
+
+    uint32_t h = intern_hash(s, len);
+    uint32_t slot = 0;
+    uint32_t id = intern_probe(in, s, len, h, &slot);
+    if (id != STR_INTERN_NONE) return id;
+
+    if (in->count >= in->cap) {
+        uint32_t ncap = in->cap ? in->cap * 2 : 256;
+        StrInternEntry *ne = (StrInternEntry *)realloc(in->entries, ncap * sizeof(*ne));
+        if (!ne) return STR_INTERN_NONE;
+        in->entries = ne;
+        in->cap = ncap;
+    }
+    char *d = intern_store(in, s, len);
+    if (!d) return STR_INTERN_NONE;
+    id = in->count++;
+    in->entries[id].str = d;
+    in->entries[id].len = len;
+    in->entries[id].hash = h;
+    in->slots[slot] = id;
+    return id;
+}
+
+uint32_t str_intern_find(const StrInterner *in, const char *s, size_t len) {
+    if (!in || !s || in->slot_cap == 0) return STR_INTERN_NONE;
+    return intern_probe(in, s, len, intern_hash(s, len), NULL);
+}
+
+const char *str_intern_get(const StrInterner *in, uint32_t id) {
+    if (!in || id == STR_INTERN_NONE || id >= in->count) return NULL;
+    return in->entries[id].str;
+}